@@ -9,42 +9,70 @@
 /* .Call calls */
 extern SEXP R_affx_cdf_groupNames(SEXP, SEXP, SEXP, SEXP);
 extern SEXP R_affx_cdf_isPm(SEXP, SEXP, SEXP);
+extern SEXP R_affx_cdf_merge_groups(SEXP, SEXP, SEXP, SEXP, SEXP);
 extern SEXP R_affx_cdf_nbrOfCellsPerUnitGroup(SEXP, SEXP, SEXP);
+extern SEXP R_affx_compare_cdf_files(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP R_affx_compare_cel_files(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP R_affx_convert_cel_files(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP R_affx_get_bar_file(SEXP, SEXP, SEXP, SEXP);
+extern SEXP R_affx_get_bar_header(SEXP);
 extern SEXP R_affx_get_bpmap_file(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
 extern SEXP R_affx_get_bpmap_header(SEXP);
 extern SEXP R_affx_get_bpmap_seqinfo(SEXP, SEXP, SEXP);
+extern SEXP R_affx_get_ccg_file(SEXP, SEXP, SEXP, SEXP, SEXP);
 extern SEXP R_affx_get_cdf_cell_indices(SEXP, SEXP, SEXP);
-extern SEXP R_affx_get_cdf_file(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP R_affx_get_cdf_data_frame(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP R_affx_get_cdf_file(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
 extern SEXP R_affx_get_cdf_file_header(SEXP);
 extern SEXP R_affx_get_cdf_file_qc(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP R_affx_get_cdf_unit_indices(SEXP, SEXP, SEXP);
 extern SEXP R_affx_get_cdf_unit_names(SEXP, SEXP, SEXP);
-extern SEXP R_affx_get_cdf_units(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP R_affx_get_cdf_units(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
 extern SEXP R_affx_get_cel_file(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
 extern SEXP R_affx_get_cel_file_header(SEXP);
-extern SEXP R_affx_get_chp_file(SEXP, SEXP);
+extern SEXP R_affx_get_chp_file(SEXP, SEXP, SEXP);
 extern SEXP R_affx_get_clf_file(SEXP, SEXP, SEXP);
 extern SEXP R_affx_get_pgf_file(SEXP, SEXP, SEXP, SEXP);
+extern SEXP R_affx_prefetch_cel_files(SEXP);
+extern SEXP R_affx_read_cel_units(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP R_affx_update_cel_file(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
 extern SEXP R_affx_write_bpmap_file(SEXP, SEXP, SEXP);
+extern SEXP R_affx_write_cdf_file(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP R_affx_write_cel_file(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
 
 static const R_CallMethodDef CallEntries[] = {
     {"R_affx_cdf_groupNames",             (DL_FUNC) &R_affx_cdf_groupNames,              4},
     {"R_affx_cdf_isPm",                   (DL_FUNC) &R_affx_cdf_isPm,                    3},
+    {"R_affx_cdf_merge_groups",           (DL_FUNC) &R_affx_cdf_merge_groups,            5},
     {"R_affx_cdf_nbrOfCellsPerUnitGroup", (DL_FUNC) &R_affx_cdf_nbrOfCellsPerUnitGroup,  3},
+    {"R_affx_compare_cdf_files",          (DL_FUNC) &R_affx_compare_cdf_files,           6},
+    {"R_affx_compare_cel_files",          (DL_FUNC) &R_affx_compare_cel_files,           7},
+    {"R_affx_convert_cel_files",          (DL_FUNC) &R_affx_convert_cel_files,           9},
+    {"R_affx_get_bar_file",               (DL_FUNC) &R_affx_get_bar_file,                4},
+    {"R_affx_get_bar_header",             (DL_FUNC) &R_affx_get_bar_header,              1},
     {"R_affx_get_bpmap_file",             (DL_FUNC) &R_affx_get_bpmap_file,             12},
     {"R_affx_get_bpmap_header",           (DL_FUNC) &R_affx_get_bpmap_header,            1},
     {"R_affx_get_bpmap_seqinfo",          (DL_FUNC) &R_affx_get_bpmap_seqinfo,           3},
+    {"R_affx_get_ccg_file",               (DL_FUNC) &R_affx_get_ccg_file,                5},
     {"R_affx_get_cdf_cell_indices",       (DL_FUNC) &R_affx_get_cdf_cell_indices,        3},
-    {"R_affx_get_cdf_file",               (DL_FUNC) &R_affx_get_cdf_file,               15},
+    {"R_affx_get_cdf_data_frame",         (DL_FUNC) &R_affx_get_cdf_data_frame,          6},
+    {"R_affx_get_cdf_file",               (DL_FUNC) &R_affx_get_cdf_file,               16},
     {"R_affx_get_cdf_file_header",        (DL_FUNC) &R_affx_get_cdf_file_header,         1},
     {"R_affx_get_cdf_file_qc",            (DL_FUNC) &R_affx_get_cdf_file_qc,            10},
+    {"R_affx_get_cdf_unit_indices",       (DL_FUNC) &R_affx_get_cdf_unit_indices,        3},
     {"R_affx_get_cdf_unit_names",         (DL_FUNC) &R_affx_get_cdf_unit_names,          3},
-    {"R_affx_get_cdf_units",              (DL_FUNC) &R_affx_get_cdf_units,               9},
+    {"R_affx_get_cdf_units",              (DL_FUNC) &R_affx_get_cdf_units,              10},
     {"R_affx_get_cel_file",               (DL_FUNC) &R_affx_get_cel_file,               11},
     {"R_affx_get_cel_file_header",        (DL_FUNC) &R_affx_get_cel_file_header,         1},
-    {"R_affx_get_chp_file",               (DL_FUNC) &R_affx_get_chp_file,                2},
+    {"R_affx_get_chp_file",               (DL_FUNC) &R_affx_get_chp_file,                3},
     {"R_affx_get_clf_file",               (DL_FUNC) &R_affx_get_clf_file,                3},
     {"R_affx_get_pgf_file",               (DL_FUNC) &R_affx_get_pgf_file,                4},
+    {"R_affx_prefetch_cel_files",         (DL_FUNC) &R_affx_prefetch_cel_files,          1},
+    {"R_affx_read_cel_units",             (DL_FUNC) &R_affx_read_cel_units,             13},
+    {"R_affx_update_cel_file",            (DL_FUNC) &R_affx_update_cel_file,             6},
     {"R_affx_write_bpmap_file",           (DL_FUNC) &R_affx_write_bpmap_file,            3},
+    {"R_affx_write_cdf_file",             (DL_FUNC) &R_affx_write_cdf_file,              6},
+    {"R_affx_write_cel_file",             (DL_FUNC) &R_affx_write_cel_file,             11},
     {NULL, NULL, 0}
 };
 
@@ -1,10 +1,12 @@
 #ifndef RAFFXERRHANDLER_H
 #define RAFFXERRHANDLER_H
 
+#include <iostream>
 #include <string>
 #include "ErrHandler.h"
 #include "Verbose.h"
 #include "Except.h"
+#include "ReaderContext.h"
 
 /**
  * @brief Basic R_affx exception-forwarding error handler
@@ -36,4 +38,18 @@ class RAffxErrHandler : public ErrHandler {
     bool m_Throw;          ///< throw an exception or abort()?
 };
 
+/**
+ * @brief The reader context of the native routines called from R.
+ *
+ * They all run on the R main thread and share this context, which
+ * lives for the whole session.  Errors throw an Except to be turned
+ * into an R error, instead of exiting the process.  If an R error
+ * unwinds past a ReaderContext::Scope the context simply stays
+ * installed on the main thread.
+ */
+inline ReaderContext *R_affx_reader_context() {
+  static ReaderContext context(new RAffxErrHandler(true), 1, &std::cerr);
+  return &context;
+}
+
 #endif /* RAFFXERRHANDLER_H */
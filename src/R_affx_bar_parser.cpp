@@ -0,0 +1,291 @@
+#include "BARFileData.h"
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "R_affx_constants.h"
+
+using namespace std;
+using namespace affxbar;
+
+#include <R.h>
+#include <Rdefines.h>
+
+extern "C" {
+  /************************************************************************
+   *
+   * Reading BAR files
+   *
+   * The sequence headers of a BAR file are read when the file is opened,
+   * whereas the data of a sequence is only read when asked for.  When a
+   * region is given, the first (position) column is binary searched in
+   * the file, so only the rows of the region are ever read.
+   *
+   ************************************************************************/
+  static const char *R_affx_bar_column_type(GDACFILES_BAR_DATA_TYPE type)
+  {
+    switch (type) {
+    case BAR_DATA_DOUBLE:   return "double";
+    case BAR_DATA_FLOAT:    return "float";
+    case BAR_DATA_INTEGER:  return "integer";
+    case BAR_DATA_SHORT:    return "short";
+    case BAR_DATA_CHAR:     return "char";
+    case BAR_DATA_UINTEGER: return "uinteger";
+    case BAR_DATA_USHORT:   return "ushort";
+    case BAR_DATA_UCHAR:    return "uchar";
+    default:                return "unknown";
+    }
+  }
+
+  static SEXP R_affx_bar_parameters(int nparams, const TagValuePairTypeVector& params)
+  {
+    SEXP res, names;
+    PROTECT(res = NEW_CHARACTER(nparams));
+    PROTECT(names = NEW_CHARACTER(nparams));
+    for (int ii = 0; ii < nparams; ii++) {
+      SET_STRING_ELT(res, ii, mkChar(params[ii].Value.c_str()));
+      SET_STRING_ELT(names, ii, mkChar(params[ii].Tag.c_str()));
+    }
+    setAttrib(res, R_NamesSymbol, names);
+    UNPROTECT(2);
+    return res;
+  }
+
+
+  /************************************************************************
+   *
+   * R_affx_get_bar_header()
+   *
+   ************************************************************************/
+  SEXP R_affx_get_bar_header(SEXP fname)
+  {
+    CBARFileData bar;
+    const char* barFileName = CHAR(STRING_ELT(fname, 0));
+
+    bar.SetFileName(barFileName);
+    if (bar.Read() == false) {
+      char msg[1024];
+      snprintf(msg, sizeof(msg), "Unable to read file: %s (%s)",
+               barFileName, bar.GetError().c_str());
+      bar.Close();
+      error("%s", msg);
+    }
+
+    int nseqs = bar.GetNumberSequences();
+    int ncols = bar.GetNumberColumns();
+    int nparams = bar.GetNumberParameters();
+    SEXP res, names, types, params, seqs, seqNames, tmp;
+
+    PROTECT(types = NEW_CHARACTER(ncols));
+    for (int cc = 0; cc < ncols; cc++) {
+      SET_STRING_ELT(types, cc, mkChar(R_affx_bar_column_type(bar.GetColumnTypes(cc))));
+    }
+
+    TagValuePairTypeVector fileParams(nparams);
+    for (int ii = 0; ii < nparams; ii++) fileParams[ii] = bar.GetParameter(ii);
+    PROTECT(params = R_affx_bar_parameters(nparams, fileParams));
+
+    /* The sequences, column by column */
+    PROTECT(seqs = NEW_LIST(4));
+    PROTECT(seqNames = NEW_CHARACTER(4));
+    SET_STRING_ELT(seqNames, 0, mkChar("name"));
+    SET_STRING_ELT(seqNames, 1, mkChar("groupName"));
+    SET_STRING_ELT(seqNames, 2, mkChar("version"));
+    SET_STRING_ELT(seqNames, 3, mkChar("numDataPoints"));
+    for (int kk = 0; kk < 3; kk++) SET_VECTOR_ELT(seqs, kk, NEW_CHARACTER(nseqs));
+    SET_VECTOR_ELT(seqs, 3, NEW_INTEGER(nseqs));
+    CGDACSequenceResultItem seq;
+    for (int ss = 0; ss < nseqs; ss++) {
+      bar.GetResults(ss, seq);
+      SET_STRING_ELT(VECTOR_ELT(seqs, 0), ss, mkChar(seq.GetName().c_str()));
+      SET_STRING_ELT(VECTOR_ELT(seqs, 1), ss, mkChar(seq.GetGroupName().c_str()));
+      SET_STRING_ELT(VECTOR_ELT(seqs, 2), ss, mkChar(seq.GetVersion().c_str()));
+      INTEGER(VECTOR_ELT(seqs, 3))[ss] = seq.GetNumberDataPoints();
+    }
+    setAttrib(seqs, R_NamesSymbol, seqNames);
+
+    PROTECT(res = NEW_LIST(5));
+    PROTECT(names = NEW_CHARACTER(5));
+    SET_STRING_ELT(names, 0, mkChar("version"));
+    PROTECT(tmp = NEW_NUMERIC(1));
+    REAL(tmp)[0] = bar.GetVersion();
+    SET_VECTOR_ELT(res, 0, tmp);
+    SET_STRING_ELT(names, 1, mkChar("numSequences"));
+    SET_VECTOR_ELT(res, 1, ScalarInteger(nseqs));
+    SET_STRING_ELT(names, 2, mkChar("columnTypes"));
+    SET_VECTOR_ELT(res, 2, types);
+    SET_STRING_ELT(names, 3, mkChar("parameters"));
+    SET_VECTOR_ELT(res, 3, params);
+    SET_STRING_ELT(names, 4, mkChar("sequences"));
+    SET_VECTOR_ELT(res, 4, seqs);
+    setAttrib(res, R_NamesSymbol, names);
+
+    UNPROTECT(7);
+    return res;
+  } /* R_affx_get_bar_header() */
+
+
+
+  /************************************************************************
+   *
+   * R_affx_get_bar_file()
+   *
+   * Arguments:
+   * sequences - (one-based) indices of the sequences to read; all if empty.
+   * region    - the (inclusive) range of positions to read, or empty.
+   *
+   * Returns a list with one element per sequence, each a list with
+   * fields 'groupName', 'version', 'parameters' and 'data', the latter
+   * a list of columns named 'position' and 'value' (or 'value1', ...).
+   *
+   ************************************************************************/
+  SEXP R_affx_get_bar_file(SEXP fname, SEXP sequences, SEXP region, SEXP verbose)
+  {
+    CBARFileData bar;
+    const char* barFileName = CHAR(STRING_ELT(fname, 0));
+    int i_verboseFlag = INTEGER(verbose)[0];
+    char msg[1024] = "";
+
+    bar.SetFileName(barFileName);
+    if (i_verboseFlag >= R_AFFX_VERBOSE) {
+      Rprintf("Reading BAR file: %s\n", barFileName);
+    }
+    if (bar.Read() == false) {
+      snprintf(msg, sizeof(msg), "Unable to read file: %s (%s)",
+               barFileName, bar.GetError().c_str());
+    }
+
+    int nseqsInFile = bar.GetNumberSequences();
+    int ncols = bar.GetNumberColumns();
+    int nseqs = length(sequences) > 0 ? length(sequences) : nseqsInFile;
+    for (int ss = 0; msg[0] == '\0' && ss < length(sequences); ss++) {
+      int idx = INTEGER(sequences)[ss];
+      if (idx == NA_INTEGER || idx < 1 || idx > nseqsInFile) {
+        snprintf(msg, sizeof(msg), "Argument 'sequences' contains an element out of range [%d,%d]: %d",
+                 1, nseqsInFile, idx);
+      }
+    }
+
+    /* The range of positions, inclusive */
+    bool hasRegion = (length(region) == 2);
+    int32_t start = INT_MIN, end = INT_MAX;
+    if (msg[0] == '\0' && hasRegion) {
+      double r0 = ceil(REAL(region)[0]), r1 = floor(REAL(region)[1]);
+      start = (int32_t) (r0 < INT_MIN ? INT_MIN : (r0 > INT_MAX ? INT_MAX : r0));
+      end = (int32_t) (r1 < INT_MIN ? INT_MIN : (r1 > INT_MAX ? INT_MAX : r1));
+      if (ncols == 0 || bar.GetColumnTypes(0) != BAR_DATA_INTEGER) {
+        snprintf(msg, sizeof(msg), "Cannot select a region; the first column of the BAR file is not an integer (position) column: %s",
+                 barFileName);
+      }
+    }
+
+    if (msg[0] != '\0') {
+      bar.Close();
+      error("%s", msg);
+    }
+
+    /* The column names */
+    SEXP colNames, fieldNames, res, resNames;
+    PROTECT(colNames = NEW_CHARACTER(ncols));
+    for (int cc = 0; cc < ncols; cc++) {
+      char name[32];
+      if (cc == 0) {
+        snprintf(name, sizeof(name), "position");
+      } else if (ncols == 2) {
+        snprintf(name, sizeof(name), "value");
+      } else {
+        snprintf(name, sizeof(name), "value%d", cc);
+      }
+      SET_STRING_ELT(colNames, cc, mkChar(name));
+    }
+    PROTECT(fieldNames = NEW_CHARACTER(4));
+    SET_STRING_ELT(fieldNames, 0, mkChar("groupName"));
+    SET_STRING_ELT(fieldNames, 1, mkChar("version"));
+    SET_STRING_ELT(fieldNames, 2, mkChar("parameters"));
+    SET_STRING_ELT(fieldNames, 3, mkChar("data"));
+
+    PROTECT(res = NEW_LIST(nseqs));
+    PROTECT(resNames = NEW_CHARACTER(nseqs));
+
+    {
+    CGDACSequenceResultItem seq;
+    std::vector<float> values;
+    for (int ss = 0; ss < nseqs; ss++) {
+      int idx = length(sequences) > 0 ? INTEGER(sequences)[ss] - 1 : ss;
+      bar.GetResults(idx, seq);
+      if (i_verboseFlag >= R_AFFX_VERBOSE) {
+        Rprintf("Sequence %d/%d: %s\n", ss+1, nseqs, seq.GetName().c_str());
+      }
+
+      /* The rows of the region */
+      int first = 0, count = seq.GetNumberDataPoints();
+      if (hasRegion) {
+        first = seq.LowerBound(0, start);
+        int last = (end == INT_MAX) ? count : seq.LowerBound(0, end + 1);
+        if (first < 0 || last < 0) {
+          snprintf(msg, sizeof(msg), "Failed to read sequence '%s' of BAR file: %s",
+                   seq.GetName().c_str(), barFileName);
+          break;
+        }
+        count = (last > first) ? last - first : 0;
+      }
+
+      SEXP elt, data;
+      PROTECT(elt = NEW_LIST(4));
+      SET_VECTOR_ELT(elt, 0, mkString(seq.GetGroupName().c_str()));
+      SET_VECTOR_ELT(elt, 1, mkString(seq.GetVersion().c_str()));
+      std::vector<TagValuePairType> seqParams(seq.GetNumberParameters());
+      for (int ii = 0; ii < seq.GetNumberParameters(); ii++) seqParams[ii] = seq.GetParameter(ii);
+      SET_VECTOR_ELT(elt, 2, R_affx_bar_parameters(seq.GetNumberParameters(), seqParams));
+
+      PROTECT(data = NEW_LIST(ncols));
+      bool ok = true;
+      for (int cc = 0; ok && cc < ncols; cc++) {
+        SEXP col;
+        if (seq.GetColumnType(cc) == BAR_DATA_INTEGER) {
+          PROTECT(col = NEW_INTEGER(count));
+          ok = seq.GetIntColumnRange(cc, first, count, (int32_t*) INTEGER(col));
+        } else {
+          PROTECT(col = NEW_NUMERIC(count));
+          values.resize(count);
+          ok = seq.GetFloatColumnRange(cc, first, count, count > 0 ? &values[0] : NULL);
+          for (int ii = 0; ok && ii < count; ii++) REAL(col)[ii] = values[ii];
+        }
+        SET_VECTOR_ELT(data, cc, col);
+        UNPROTECT(1);
+      }
+      setAttrib(data, R_NamesSymbol, colNames);
+      SET_VECTOR_ELT(elt, 3, data);
+      setAttrib(elt, R_NamesSymbol, fieldNames);
+      SET_VECTOR_ELT(res, ss, elt);
+      SET_STRING_ELT(resNames, ss, mkChar(seq.GetName().c_str()));
+      UNPROTECT(2);
+
+      if (!ok) {
+        snprintf(msg, sizeof(msg), "Failed to read sequence '%s' of BAR file: %s",
+                 seq.GetName().c_str(), barFileName);
+        break;
+      }
+    }
+    } /* 'seq' and 'values' are released before any error() */
+
+    if (msg[0] != '\0') {
+      UNPROTECT(4);
+      bar.Close();
+      error("%s", msg);
+    }
+
+    setAttrib(res, R_NamesSymbol, resNames);
+    UNPROTECT(4);
+    return res;
+  } /* R_affx_get_bar_file() */
+
+} /** end extern "C" **/
+
+/***************************************************************************
+ * HISTORY:
+ * 2026-10-19
+ * o Created.  Added R_affx_get_bar_header() and R_affx_get_bar_file().
+ **************************************************************************/
@@ -0,0 +1,471 @@
+#include "GenericData.h"
+#include "GenericFileReader.h"
+#include "DataSet.h"
+#include "DataException.h"
+#include "ParameterNameValueType.h"
+#include "StringUtils.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "R_affx_constants.h"
+
+using namespace std;
+using namespace affymetrix_calvin_io;
+using namespace affymetrix_calvin_parameter;
+using namespace affymetrix_calvin_utilities;
+
+#include <R.h>
+#include <Rdefines.h>
+#include "R_affx_strings.h"
+
+#define SET_NAMED_ELT(lst, index, val, nameLst, nameVal) \
+  SET_VECTOR_ELT(lst, index, val); \
+  SET_STRING_ELT(nameLst, index, mkChar(nameVal))
+
+
+/************************************************************************
+ *
+ * R_affx_ccg_parameters()
+ *
+ * Returns a named list of name/value/type parameters.  Each value is
+ * decoded according to its MIME type, which is also set as attribute
+ * 'mimeType'.  Values of unknown MIME types are returned as raw vectors.
+ *
+ ************************************************************************/
+static SEXP R_affx_ccg_parameters(ParameterNameValueTypeIt begin,
+                                  ParameterNameValueTypeIt end)
+{
+  SEXP params, names, value;
+  int nparams = 0, kk = 0;
+
+  for (ParameterNameValueTypeIt it = begin; it != end; ++it) nparams++;
+
+  PROTECT(params = NEW_LIST(nparams));
+  PROTECT(names = NEW_CHARACTER(nparams));
+
+  for (ParameterNameValueTypeIt it = begin; it != end; ++it, ++kk) {
+    switch (it->GetParameterType()) {
+    case ParameterNameValueType::Int8Type:
+      PROTECT(value = ScalarInteger(it->GetValueInt8()));
+      break;
+    case ParameterNameValueType::UInt8Type:
+      PROTECT(value = ScalarInteger(it->GetValueUInt8()));
+      break;
+    case ParameterNameValueType::Int16Type:
+      PROTECT(value = ScalarInteger(it->GetValueInt16()));
+      break;
+    case ParameterNameValueType::UInt16Type:
+      PROTECT(value = ScalarInteger(it->GetValueUInt16()));
+      break;
+    case ParameterNameValueType::Int32Type:
+      PROTECT(value = ScalarInteger(it->GetValueInt32()));
+      break;
+    case ParameterNameValueType::UInt32Type:
+      /* As in the pure-R parser, assume values <= .Machine$integer.max */
+      PROTECT(value = ScalarInteger((int) it->GetValueUInt32()));
+      break;
+    case ParameterNameValueType::FloatType:
+      PROTECT(value = ScalarReal(it->GetValueFloat()));
+      break;
+    case ParameterNameValueType::TextType:
+      PROTECT(value = R_affx_mkStringUTF8(it->GetValueText()));
+      break;
+    case ParameterNameValueType::AsciiType:
+      PROTECT(value = mkString(it->GetValueAscii().c_str()));
+      break;
+    default: {
+      u_int32_t size = 0;
+      MIMEValue mime = it->GetMIMEValue();
+      const void *bytes = mime.GetValue(size);
+      PROTECT(value = NEW_RAW(size));
+      if (size > 0) memcpy(RAW(value), bytes, size);
+      }
+    }
+    setAttrib(value, install("mimeType"), R_affx_mkStringUTF8(it->GetMIMEType()));
+    SET_VECTOR_ELT(params, kk, value);
+    SET_STRING_ELT(names, kk, R_affx_mkCharUTF8(it->GetName()));
+    UNPROTECT(1);
+  }
+
+  SET_NAMES(params, names);
+  UNPROTECT(2);
+  return params;
+}
+
+
+/************************************************************************
+ *
+ * R_affx_ccg_data_header()
+ *
+ * Returns the generic data header, including all of its parent headers.
+ *
+ ************************************************************************/
+static SEXP R_affx_ccg_data_header(GenericDataHeader& hdr)
+{
+  SEXP res, names, params, parents;
+  ParameterNameValueTypeIt begin, end;
+  vector<GenericDataHeader>::iterator pbegin, pend;
+
+  PROTECT(res = NEW_LIST(6));
+  PROTECT(names = NEW_CHARACTER(6));
+
+  SET_NAMED_ELT(res, 0, mkString(hdr.GetFileTypeId().c_str()), names, "dataTypeId");
+  SET_NAMED_ELT(res, 1, mkString(hdr.GetFileId().c_str()), names, "fileId");
+  SET_NAMED_ELT(res, 2, R_affx_mkStringUTF8(hdr.GetFileCreationTime()), names, "timestamp");
+  SET_NAMED_ELT(res, 3, R_affx_mkStringUTF8(hdr.GetLocale()), names, "locale");
+
+  hdr.GetNameValIterators(begin, end);
+  PROTECT(params = R_affx_ccg_parameters(begin, end));
+  SET_NAMED_ELT(res, 4, params, names, "parameters");
+  UNPROTECT(1);
+
+  hdr.GetParentIterators(pbegin, pend);
+  PROTECT(parents = NEW_LIST(pend - pbegin));
+  for (vector<GenericDataHeader>::iterator it = pbegin; it != pend; ++it) {
+    SET_VECTOR_ELT(parents, it - pbegin, R_affx_ccg_data_header(*it));
+  }
+  SET_NAMED_ELT(res, 5, parents, names, "parents");
+  UNPROTECT(1);
+
+  SET_NAMES(res, names);
+  UNPROTECT(2);
+  return res;
+}
+
+
+static SEXP R_affx_ccg_file_header(FileHeader& hdr)
+{
+  SEXP res, names;
+
+  PROTECT(res = NEW_LIST(3));
+  PROTECT(names = NEW_CHARACTER(3));
+  SET_NAMED_ELT(res, 0, ScalarInteger(hdr.GetVersion()), names, "version");
+  SET_NAMED_ELT(res, 1, ScalarInteger(hdr.GetNumDataGroups()), names, "nbrOfDataGroups");
+  SET_NAMED_ELT(res, 2, ScalarInteger((int) hdr.GetFirstDataGroupFilePos()), names, "dataGroupStart");
+  SET_NAMES(res, names);
+  UNPROTECT(2);
+  return res;
+}
+
+
+/************************************************************************
+ *
+ * R_affx_ccg_column()
+ *
+ * Reads rows [startRow, startRow+count) of one column as a whole typed
+ * vector using DataSet::GetDataRaw().  Unsigned 32-bit integers are
+ * returned as (signed) integers, cf. the pure-R parser.
+ *
+ ************************************************************************/
+template<typename T>
+static void R_affx_ccg_widen(DataSet *ds, int col, int startRow, int count, int *dest)
+{
+  vector<T> buffer(count);
+  if (count > 0) ds->GetDataRaw(col, startRow, count, &buffer[0]);
+  for (int rr = 0; rr < count; rr++) dest[rr] = (int) buffer[rr];
+}
+
+static SEXP R_affx_ccg_column(DataSet *ds, int col, DataSetColumnTypes type,
+                              int startRow, int count)
+{
+  SEXP value = R_NilValue;
+
+  switch (type) {
+  case ByteColType:
+    PROTECT(value = NEW_INTEGER(count));
+    R_affx_ccg_widen<int8_t>(ds, col, startRow, count, INTEGER(value));
+    break;
+  case UByteColType:
+    PROTECT(value = NEW_INTEGER(count));
+    R_affx_ccg_widen<u_int8_t>(ds, col, startRow, count, INTEGER(value));
+    break;
+  case ShortColType:
+    PROTECT(value = NEW_INTEGER(count));
+    R_affx_ccg_widen<int16_t>(ds, col, startRow, count, INTEGER(value));
+    break;
+  case UShortColType:
+    PROTECT(value = NEW_INTEGER(count));
+    R_affx_ccg_widen<u_int16_t>(ds, col, startRow, count, INTEGER(value));
+    break;
+  case IntColType:
+    PROTECT(value = NEW_INTEGER(count));
+    if (count > 0) ds->GetDataRaw(col, startRow, count, (int32_t *) INTEGER(value));
+    break;
+  case UIntColType:
+    PROTECT(value = NEW_INTEGER(count));
+    if (count > 0) ds->GetDataRaw(col, startRow, count, (u_int32_t *) INTEGER(value));
+    break;
+  case FloatColType: {
+    vector<float> buffer(count);
+    double *dest;
+    PROTECT(value = NEW_NUMERIC(count));
+    if (count > 0) ds->GetDataRaw(col, startRow, count, &buffer[0]);
+    dest = REAL(value);
+    for (int rr = 0; rr < count; rr++) dest[rr] = buffer[rr];
+    break;
+    }
+  case ASCIICharColType: {
+    vector<string> buffer(count);
+    PROTECT(value = NEW_CHARACTER(count));
+    if (count > 0) ds->GetDataRaw(col, startRow, count, &buffer[0]);
+    for (int rr = 0; rr < count; rr++)
+      SET_STRING_ELT(value, rr, mkChar(buffer[rr].c_str()));
+    break;
+    }
+  case UnicodeCharColType: {
+    /* Decoded straight from UTF-16 to UTF-8, reusing one buffer */
+    string buffer;
+    PROTECT(value = NEW_CHARACTER(count));
+    for (int rr = 0; rr < count; rr++) {
+      ds->GetDataUTF8(startRow+rr, col, buffer);
+      SET_STRING_ELT(value, rr, R_affx_mkCharUTF8(buffer));
+    }
+    break;
+    }
+  default:
+    PROTECT(value = R_NilValue);
+  }
+
+  UNPROTECT(1);
+  return value;
+}
+
+
+/************************************************************************
+ *
+ * R_affx_ccg_data_set()
+ *
+ * Returns the header fields and the table (a data.frame) of one data set.
+ * Only rows [startRow, startRow+count) are read, where count < 0 means
+ * all remaining rows.
+ *
+ ************************************************************************/
+static SEXP R_affx_ccg_data_set(GenericData& gd, int groupIdx, int setIdx,
+                                int startRow, int count)
+{
+  SEXP res, names, params, table, tableNames, rowNames;
+  ParameterNameValueTypeIt begin, end;
+  int ncols, nrows;
+
+  DataSetHeader *dsh = gd.FindDataSetHeader(gd.FindDataGroupHeader(groupIdx), setIdx);
+  gd.ReadFullDataSetHeader(dsh);
+
+  ncols = dsh->GetColumnCnt();
+  nrows = dsh->GetRowCnt();
+  if (startRow < 0 || startRow > nrows) startRow = nrows;
+  if (count < 0 || count > nrows - startRow) count = nrows - startRow;
+
+  PROTECT(res = NEW_LIST(5));
+  PROTECT(names = NEW_CHARACTER(5));
+
+  SET_NAMED_ELT(res, 0, ScalarInteger((int) dsh->GetDataStartFilePos()), names, "elementsStart");
+  SET_NAMED_ELT(res, 1, ScalarInteger((int) dsh->GetNextSetFilePos()), names, "nextDataSetStart");
+  SET_NAMED_ELT(res, 2, R_affx_mkStringUTF8(dsh->GetName()), names, "name");
+
+  dsh->GetNameValIterators(begin, end);
+  PROTECT(params = R_affx_ccg_parameters(begin, end));
+  SET_NAMED_ELT(res, 3, params, names, "parameters");
+  UNPROTECT(1);
+
+  PROTECT(table = NEW_LIST(ncols));
+  PROTECT(tableNames = NEW_CHARACTER(ncols));
+  if (ncols > 0) {
+    DataSet *ds = gd.DataSet(groupIdx, setIdx);
+    try {
+      if (ds->Open() == false) {
+        affymetrix_calvin_exceptions::DataSetNotOpenException e;
+        throw e;
+      }
+      for (int cc = 0; cc < ncols; cc++) {
+        ColumnInfo info = dsh->GetColumnInfo(cc);
+        SET_VECTOR_ELT(table, cc, R_affx_ccg_column(ds, cc, info.GetColumnType(), startRow, count));
+        SET_STRING_ELT(tableNames, cc, R_affx_mkCharUTF8(info.GetName()));
+      }
+    } catch (...) {
+      ds->Delete();
+      throw;
+    }
+    ds->Delete();
+  }
+  /* Turn into a data frame with compact row names */
+  PROTECT(rowNames = NEW_INTEGER(2));
+  INTEGER(rowNames)[0] = NA_INTEGER;
+  INTEGER(rowNames)[1] = -count;
+  setAttrib(table, R_RowNamesSymbol, rowNames);
+  SET_NAMES(table, tableNames);
+  setAttrib(table, R_ClassSymbol, mkString("data.frame"));
+  SET_NAMED_ELT(res, 4, table, names, "table");
+  UNPROTECT(3);
+
+  SET_NAMES(res, names);
+  UNPROTECT(2);
+  return res;
+}
+
+
+/************************************************************************
+ *
+ * R_affx_ccg_select()
+ *
+ * Resolves a selection of data groups or data sets, given either as
+ * zero-based indices or as names, to zero-based indices.  NULL selects
+ * all.  Unknown names and out-of-range indices throw an exception.
+ *
+ ************************************************************************/
+static void R_affx_ccg_select(SEXP selection, const vector<wstring>& names,
+                              const char *what, vector<int>& idxs)
+{
+  char msg[1024];
+
+  idxs.clear();
+  if (isNull(selection)) {
+    for (int ii = 0; ii < (int) names.size(); ii++) idxs.push_back(ii);
+  } else if (isString(selection)) {
+    for (int ii = 0; ii < length(selection); ii++) {
+      const char *name = CHAR(STRING_ELT(selection, ii));
+      int match = -1;
+      for (int jj = 0; jj < (int) names.size() && match < 0; jj++) {
+        if (StringUtils::ConvertWCSToUTF8(names[jj]) == name) match = jj;
+      }
+      if (match < 0) {
+        snprintf(msg, sizeof(msg), "Argument '%s' contains an unknown name: %s", what, name);
+        throw invalid_argument(msg);
+      }
+      idxs.push_back(match);
+    }
+  } else {
+    int *values = INTEGER(selection);
+    for (int ii = 0; ii < length(selection); ii++) {
+      if (values[ii] < 0 || values[ii] >= (int) names.size()) {
+        snprintf(msg, sizeof(msg), "Argument '%s' contains an index out of range [1,%d]: %d",
+                 what, (int) names.size(), values[ii]+1);
+        throw invalid_argument(msg);
+      }
+      idxs.push_back(values[ii]);
+    }
+  }
+}
+
+
+extern "C" {
+
+  /************************************************************************
+   *
+   * R_affx_get_ccg_file()
+   *
+   * Reads a Command Console Generic (Calvin) file using the Fusion SDK.
+   * The returned structure is the same as the one of the pure-R parser.
+   *
+   * Arguments:
+   *  fname      - the pathname.
+   *  readData   - if FALSE, only the file header and the generic data
+   *               header are read.
+   *  groups     - data groups to read (zero-based indices or names).
+   *  sets       - data sets to read within each selected data group.
+   *  rows       - NULL or c(startRow, count) with a zero-based startRow.
+   *
+   ************************************************************************/
+  SEXP R_affx_get_ccg_file(SEXP fname, SEXP readData, SEXP groups,
+                           SEXP sets, SEXP rows)
+  {
+    SEXP result = R_NilValue, names, dataGroups, groupNames;
+    const char *ccgFileName = CHAR(STRING_ELT(fname, 0));
+    bool readGroups = (LOGICAL(readData)[0] != 0);
+    int startRow = 0, count = -1, nprotect = 0;
+    char msg[1024] = "";
+
+    if (!isNull(rows)) {
+      startRow = INTEGER(rows)[0];
+      count = INTEGER(rows)[1];
+    }
+
+    /* C++ objects live in this block only, such that errors can be
+       signalled (longjmp) when they are gone */
+    {
+      GenericData gd;
+      try {
+        GenericFileReader reader;
+        reader.SetFilename(ccgFileName);
+        reader.ReadHeader(gd, readGroups ? GenericFileReader::ReadLazyDataGroupHeader
+                                         : GenericFileReader::ReadNoDataGroupHeader);
+
+        FileHeader& fh = gd.Header();
+        PROTECT(result = NEW_LIST(readGroups ? 3 : 2)); nprotect++;
+        PROTECT(names = NEW_CHARACTER(readGroups ? 3 : 2)); nprotect++;
+        SET_NAMED_ELT(result, 0, R_affx_ccg_file_header(fh), names, "fileHeader");
+        SET_NAMED_ELT(result, 1, R_affx_ccg_data_header(*fh.GetGenericDataHdr()), names, "genericDataHeader");
+
+        if (readGroups) {
+          vector<wstring> allGroupNames;
+          vector<int> groupIdxs;
+          gd.DataGroupNames(allGroupNames);
+          R_affx_ccg_select(groups, allGroupNames, "groups", groupIdxs);
+
+          PROTECT(dataGroups = NEW_LIST(groupIdxs.size())); nprotect++;
+          PROTECT(groupNames = NEW_CHARACTER(groupIdxs.size())); nprotect++;
+          for (size_t gg = 0; gg < groupIdxs.size(); gg++) {
+            SEXP dataGroup, dataGroupNames, header, headerNames, dataSets, setNames;
+            DataGroupHeader *dch = gd.FindDataGroupHeader(groupIdxs[gg]);
+            vector<wstring> allSetNames;
+            vector<int> setIdxs;
+
+            gd.DataSetNames(groupIdxs[gg], allSetNames);
+            R_affx_ccg_select(sets, allSetNames, "sets", setIdxs);
+
+            PROTECT(header = NEW_LIST(4));
+            PROTECT(headerNames = NEW_CHARACTER(4));
+            SET_NAMED_ELT(header, 0, ScalarInteger((int) dch->GetNextGroupPos()), headerNames, "nextGroupStart");
+            SET_NAMED_ELT(header, 1, ScalarInteger((int) dch->GetDataSetPos()), headerNames, "dataSetStart");
+            SET_NAMED_ELT(header, 2, ScalarInteger(dch->GetDataSetCnt()), headerNames, "nbrOfDataSets");
+            SET_NAMED_ELT(header, 3, R_affx_mkStringUTF8(dch->GetName()), headerNames, "name");
+            SET_NAMES(header, headerNames);
+
+            PROTECT(dataSets = NEW_LIST(setIdxs.size()));
+            PROTECT(setNames = NEW_CHARACTER(setIdxs.size()));
+            for (size_t ss = 0; ss < setIdxs.size(); ss++) {
+              SET_VECTOR_ELT(dataSets, ss, R_affx_ccg_data_set(gd, groupIdxs[gg], setIdxs[ss], startRow, count));
+              SET_STRING_ELT(setNames, ss, R_affx_mkCharUTF8(allSetNames[setIdxs[ss]]));
+            }
+            SET_NAMES(dataSets, setNames);
+
+            PROTECT(dataGroup = NEW_LIST(2));
+            PROTECT(dataGroupNames = NEW_CHARACTER(2));
+            SET_NAMED_ELT(dataGroup, 0, header, dataGroupNames, "header");
+            SET_NAMED_ELT(dataGroup, 1, dataSets, dataGroupNames, "dataSets");
+            SET_NAMES(dataGroup, dataGroupNames);
+
+            SET_VECTOR_ELT(dataGroups, gg, dataGroup);
+            SET_STRING_ELT(groupNames, gg, R_affx_mkCharUTF8(allGroupNames[groupIdxs[gg]]));
+            UNPROTECT(6);
+          }
+          SET_NAMES(dataGroups, groupNames);
+          SET_NAMED_ELT(result, 2, dataGroups, names, "dataGroups");
+        }
+        SET_NAMES(result, names);
+      } catch (std::exception& ex) {
+        snprintf(msg, sizeof(msg), "%s", ex.what());
+      } catch (...) {
+        snprintf(msg, sizeof(msg), "[affxparser Fusion SDK exception] Failed to parse CCG file: %s", ccgFileName);
+      }
+    }
+
+    /* Signal errors only when all C++ objects are gone */
+    UNPROTECT(nprotect);
+    if (msg[0] != '\0') {
+      error("%s", msg);
+    }
+
+    return result;
+  }
+
+} /** end extern "C" **/
+
+/***************************************************************************
+ * HISTORY:
+ * 2026-10-19
+ * o Created.  A native backend for readCcg() and readCcgHeader() based on
+ *   GenericData and DataSet::GetDataRaw().  Data sets are indexed lazily,
+ *   so that only selected data groups, data sets and rows are read.
+ * o Unicode columns are decoded straight to UTF-8 by DataSet::GetDataUTF8().
+ **************************************************************************/
@@ -0,0 +1,421 @@
+#include "FusionCDFData.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "R_affx_constants.h"
+#include "R_affx_thread_pool.h"
+
+using namespace std;
+using namespace affymetrix_fusion_io;
+
+#include <R.h>
+#include <Rdefines.h>
+
+extern "C" {
+  /************************************************************************
+   *
+   * Comparing CDF files
+   *
+   * The two files are walked in lockstep through the Fusion CDF reader
+   * and the fields that readCdf() returns are compared one by one, so a
+   * comparison stops at the first field that differs and no unit is ever
+   * turned into an R object.  Binary (XDA) CDF files are read unit by
+   * unit from disk, which makes it cheap for each worker to open its own
+   * readers and compare a range of units of its own.
+   *
+   ************************************************************************/
+  typedef std::pair<int, std::string> R_affx_cdf_difference;
+
+  static void R_affx_cdf_open(FusionCDFData& cdf, const char* fileName)
+  {
+    cdf.SetFileName(fileName);
+    if (cdf.Read() == false) {
+      char msg[1024];
+      snprintf(msg, sizeof(msg), "Failed to read the CDF file: %s", fileName);
+      throw std::runtime_error(msg);
+    }
+  }
+
+  static bool R_affx_cdf_differs(std::string& reason, const char* where,
+                                 const char* field, int value1, int value2)
+  {
+    if (value1 == value2) return false;
+    char buf[512];
+    snprintf(buf, sizeof(buf), "%sfield '%s' differs: %d != %d",
+             where, field, value1, value2);
+    reason = buf;
+    return true;
+  }
+
+  static bool R_affx_cdf_name_differs(std::string& reason, const char* where,
+                                      const char* field, const std::string& value1,
+                                      const std::string& value2)
+  {
+    if (value1 == value2) return false;
+    char buf[512];
+    snprintf(buf, sizeof(buf), "%sfield '%s' differs: '%s' != '%s'",
+             where, field, value1.c_str(), value2.c_str());
+    reason = buf;
+    return true;
+  }
+
+
+  /************************************************************************
+   *
+   * R_affx_cdf_compare_unit()
+   *
+   * Compares unit 'uu' (zero-based) of two CDF files.  Returns false
+   * and a description of the first difference in 'reason' if they
+   * differ.
+   *
+   ************************************************************************/
+  static bool R_affx_cdf_compare_unit(FusionCDFData& cdf1, FusionCDFData& cdf2,
+                                      int uu, std::string& reason)
+  {
+    FusionCDFProbeSetInformation unit1, unit2;
+    FusionCDFProbeGroupInformation group1, group2;
+    FusionCDFProbeInformation probe1, probe2;
+    char where[256] = "";
+
+    if (R_affx_cdf_name_differs(reason, where, "name",
+                                cdf1.GetProbeSetName(uu), cdf2.GetProbeSetName(uu)))
+      return false;
+
+    cdf1.GetProbeSetInformation(uu, unit1);
+    cdf2.GetProbeSetInformation(uu, unit2);
+    if (R_affx_cdf_differs(reason, where, "unittype",
+                           unit1.GetProbeSetType(), unit2.GetProbeSetType()) ||
+        R_affx_cdf_differs(reason, where, "unitdirection",
+                           unit1.GetDirection(), unit2.GetDirection()) ||
+        R_affx_cdf_differs(reason, where, "natoms",
+                           unit1.GetNumLists(), unit2.GetNumLists()) ||
+        R_affx_cdf_differs(reason, where, "ncells",
+                           unit1.GetNumCells(), unit2.GetNumCells()) ||
+        R_affx_cdf_differs(reason, where, "unitnumber",
+                           unit1.GetProbeSetNumber(), unit2.GetProbeSetNumber()) ||
+        R_affx_cdf_differs(reason, where, "ncellsperatom",
+                           unit1.GetNumCellsPerList(), unit2.GetNumCellsPerList()) ||
+        R_affx_cdf_differs(reason, where, "ngroups",
+                           unit1.GetNumGroups(), unit2.GetNumGroups()))
+      return false;
+
+    int ngroups = unit1.GetNumGroups();
+    for (int gg = 0; gg < ngroups; gg++) {
+      unit1.GetGroupInformation(gg, group1);
+      unit2.GetGroupInformation(gg, group2);
+      snprintf(where, sizeof(where), "group #%d: ", gg+1);
+      if (R_affx_cdf_name_differs(reason, where, "name",
+                                  group1.GetName(), group2.GetName()) ||
+          R_affx_cdf_differs(reason, where, "natoms",
+                             group1.GetNumLists(), group2.GetNumLists()) ||
+          R_affx_cdf_differs(reason, where, "ncells",
+                             group1.GetNumCells(), group2.GetNumCells()) ||
+          R_affx_cdf_differs(reason, where, "ncellsperatom",
+                             group1.GetNumCellsPerList(), group2.GetNumCellsPerList()) ||
+          R_affx_cdf_differs(reason, where, "groupdirection",
+                             group1.GetDirection(), group2.GetDirection()))
+        return false;
+
+      int ncells = group1.GetNumCells();
+      for (int cc = 0; cc < ncells; cc++) {
+        group1.GetCell(cc, probe1);
+        group2.GetCell(cc, probe2);
+        if (probe1.GetX() == probe2.GetX() && probe1.GetY() == probe2.GetY() &&
+            probe1.GetListIndex() == probe2.GetListIndex() &&
+            probe1.GetExpos() == probe2.GetExpos() &&
+            probe1.GetPBase() == probe2.GetPBase() &&
+            probe1.GetTBase() == probe2.GetTBase())
+          continue;
+        snprintf(where, sizeof(where), "group #%d, cell #%d: ", gg+1, cc+1);
+        if (R_affx_cdf_differs(reason, where, "x", probe1.GetX(), probe2.GetX()) ||
+            R_affx_cdf_differs(reason, where, "y", probe1.GetY(), probe2.GetY()) ||
+            R_affx_cdf_differs(reason, where, "indexpos",
+                               probe1.GetListIndex(), probe2.GetListIndex()) ||
+            R_affx_cdf_differs(reason, where, "atom",
+                               probe1.GetExpos(), probe2.GetExpos()) ||
+            R_affx_cdf_differs(reason, where, "pbase",
+                               probe1.GetPBase(), probe2.GetPBase()) ||
+            R_affx_cdf_differs(reason, where, "tbase",
+                               probe1.GetTBase(), probe2.GetTBase()))
+          return false;
+      }
+    }
+
+    return true;
+  }
+
+
+  /************************************************************************
+   *
+   * R_affx_cdf_compare_qcunit()
+   *
+   * Compares QC unit 'uu' (zero-based) of two CDF files.
+   *
+   ************************************************************************/
+  static bool R_affx_cdf_compare_qcunit(FusionCDFData& cdf1, FusionCDFData& cdf2,
+                                        int uu, std::string& reason)
+  {
+    FusionCDFQCProbeSetInformation unit1, unit2;
+    FusionCDFQCProbeInformation probe1, probe2;
+    char where[256] = "";
+
+    cdf1.GetQCProbeSetInformation(uu, unit1);
+    cdf2.GetQCProbeSetInformation(uu, unit2);
+    if (R_affx_cdf_differs(reason, where, "type",
+                           unit1.GetQCProbeSetType(), unit2.GetQCProbeSetType()) ||
+        R_affx_cdf_differs(reason, where, "ncells",
+                           unit1.GetNumCells(), unit2.GetNumCells()))
+      return false;
+
+    int ncells = unit1.GetNumCells();
+    for (int cc = 0; cc < ncells; cc++) {
+      unit1.GetProbeInformation(cc, probe1);
+      unit2.GetProbeInformation(cc, probe2);
+      snprintf(where, sizeof(where), "cell #%d: ", cc+1);
+      if (R_affx_cdf_differs(reason, where, "x", probe1.GetX(), probe2.GetX()) ||
+          R_affx_cdf_differs(reason, where, "y", probe1.GetY(), probe2.GetY()) ||
+          R_affx_cdf_differs(reason, where, "length",
+                             probe1.GetPLen(), probe2.GetPLen()) ||
+          R_affx_cdf_differs(reason, where, "pm",
+                             probe1.IsPerfectMatchProbe(), probe2.IsPerfectMatchProbe()) ||
+          R_affx_cdf_differs(reason, where, "background",
+                             probe1.IsBackgroundProbe(), probe2.IsBackgroundProbe()))
+        return false;
+    }
+
+    return true;
+  }
+
+
+  /************************************************************************
+   *
+   * R_affx_cdf_compare_units()
+   *
+   * Compares the units units[0], ..., units[nbrOfUnits-1] (zero-based)
+   * of two CDF files.  The units are handed out in chunks to a pool of
+   * workers and no new chunks are handed out once 'maxDifferences'
+   * units that differ have been found.  Since chunks are handed out in
+   * order and every chunk taken is completed, the differences found
+   * always include the first 'maxDifferences' ones, which are returned
+   * in the order the units are given.
+   *
+   ************************************************************************/
+  static std::vector<R_affx_cdf_difference>
+  R_affx_cdf_compare_units(FusionCDFData& cdf1, FusionCDFData& cdf2,
+                           const char* fileName1, const char* fileName2,
+                           const std::vector<int>& units, int maxDifferences,
+                           int nbrOfWorkers, bool qc)
+  {
+    const int chunkSize = 256;
+    int nbrOfUnits = (int) units.size();
+    std::vector<R_affx_cdf_difference> differences;
+    std::atomic<int> nbrOfDifferences(0);
+    std::mutex mutex;
+    R_affx_work_queue queue(nbrOfUnits, chunkSize);
+
+    auto compare = [&](FusionCDFData& c1, FusionCDFData& c2) {
+      std::string reason;
+      int start, stop;
+      while (nbrOfDifferences < maxDifferences && queue.next(start, stop)) {
+        int found = 0;
+        for (int ii = start; ii < stop && found < maxDifferences; ii++) {
+          bool equal = qc ? R_affx_cdf_compare_qcunit(c1, c2, units[ii], reason) :
+                            R_affx_cdf_compare_unit(c1, c2, units[ii], reason);
+          if (equal) continue;
+          found++;
+          nbrOfDifferences++;
+          std::lock_guard<std::mutex> lock(mutex);
+          differences.push_back(R_affx_cdf_difference(ii, reason));
+        }
+      }
+    };
+
+    /* Text CDF files are parsed into memory as a whole, so they are
+       compared by a single reader of each file */
+    if (!FusionCDFData::IsXDACompatibleFile(fileName1) ||
+        !FusionCDFData::IsXDACompatibleFile(fileName2)) {
+      nbrOfWorkers = 1;
+    }
+
+    /* The first worker uses the readers already opened */
+    R_affx_run_workers(queue, nbrOfWorkers, [&](int worker) {
+      if (worker == 0) {
+        compare(cdf1, cdf2);
+      } else {
+        FusionCDFData c1, c2;
+        R_affx_cdf_open(c1, fileName1);
+        R_affx_cdf_open(c2, fileName2);
+        compare(c1, c2);
+      }
+    });
+
+    /* Report the differences as the unit indices asked for */
+    std::sort(differences.begin(), differences.end());
+    if ((int) differences.size() > maxDifferences) differences.resize(maxDifferences);
+    for (size_t ii = 0; ii < differences.size(); ii++) {
+      differences[ii].first = units[differences[ii].first];
+    }
+
+    return differences;
+  }
+
+
+  static SEXP R_affx_cdf_differences(const std::vector<R_affx_cdf_difference>& differences)
+  {
+    SEXP res = R_NilValue, names = R_NilValue, units = R_NilValue, reasons = R_NilValue;
+    int n = (int) differences.size();
+
+    PROTECT(res = NEW_LIST(2));
+    PROTECT(names = NEW_CHARACTER(2));
+    PROTECT(units = NEW_INTEGER(n));
+    PROTECT(reasons = NEW_CHARACTER(n));
+    for (int ii = 0; ii < n; ii++) {
+      /* Unit indices are one-based in R */
+      INTEGER(units)[ii] = differences[ii].first + 1;
+      SET_STRING_ELT(reasons, ii, mkChar(differences[ii].second.c_str()));
+    }
+    SET_VECTOR_ELT(res, 0, units);
+    SET_STRING_ELT(names, 0, mkChar("units"));
+    SET_VECTOR_ELT(res, 1, reasons);
+    SET_STRING_ELT(names, 1, mkChar("reasons"));
+    setAttrib(res, R_NamesSymbol, names);
+    UNPROTECT(4);
+
+    return res;
+  }
+
+
+  static std::vector<int> R_affx_cdf_unit_indices(SEXP units, int maxNbrOfUnits)
+  {
+    std::vector<int> indices;
+    if (units == R_NilValue) {
+      indices.resize(maxNbrOfUnits);
+      for (int uu = 0; uu < maxNbrOfUnits; uu++) indices[uu] = uu;
+      return indices;
+    }
+
+    indices.resize(LENGTH(units));
+    for (int uu = 0; uu < LENGTH(units); uu++) {
+      int unitIdx = INTEGER(units)[uu];
+      if (unitIdx == NA_INTEGER || unitIdx < 1 || unitIdx > maxNbrOfUnits) {
+        char msg[1024];
+        snprintf(msg, sizeof(msg), "Argument 'units' contains an element out of range: %d", unitIdx);
+        throw std::runtime_error(msg);
+      }
+      /* Unit indices are zero-based in Fusion SDK. */
+      indices[uu] = unitIdx - 1;
+    }
+    return indices;
+  }
+
+
+  /************************************************************************
+   *
+   * R_affx_compare_cdf_files()
+   *
+   * Compares two CDF files.  Returns a list with elements 'header', a
+   * description of how the headers differ or NULL, 'qcunits' and
+   * 'units', each a list of the (one-based) indices of the (QC) units
+   * that differ and a description of each difference.  At most
+   * 'maxDifferences' (QC) units that differ are reported, and when the
+   * headers or the QC units already differ the units are not compared.
+   * Argument 'units' selects the units to compare; NULL for all.
+   *
+   ************************************************************************/
+  SEXP R_affx_compare_cdf_files(SEXP fname, SEXP other, SEXP units,
+                                SEXP maxDifferences, SEXP workers, SEXP verbose)
+  {
+    SEXP res = R_NilValue, names = R_NilValue;
+    char msg[1024] = "";
+    std::string header;
+    std::vector<R_affx_cdf_difference> qcDifferences, differences;
+
+    /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+     * Process arguments
+     * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+    const char* cdfFileName1 = CHAR(STRING_ELT(fname, 0));
+    const char* cdfFileName2 = CHAR(STRING_ELT(other, 0));
+    int i_maxDifferences = INTEGER(maxDifferences)[0];
+    int i_workers = INTEGER(workers)[0];
+    int i_verboseFlag = INTEGER(verbose)[0];
+    if (i_maxDifferences == NA_INTEGER || i_maxDifferences < 1) i_maxDifferences = INT_MAX;
+    if (i_workers < 1) i_workers = 1;
+
+    try {
+      FusionCDFData cdf1, cdf2;
+      if (i_verboseFlag >= R_AFFX_VERBOSE) {
+        Rprintf("Comparing CDF files: %s and %s\n", cdfFileName1, cdfFileName2);
+      }
+      R_affx_cdf_open(cdf1, cdfFileName1);
+      R_affx_cdf_open(cdf2, cdfFileName2);
+
+      /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+       * Compare headers
+       * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+      FusionCDFFileHeader& header1 = cdf1.GetHeader();
+      FusionCDFFileHeader& header2 = cdf2.GetHeader();
+      if (!R_affx_cdf_differs(header, "", "nrows", header1.GetRows(), header2.GetRows()) &&
+          !R_affx_cdf_differs(header, "", "ncols", header1.GetCols(), header2.GetCols()) &&
+          !R_affx_cdf_differs(header, "", "nunits",
+                              header1.GetNumProbeSets(), header2.GetNumProbeSets()) &&
+          !R_affx_cdf_differs(header, "", "nqcunits",
+                              header1.GetNumQCProbeSets(), header2.GetNumQCProbeSets())) {
+        R_affx_cdf_name_differs(header, "", "refseq", header1.GetReference(), header2.GetReference());
+      }
+
+      /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+       * Compare QC units and then units
+       * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+      if (header.empty()) {
+        std::vector<int> qcunits = R_affx_cdf_unit_indices(R_NilValue, header1.GetNumQCProbeSets());
+        qcDifferences = R_affx_cdf_compare_units(cdf1, cdf2, cdfFileName1, cdfFileName2,
+                          qcunits, i_maxDifferences, 1, true);
+      }
+      if (header.empty() && qcDifferences.empty()) {
+        std::vector<int> indices = R_affx_cdf_unit_indices(units, header1.GetNumProbeSets());
+        if (i_verboseFlag >= R_AFFX_VERBOSE) {
+          Rprintf("Comparing %d units using %d workers\n", (int) indices.size(), i_workers);
+        }
+        differences = R_affx_cdf_compare_units(cdf1, cdf2, cdfFileName1, cdfFileName2,
+                        indices, i_maxDifferences, i_workers, false);
+      }
+    } catch(std::exception& ex) {
+      snprintf(msg, sizeof(msg), "%s", ex.what());
+    } catch(...) {
+      snprintf(msg, sizeof(msg), "[affxparser Fusion SDK exception] Failed to compare CDF files: %s and %s", cdfFileName1, cdfFileName2);
+    }
+
+    /* Signal errors only when all C++ objects are gone */
+    if (msg[0] != '\0') {
+      error("%s", msg);
+    }
+
+    PROTECT(res = NEW_LIST(3));
+    PROTECT(names = NEW_CHARACTER(3));
+    if (!header.empty()) SET_VECTOR_ELT(res, 0, mkString(header.c_str()));
+    SET_STRING_ELT(names, 0, mkChar("header"));
+    SET_VECTOR_ELT(res, 1, R_affx_cdf_differences(qcDifferences));
+    SET_STRING_ELT(names, 1, mkChar("qcunits"));
+    SET_VECTOR_ELT(res, 2, R_affx_cdf_differences(differences));
+    SET_STRING_ELT(names, 2, mkChar("units"));
+    setAttrib(res, R_NamesSymbol, names);
+    UNPROTECT(2);
+
+    return res;
+  } /* R_affx_compare_cdf_files() */
+
+} /** end extern "C" **/
+
+/***************************************************************************
+ * HISTORY:
+ * 2026-10-19
+ * o Created.  Added R_affx_compare_cdf_files(), which replaces the R code
+ *   of compareCdfs().
+ **************************************************************************/
@@ -0,0 +1,601 @@
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "R_affx_thread_pool.h"
+
+using namespace std;
+
+#include <R.h>
+#include <Rdefines.h>
+
+extern "C" {
+  /************************************************************************
+   *
+   * Merging CDF groups
+   *
+   * Native versions of cdfMergeStrands(), cdfMergeAlleles() and
+   * cdfMergeToQuartets() applied to all units of a CDF list structure,
+   * as done by applyCdfGroups().  The merged fields are laid out by
+   * offset arithmetic: c() and cbind() of column-major vectors and
+   * matrices append the values of one group after the other, whereas
+   * rbind() interleaves the columns of allele A and allele B.
+   *
+   * The output objects are allocated by the main thread, which also
+   * copies character fields, while the numeric values are copied by a
+   * pool of workers afterwards, each taking a range of units at the time.
+   * Units with fields of other shapes or types than those readCdfUnits()
+   * returns are not touched, but are reported back such that they can
+   * be merged by the R functions instead, with identical results.
+   *
+   ************************************************************************/
+  enum R_affx_merge_mode {
+    R_AFFX_MERGE_STRANDS,
+    R_AFFX_MERGE_ALLELES,
+    R_AFFX_MERGE_QUARTETS
+  };
+
+  /* Copies 'ncol' columns of 'bytes' bytes each from 'src' to 'dst',
+     where the columns of 'dst' are 'stride' bytes apart */
+  struct R_affx_merge_job {
+    const char* src;
+    char* dst;
+    size_t bytes;
+    size_t stride;
+    int ncol;
+  };
+
+  /* The shape of a field, which is either a plain vector (nrow < 0)
+     or a matrix (nrow >= 0) */
+  struct R_affx_merge_field {
+    SEXP value;
+    SEXP dimnames;
+    int nrow;
+    int ncol;
+  };
+
+  struct R_affx_merge_state {
+    std::vector<R_affx_merge_job> jobs;
+    std::vector<int> fallback;
+    int mode;
+    int compReverseBases;
+    std::string collapse;
+    SEXP abNames;     /* list(c("A", "B"), NULL) */
+    SEXP lastNames1;  /* The last matrix row names merged by allele... */
+    SEXP lastNames2;
+    SEXP lastDimnames;  /* ...and the dimnames they gave */
+    PROTECT_INDEX lastIndex;
+  };
+
+
+  static size_t R_affx_merge_sizeof(SEXP value)
+  {
+    switch (TYPEOF(value)) {
+      case LGLSXP: return sizeof(int);
+      case INTSXP: return sizeof(int);
+      case REALSXP: return sizeof(double);
+      default: return 0;
+    }
+  }
+
+  static const char* R_affx_merge_data(SEXP value)
+  {
+    switch (TYPEOF(value)) {
+      case LGLSXP: return (const char*) LOGICAL(value);
+      case INTSXP: return (const char*) INTEGER(value);
+      case REALSXP: return (const char*) REAL(value);
+      default: return NULL;
+    }
+  }
+
+  /************************************************************************
+   *
+   * R_affx_merge_shape()
+   *
+   * Gets the shape of a field.  Returns false unless the field is a
+   * logical, integer, double or character vector without names, or such
+   * a matrix without column names; for anything else c(), cbind() and
+   * rbind() have semantics not replicated here.
+   *
+   ************************************************************************/
+  static bool R_affx_merge_shape(SEXP value, R_affx_merge_field& field)
+  {
+    int type = TYPEOF(value);
+    if (type != LGLSXP && type != INTSXP && type != REALSXP && type != STRSXP) return false;
+    if (getAttrib(value, R_ClassSymbol) != R_NilValue) return false;
+    if (getAttrib(value, R_NamesSymbol) != R_NilValue) return false;
+
+    field.value = value;
+    field.dimnames = R_NilValue;
+    SEXP dim = getAttrib(value, R_DimSymbol);
+    if (dim == R_NilValue) {
+      field.nrow = -1;
+      field.ncol = length(value);
+      return true;
+    }
+    if (length(dim) != 2) return false;
+    field.nrow = INTEGER(dim)[0];
+    field.ncol = INTEGER(dim)[1];
+
+    SEXP dimnames = getAttrib(value, R_DimNamesSymbol);
+    if (dimnames != R_NilValue) {
+      if (TYPEOF(dimnames) != VECSXP || length(dimnames) != 2) return false;
+      if (getAttrib(dimnames, R_NamesSymbol) != R_NilValue) return false;
+      if (VECTOR_ELT(dimnames, 1) != R_NilValue) return false;
+      if (VECTOR_ELT(dimnames, 0) != R_NilValue) field.dimnames = dimnames;
+    }
+
+    return true;
+  }
+
+
+  /************************************************************************
+   *
+   * R_affx_merge_alloc()
+   *
+   * Allocates an 'nrow'-by-'ncol' matrix, or a vector if nrow < 0.
+   *
+   ************************************************************************/
+  static SEXP R_affx_merge_alloc(int type, int nrow, int ncol, SEXP dimnames)
+  {
+    SEXP value, dim;
+    if (nrow < 0) return allocVector(type, ncol);
+
+    PROTECT(value = allocVector(type, (R_xlen_t) nrow * ncol));
+    PROTECT(dim = allocVector(INTSXP, 2));
+    INTEGER(dim)[0] = nrow;
+    INTEGER(dim)[1] = ncol;
+    setAttrib(value, R_DimSymbol, dim);
+    if (dimnames != R_NilValue) setAttrib(value, R_DimNamesSymbol, dimnames);
+    UNPROTECT(2);
+
+    return value;
+  }
+
+
+  /************************************************************************
+   *
+   * R_affx_merge_copy()
+   *
+   * Copies the columns of 'src' into every 'stride':th row of 'dst',
+   * starting at row 'offset'.  Character values are copied right away,
+   * other values by the workers later.
+   *
+   ************************************************************************/
+  static void R_affx_merge_copy(R_affx_merge_state& state, SEXP dst, R_xlen_t offset,
+                                R_xlen_t stride, const R_affx_merge_field& src)
+  {
+    R_xlen_t nrow = (src.nrow < 0) ? src.ncol : src.nrow;
+    int ncol = (src.nrow < 0) ? 1 : src.ncol;
+    if (nrow == 0 || ncol == 0) return;
+
+    if (TYPEOF(dst) == STRSXP) {
+      for (int jj = 0; jj < ncol; jj++) {
+        for (R_xlen_t ii = 0; ii < nrow; ii++) {
+          SET_STRING_ELT(dst, offset + jj*stride + ii, STRING_ELT(src.value, jj*nrow + ii));
+        }
+      }
+      return;
+    }
+
+    size_t size = R_affx_merge_sizeof(dst);
+    R_affx_merge_job job;
+    job.src = R_affx_merge_data(src.value);
+    job.dst = (char*) R_affx_merge_data(dst) + offset*size;
+    job.bytes = nrow*size;
+    job.stride = stride*size;
+    job.ncol = ncol;
+    state.jobs.push_back(job);
+  }
+
+
+  /************************************************************************
+   *
+   * R_affx_merge_strands()
+   *
+   * Merges the groups of a unit with the same names, cf. cdfMergeStrands().
+   * Returns R_NilValue if the unit has to be merged in R.
+   *
+   ************************************************************************/
+  static SEXP R_affx_merge_strands(R_affx_merge_state& state, SEXP groups)
+  {
+    int ngroups = length(groups);
+
+    /* Units with an odd number of groups are not merged */
+    if (ngroups % 2 != 0) return groups;
+
+    SEXP names = getAttrib(groups, R_NamesSymbol);
+    if (names == R_NilValue) return R_NilValue;
+    for (int gg = 0; gg < ngroups; gg++) {
+      SEXP name = STRING_ELT(names, gg);
+      if (name == NA_STRING || CHAR(name)[0] == '\0') return R_NilValue;
+      if (TYPEOF(VECTOR_ELT(groups, gg)) != VECSXP) return R_NilValue;
+    }
+
+    /* Group the groups by name, in the order the names first appear */
+    std::vector<int> unique, order;
+    for (int gg = 0; gg < ngroups; gg++) {
+      const char* name = CHAR(STRING_ELT(names, gg));
+      bool seen = false;
+      for (size_t uu = 0; uu < unique.size() && !seen; uu++) {
+        seen = (strcmp(name, CHAR(STRING_ELT(names, unique[uu]))) == 0);
+      }
+      if (seen) continue;
+      unique.push_back(gg);
+      for (int hh = gg; hh < ngroups; hh++) {
+        if (strcmp(name, CHAR(STRING_ELT(names, hh))) == 0) order.push_back(hh);
+      }
+    }
+
+    /* Validate the fields before allocating anything */
+    std::vector<R_affx_merge_field> fields;
+    std::vector<int> first;
+    for (size_t uu = 0, pos = 0; uu < unique.size(); uu++) {
+      first.push_back((int) pos);
+      SEXP group = VECTOR_ELT(groups, order[pos]);
+      int nfields = length(group);
+      size_t end = pos + 1;
+      while (end < order.size() && strcmp(CHAR(STRING_ELT(names, order[end])),
+                                          CHAR(STRING_ELT(names, order[pos]))) == 0) end++;
+      for (size_t kk = pos + 1; kk < end; kk++) {
+        if (length(VECTOR_ELT(groups, order[kk])) < nfields) return R_NilValue;
+      }
+      for (int ff = 0; ff < nfields && end - pos > 1; ff++) {
+        for (size_t kk = pos; kk < end; kk++) {
+          R_affx_merge_field field;
+          if (!R_affx_merge_shape(VECTOR_ELT(VECTOR_ELT(groups, order[kk]), ff), field)) {
+            return R_NilValue;
+          }
+          const R_affx_merge_field& field0 = (kk == pos) ? field : fields[fields.size() - (kk - pos)];
+          if (TYPEOF(field.value) != TYPEOF(field0.value)) return R_NilValue;
+          if ((field.nrow < 0) != (field0.nrow < 0)) return R_NilValue;
+          if (field.nrow >= 0 && field.nrow != field0.nrow) return R_NilValue;
+          fields.push_back(field);
+        }
+      }
+      pos = end;
+    }
+    first.push_back((int) order.size());
+
+    /* Merge */
+    SEXP res, resNames;
+    PROTECT(res = allocVector(VECSXP, unique.size()));
+    PROTECT(resNames = allocVector(STRSXP, unique.size()));
+    size_t nextField = 0;
+    for (size_t uu = 0; uu < unique.size(); uu++) {
+      int pos = first[uu], nmerged = first[uu+1] - first[uu];
+      SEXP group = VECTOR_ELT(groups, order[pos]);
+      SET_STRING_ELT(resNames, uu, STRING_ELT(names, order[pos]));
+      int nfields = length(group);
+      if (nmerged == 1 || nfields == 0) {
+        SET_VECTOR_ELT(res, uu, group);
+        continue;
+      }
+
+      SEXP newGroup;
+      PROTECT(newGroup = shallow_duplicate(group));
+      for (int ff = 0; ff < nfields; ff++) {
+        const R_affx_merge_field* parts = &fields[nextField];
+        nextField += nmerged;
+
+        /* The row names of cbind() are those of the first matrix with any */
+        int ncol = 0;
+        SEXP dimnames = R_NilValue;
+        for (int kk = 0; kk < nmerged; kk++) {
+          ncol += parts[kk].ncol;
+          if (dimnames == R_NilValue) dimnames = parts[kk].dimnames;
+        }
+
+        SEXP value;
+        PROTECT(value = R_affx_merge_alloc(TYPEOF(parts[0].value), parts[0].nrow, ncol, dimnames));
+        R_xlen_t nrow = (parts[0].nrow < 0) ? 1 : parts[0].nrow;
+        R_xlen_t offset = 0;
+        for (int kk = 0; kk < nmerged; kk++) {
+          R_affx_merge_copy(state, value, offset, nrow, parts[kk]);
+          offset += nrow*parts[kk].ncol;
+        }
+        SET_VECTOR_ELT(newGroup, ff, value);
+        UNPROTECT(1); /* 'value' */
+      }
+      SET_VECTOR_ELT(res, uu, newGroup);
+      UNPROTECT(1); /* 'newGroup' */
+    }
+    setAttrib(res, R_NamesSymbol, resNames);
+    UNPROTECT(2); /* 'resNames' and then 'res' */
+
+    return res;
+  }
+
+
+  /************************************************************************
+   *
+   * R_affx_merge_rownames()
+   *
+   * Gets the row names of rbind(A, B) of two matrices, where the row names
+   * are suffixed by "A" and "B", cf. cdfMergeAlleles().  A matrix without
+   * row names contributes a single one, so there is one per row only if
+   * R_affx_merge_has_rownames() says so; otherwise R gives an error.
+   *
+   ************************************************************************/
+  static SEXP R_affx_merge_names(const R_affx_merge_field& field)
+  {
+    return (field.dimnames == R_NilValue) ? R_NilValue : VECTOR_ELT(field.dimnames, 0);
+  }
+
+  static bool R_affx_merge_has_rownames(const R_affx_merge_field& fieldA,
+                                        const R_affx_merge_field& fieldB)
+  {
+    SEXP names1 = R_affx_merge_names(fieldA), names2 = R_affx_merge_names(fieldB);
+    int n1 = (names1 == R_NilValue) ? 1 : length(names1);
+    int n2 = (names2 == R_NilValue) ? 1 : length(names2);
+    return (n1 + n2 == fieldA.nrow + fieldB.nrow);
+  }
+
+  static SEXP R_affx_merge_rownames(R_affx_merge_state& state,
+                                    const R_affx_merge_field& fieldA,
+                                    const R_affx_merge_field& fieldB)
+  {
+    SEXP names1 = R_affx_merge_names(fieldA), names2 = R_affx_merge_names(fieldB);
+    int n1 = (names1 == R_NilValue) ? 1 : length(names1);
+    int n2 = (names2 == R_NilValue) ? 1 : length(names2);
+
+    /* Matrices of the same unit typically share their row names */
+    if (state.lastDimnames != R_NilValue &&
+        names1 == state.lastNames1 && names2 == state.lastNames2) {
+      return state.lastDimnames;
+    }
+
+    SEXP dimnames, rownames;
+    PROTECT(dimnames = allocVector(VECSXP, 2));
+    rownames = allocVector(STRSXP, n1 + n2);
+    SET_VECTOR_ELT(dimnames, 0, rownames);
+    for (int kk = 0; kk < n1 + n2; kk++) {
+      SEXP names = (kk < n1) ? names1 : names2;
+      int ii = (kk < n1) ? kk : kk - n1;
+      std::string name = (names == R_NilValue) ? "" :
+        (STRING_ELT(names, ii) == NA_STRING) ? "NA" : CHAR(STRING_ELT(names, ii));
+      name += (kk < n1) ? "A" : "B";
+      SET_STRING_ELT(rownames, kk, mkChar(name.c_str()));
+    }
+
+    state.lastNames1 = names1;
+    state.lastNames2 = names2;
+    state.lastDimnames = dimnames;
+    REPROTECT(dimnames, state.lastIndex);
+    UNPROTECT(1); /* 'dimnames' */
+
+    return dimnames;
+  }
+
+
+  /************************************************************************
+   *
+   * R_affx_merge_pairs()
+   *
+   * Merges allele A and allele B groups, pair by pair, into matrices,
+   * cf. cdfMergeAlleles() and cdfMergeToQuartets().  Returns R_NilValue
+   * if the unit has to be merged in R.
+   *
+   ************************************************************************/
+  static SEXP R_affx_merge_pairs(R_affx_merge_state& state, SEXP groups)
+  {
+    int nstrands = length(groups) / 2;
+    bool alleles = (state.mode == R_AFFX_MERGE_ALLELES);
+    SEXP names = getAttrib(groups, R_NamesSymbol);
+    if (nstrands < 1) return R_NilValue;
+    if (alleles && (nstrands > 2 || names == R_NilValue)) return R_NilValue;
+
+    /* Validate the fields before allocating anything */
+    std::vector<R_affx_merge_field> fields;
+    for (int kk = 0; kk < 2*nstrands; kk += 2) {
+      SEXP groupA = VECTOR_ELT(groups, kk), groupB = VECTOR_ELT(groups, kk+1);
+      if (TYPEOF(groupA) != VECSXP || TYPEOF(groupB) != VECSXP) return R_NilValue;
+      int nfields = length(groupA);
+      if (nfields == 0 || length(groupB) < nfields) return R_NilValue;
+      for (int ff = 0; ff < nfields; ff++) {
+        R_affx_merge_field fieldA, fieldB;
+        if (!R_affx_merge_shape(VECTOR_ELT(groupA, ff), fieldA) ||
+            !R_affx_merge_shape(VECTOR_ELT(groupB, ff), fieldB)) return R_NilValue;
+        if (TYPEOF(fieldA.value) != TYPEOF(fieldB.value)) return R_NilValue;
+        if ((fieldA.nrow < 0) != (fieldB.nrow < 0)) return R_NilValue;
+        if (fieldA.ncol != fieldB.ncol || fieldA.ncol == 0) return R_NilValue;
+        if (fieldA.nrow == 0 || fieldB.nrow == 0) return R_NilValue;
+        if (fieldA.nrow > 0 && !R_affx_merge_has_rownames(fieldA, fieldB)) return R_NilValue;
+        fields.push_back(fieldA);
+        fields.push_back(fieldB);
+      }
+    }
+
+    /* Merge */
+    SEXP res, resNames;
+    PROTECT(res = allocVector(VECSXP, nstrands));
+    PROTECT(resNames = allocVector(STRSXP, nstrands));
+    size_t nextField = 0;
+    for (int kk = 0; kk < nstrands; kk++) {
+      SEXP groupA = VECTOR_ELT(groups, 2*kk);
+      int nfields = length(groupA);
+      SEXP newGroup;
+      PROTECT(newGroup = allocVector(VECSXP, nfields));
+      for (int ff = 0; ff < nfields; ff++) {
+        const R_affx_merge_field& fieldA = fields[nextField++];
+        const R_affx_merge_field& fieldB = fields[nextField++];
+        int nrowA = (fieldA.nrow < 0) ? 1 : fieldA.nrow;
+        int nrowB = (fieldB.nrow < 0) ? 1 : fieldB.nrow;
+        SEXP dimnames = state.abNames;
+        if (fieldA.nrow >= 0) dimnames = R_affx_merge_rownames(state, fieldA, fieldB);
+
+        SEXP value;
+        PROTECT(value = R_affx_merge_alloc(TYPEOF(fieldA.value), nrowA + nrowB, fieldA.ncol, dimnames));
+        R_affx_merge_field partA = fieldA, partB = fieldB;
+        partA.nrow = nrowA;
+        partB.nrow = nrowB;
+        R_affx_merge_copy(state, value, 0, nrowA + nrowB, partA);
+        R_affx_merge_copy(state, value, nrowA, nrowA + nrowB, partB);
+        SET_VECTOR_ELT(newGroup, ff, value);
+        UNPROTECT(1); /* 'value' */
+      }
+      setAttrib(newGroup, R_NamesSymbol, getAttrib(groupA, R_NamesSymbol));
+      SET_VECTOR_ELT(res, kk, newGroup);
+      UNPROTECT(1); /* 'newGroup' */
+
+      /* Name the merged groups */
+      std::string name;
+      if (alleles) {
+        for (int ab = 0; ab < 2; ab++) {
+          SEXP groupName = STRING_ELT(names, 2*kk + ab);
+          const char* str = (groupName == NA_STRING) ? "NA" : CHAR(groupName);
+          if (kk == 1 && state.compReverseBases) {
+            str = (strcmp(str, "A") == 0) ? "T" : (strcmp(str, "C") == 0) ? "G" :
+                  (strcmp(str, "G") == 0) ? "C" : (strcmp(str, "T") == 0) ? "A" : "NA";
+          }
+          if (ab == 1) name += state.collapse;
+          name += str;
+        }
+      } else {
+        name = (kk % 2 == 0) ? "forward" : "reverse";
+      }
+      SET_STRING_ELT(resNames, kk, mkChar(name.c_str()));
+    }
+    setAttrib(res, R_NamesSymbol, resNames);
+    UNPROTECT(2); /* 'resNames' and then 'res' */
+
+    return res;
+  }
+
+
+  /************************************************************************
+   *
+   * R_affx_merge_run()
+   *
+   * Runs the copy jobs, which are in unit order, in chunks handed out to
+   * 'nbrOfWorkers' workers.
+   *
+   ************************************************************************/
+  static void R_affx_merge_run(const std::vector<R_affx_merge_job>& jobs, int nbrOfWorkers)
+  {
+    R_affx_work_queue queue((int) jobs.size(), 4096);
+    R_affx_run_workers(queue, nbrOfWorkers, [&](int) {
+      int start, stop;
+      while (queue.next(start, stop)) {
+        for (int ii = start; ii < stop; ii++) {
+          const R_affx_merge_job& job = jobs[ii];
+          for (int jj = 0; jj < job.ncol; jj++) {
+            memcpy(job.dst + jj*job.stride, job.src + jj*job.bytes, job.bytes);
+          }
+        }
+      }
+    });
+  }
+
+
+  /************************************************************************
+   *
+   * R_affx_cdf_merge_groups()
+   *
+   * Merges the groups of all units in a CDF list structure, where 'mode'
+   * is one of "strands", "alleles" and "quartets".  Returns a list with
+   * the updated CDF structure and the (one-based) indices of the units
+   * left for R to merge.
+   *
+   ************************************************************************/
+  SEXP R_affx_cdf_merge_groups(SEXP cdf, SEXP mode, SEXP compReverseBases,
+                               SEXP collapse, SEXP workers)
+  {
+    SEXP res = R_NilValue, names = R_NilValue, newCdf = R_NilValue,
+         fallback = R_NilValue, unit, groups, newGroups, newUnit, unitNames;
+    R_affx_merge_state state;
+
+    /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+     * Process arguments
+     * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+    const char* s_mode = CHAR(STRING_ELT(mode, 0));
+    if (strcmp(s_mode, "strands") == 0) {
+      state.mode = R_AFFX_MERGE_STRANDS;
+    } else if (strcmp(s_mode, "alleles") == 0) {
+      state.mode = R_AFFX_MERGE_ALLELES;
+    } else if (strcmp(s_mode, "quartets") == 0) {
+      state.mode = R_AFFX_MERGE_QUARTETS;
+    } else {
+      error("Argument 'mode' is unknown: %s", s_mode);
+    }
+    state.compReverseBases = LOGICAL(compReverseBases)[0];
+    state.collapse = CHAR(STRING_ELT(collapse, 0));
+    int i_workers = INTEGER(workers)[0];
+    if (i_workers < 1) i_workers = 1;
+    int nunits = length(cdf);
+
+    PROTECT(state.abNames = allocVector(VECSXP, 2));
+    SET_VECTOR_ELT(state.abNames, 0, allocVector(STRSXP, 2));
+    SET_STRING_ELT(VECTOR_ELT(state.abNames, 0), 0, mkChar("A"));
+    SET_STRING_ELT(VECTOR_ELT(state.abNames, 0), 1, mkChar("B"));
+    state.lastNames1 = state.lastNames2 = state.lastDimnames = R_NilValue;
+    PROTECT_WITH_INDEX(state.lastDimnames, &state.lastIndex);
+
+    /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+     * Merge the groups unit by unit
+     * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+    PROTECT(newCdf = shallow_duplicate(cdf));
+    for (int ii = 0; ii < nunits; ii++) {
+      unit = VECTOR_ELT(cdf, ii);
+      int groupsIdx = -1;
+      if (TYPEOF(unit) == VECSXP) {
+        unitNames = getAttrib(unit, R_NamesSymbol);
+        for (int kk = 0; kk < length(unitNames) && groupsIdx < 0; kk++) {
+          if (strcmp(CHAR(STRING_ELT(unitNames, kk)), "groups") == 0) groupsIdx = kk;
+        }
+      }
+      if (groupsIdx < 0 || TYPEOF(VECTOR_ELT(unit, groupsIdx)) != VECSXP) {
+        state.fallback.push_back(ii + 1);
+        continue;
+      }
+
+      groups = VECTOR_ELT(unit, groupsIdx);
+      if (state.mode == R_AFFX_MERGE_STRANDS) {
+        newGroups = R_affx_merge_strands(state, groups);
+      } else {
+        newGroups = R_affx_merge_pairs(state, groups);
+      }
+      if (newGroups == R_NilValue) {
+        state.fallback.push_back(ii + 1);
+        continue;
+      }
+      if (newGroups == groups) continue;
+
+      PROTECT(newGroups);
+      PROTECT(newUnit = shallow_duplicate(unit));
+      SET_VECTOR_ELT(newUnit, groupsIdx, newGroups);
+      SET_VECTOR_ELT(newCdf, ii, newUnit);
+      UNPROTECT(2); /* 'newUnit' and then 'newGroups' */
+    }
+
+    /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+     * Copy the numeric values
+     * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+    R_affx_merge_run(state.jobs, i_workers);
+
+    PROTECT(fallback = allocVector(INTSXP, state.fallback.size()));
+    if (!state.fallback.empty()) {
+      memcpy(INTEGER(fallback), &state.fallback[0], state.fallback.size()*sizeof(int));
+    }
+
+    PROTECT(res = NEW_LIST(2));
+    PROTECT(names = NEW_CHARACTER(2));
+    SET_VECTOR_ELT(res, 0, newCdf);
+    SET_STRING_ELT(names, 0, mkChar("cdf"));
+    SET_VECTOR_ELT(res, 1, fallback);
+    SET_STRING_ELT(names, 1, mkChar("fallback"));
+    setAttrib(res, R_NamesSymbol, names);
+    UNPROTECT(6);
+
+    return res;
+  } /* R_affx_cdf_merge_groups() */
+
+} /** end extern "C" **/
+
+/***************************************************************************
+ * HISTORY:
+ * 2026-10-19
+ * o Created.  Added R_affx_cdf_merge_groups(), which replaces the R code
+ *   of applyCdfGroups() for cdfMergeStrands(), cdfMergeAlleles() and
+ *   cdfMergeToQuartets().
+ **************************************************************************/
@@ -1,7 +1,15 @@
 #include "FusionCDFData.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
 #include "R_affx_constants.h"
 #include "R_affx_cdf_extras.h"
+#include "R_affx_thread_pool.h"
 
 using namespace std;
 using namespace affymetrix_fusion_io;
@@ -532,6 +540,128 @@ extern "C" {
   }  /* R_affx_get_cdf_file_header() */
 
 
+  /************************************************************************
+   *
+   * Decoding units in parallel
+   *
+   * R_affx_get_cdf_file() and R_affx_get_cdf_units() read the units in
+   * two phases.  First, the units are decoded from the file into plain
+   * columnar buffers, one per chunk of units.  The chunks are handed out
+   * to a pool of workers, each of which reads binary (XDA) CDF files
+   * through a reader of its own.  ASCII CDF files are parsed as a whole
+   * when opened, using the same number of threads.  Then the main thread
+   * turns the buffers into R objects, such that all R API calls are made
+   * by one thread.
+   *
+   ************************************************************************/
+  struct R_affx_cdf_units_buffer {
+    /* Units */
+    std::vector<std::string> unitNames;
+    std::vector<int> unitType, unitDirection, unitNumLists, unitNumCells,
+                     unitNumCellsPerList, unitNumber;
+    std::vector<int> unitGroups;  /* The first group of each unit, and the end */
+    /* Groups */
+    std::vector<std::string> groupNames;
+    std::vector<int> groupDirection, groupNumLists, groupNumCellsPerList;
+    std::vector<int> groupCells;  /* The first cell of each group, and the end */
+    /* Cells */
+    std::vector<int> x, y, expos, listIndex;
+    std::vector<char> pbase, tbase;
+  };
+
+  static const int R_affx_cdf_units_chunk_size = 1024;
+
+  static void R_affx_cdf_decode_units(FusionCDFData& cdf, const std::vector<int>& units,
+                                      int start, int stop, bool readCells,
+                                      R_affx_cdf_units_buffer& buffer)
+  {
+    FusionCDFProbeSetInformation unit;
+    FusionCDFProbeGroupInformation group;
+    FusionCDFProbeInformation probe;
+
+    for (int uu = start; uu < stop; uu++) {
+      cdf.GetProbeSetInformation(units[uu], unit);
+      buffer.unitNames.push_back(cdf.GetProbeSetName(units[uu]));
+      buffer.unitType.push_back(unit.GetProbeSetType());
+      buffer.unitDirection.push_back(unit.GetDirection());
+      buffer.unitNumLists.push_back(unit.GetNumLists());
+      buffer.unitNumCells.push_back(unit.GetNumCells());
+      buffer.unitNumCellsPerList.push_back(unit.GetNumCellsPerList());
+      buffer.unitNumber.push_back(unit.GetProbeSetNumber());
+      buffer.unitGroups.push_back((int) buffer.groupNames.size());
+
+      int ngroups = unit.GetNumGroups();
+      for (int gg = 0; gg < ngroups; gg++) {
+        unit.GetGroupInformation(gg, group);
+        buffer.groupNames.push_back(group.GetName());
+        buffer.groupDirection.push_back(group.GetDirection());
+        buffer.groupNumLists.push_back(group.GetNumLists());
+        buffer.groupNumCellsPerList.push_back(group.GetNumCellsPerList());
+        buffer.groupCells.push_back((int) buffer.x.size());
+        if (!readCells) continue;
+
+        int ncells = group.GetNumCells();
+        for (int cc = 0; cc < ncells; cc++) {
+          group.GetCell(cc, probe);
+          buffer.x.push_back(probe.GetX());
+          buffer.y.push_back(probe.GetY());
+          buffer.expos.push_back(probe.GetExpos());
+          buffer.listIndex.push_back(probe.GetListIndex());
+          buffer.pbase.push_back(probe.GetPBase());
+          buffer.tbase.push_back(probe.GetTBase());
+        }
+      }
+    }
+    buffer.unitGroups.push_back((int) buffer.groupNames.size());
+    buffer.groupCells.push_back((int) buffer.x.size());
+  }
+
+  /************************************************************************
+   *
+   * R_affx_cdf_decode_chunks()
+   *
+   * Decodes the units units[0], ..., units[nbrOfUnits-1] (zero-based)
+   * into one buffer per chunk of units.  No R API calls are made here.
+   * Text CDF files are parsed into memory as a whole, so they are decoded
+   * by a single reader.
+   *
+   ************************************************************************/
+  static void R_affx_cdf_decode_chunks(FusionCDFData& cdf, const char* fileName,
+                                       const std::vector<int>& units, bool readCells,
+                                       int nbrOfWorkers,
+                                       std::vector<R_affx_cdf_units_buffer>& chunks)
+  {
+    const int chunkSize = R_affx_cdf_units_chunk_size;
+    R_affx_work_queue queue((int) units.size(), chunkSize);
+
+    chunks.clear();
+    chunks.resize(queue.nbrOfChunks());
+
+    auto decode = [&](FusionCDFData& reader) {
+      int start, stop;
+      while (queue.next(start, stop)) {
+        R_affx_cdf_decode_units(reader, units, start, stop, readCells, chunks[start / chunkSize]);
+      }
+    };
+
+    if (!FusionCDFData::IsXDACompatibleFile(fileName)) nbrOfWorkers = 1;
+
+    /* The first worker uses the reader already opened */
+    R_affx_run_workers(queue, nbrOfWorkers, [&](int worker) {
+      if (worker == 0) {
+        decode(cdf);
+      } else {
+        FusionCDFData reader;
+        reader.SetFileName(fileName);
+        if (reader.Read() == false) {
+          throw std::runtime_error("Failed to read the CDF file.");
+        }
+        decode(reader);
+      }
+    });
+  }
+
+
   /************************************************************************
    *
    * R_affx_get_cdf_file()
@@ -550,12 +680,9 @@ extern "C" {
                              SEXP returnBases, SEXP returnAtoms,
                              SEXP returnIndexpos, SEXP returnIsPm,
                              SEXP returnBlockDirection,
-                             SEXP returnBlockAtomNumbers)
+                             SEXP returnBlockAtomNumbers, SEXP workers)
   {
     FusionCDFData cdf;
-    string str;
-    int str_length; 
-    char* cstr; 
     char p_base, t_base;
 
     SEXP
@@ -597,9 +724,11 @@ extern "C" {
     int i_returnIndexpos = INTEGER(returnIndexpos)[0];
     int i_returnBlockDirection = INTEGER(returnBlockDirection)[0];
     int i_returnBlockAtomNumbers = INTEGER(returnBlockAtomNumbers)[0];
+    int i_workers = INTEGER(workers)[0];
     bool readEveryUnit = true;
 
     cdf.SetFileName(cdfFileName);
+    cdf.SetNumThreads(i_workers);
     if (i_verboseFlag >= R_AFFX_VERBOSE) {
       Rprintf("Attempting to read CDF File: %s\n", cdf.GetFileName().c_str());
     }
@@ -623,19 +752,38 @@ extern "C" {
         readEveryUnit = true;
     }
 
+    /*
+    ** Decode the units in parallel, before any R objects are created
+    */
+    std::vector<int> unitIdxs(numUnits);
+    for (int i = 0; i < numUnits; i++) {
+        /* The index, which is 0-based in Fusion unlike our R-api */
+        unitIdxs[i] = readEveryUnit ? i : INTEGER(unitIndices)[i] - 1;
+    }
+    int i_returnCells = i_returnXY || i_returnIndices || i_returnBases ||
+        i_returnAtoms || i_returnIndexpos || i_returnIsPm;
+    std::vector<R_affx_cdf_units_buffer> chunks;
+    char msg[1024] = "";
+    try {
+        R_affx_cdf_decode_chunks(cdf, cdfFileName, unitIdxs, i_returnCells,
+                                 i_workers, chunks);
+    } catch(std::exception& ex) {
+        snprintf(msg, sizeof(msg), "%s", ex.what());
+    }
+    if (msg[0] != '\0') {
+        std::vector<R_affx_cdf_units_buffer>().swap(chunks);
+        error("%s", msg);
+    }
+
     /*
     ** Now we set up stuff for the different objects we need to return
     */
 
-    FusionCDFProbeSetInformation unit;
-    FusionCDFProbeGroupInformation block;
-    FusionCDFProbeInformation probe;
     int unitNumBlocks;
     int blockNumCells;
-    char *unitName;
+    const char *unitName;
     const char *blockName;
-    string pbaseString, tbaseString;
-    int ii, unit_idx, 
+    int ii, 
         unprotectBlockInfo, numBlockArguments, 
         numUnitArguments;
 
@@ -749,29 +897,26 @@ extern "C" {
       /* Check for interrupts */
       if(iunit % 1000 == 999) 
           R_CheckUserInterrupt();
-      /* The index, which is 0-based in Fusion unlike our R-api */
-      if(readEveryUnit)
-          unit_idx = iunit;
-      else
-          unit_idx = INTEGER(unitIndices)[iunit] - 1;
-      cdf.GetProbeSetInformation(unit_idx, unit);
+      /* The decoded unit; chunks are released once done with */
+      int iuu = iunit % R_affx_cdf_units_chunk_size;
+      int ichunk = iunit / R_affx_cdf_units_chunk_size;
+      if (iuu == 0 && ichunk > 0)
+          chunks[ichunk-1] = R_affx_cdf_units_buffer();
+      const R_affx_cdf_units_buffer& buffer = chunks[ichunk];
 
       PROTECT(r_unit = NEW_LIST(numUnitArguments));
-      str = cdf.GetProbeSetName(unit_idx);
-      str_length = str.size();
-      unitName = Calloc(str_length+1, char);
-      strncpy(unitName, str.c_str(), str_length);
-      unitName[str_length] = '\0';
+      unitName = buffer.unitNames[iuu].c_str();
       if (i_verboseFlag >= R_AFFX_VERBOSE) {
           Rprintf("Processing unit: %s\n", unitName);
       }
       /* There is no direct GetName method for a unit - strange */
-      unitNumBlocks = unit.GetNumGroups();
+      int firstBlock = buffer.unitGroups[iuu];
+      unitNumBlocks = buffer.unitGroups[iuu+1] - firstBlock;
       ii = 1; /* we always return the blocks */
 
 
       if(i_returnUnitType) {
-          switch (unit.GetProbeSetType()) {
+          switch (buffer.unitType[iuu]) {
           case affxcdf::UnknownProbeSetType:
               SET_VECTOR_ELT(r_unit, ii++, 
                              ScalarString(STRING_ELT(r_typeAsString, 0)));
@@ -812,7 +957,7 @@ extern "C" {
       }
 
       if(i_returnUnitDirection) {
-          switch (unit.GetDirection()) {
+          switch (buffer.unitDirection[iuu]) {
           case affxcdf::NoDirection:
               SET_VECTOR_ELT(r_unit, ii++, 
                              ScalarString(STRING_ELT(r_directionAsString, 0)));
@@ -834,16 +979,16 @@ extern "C" {
 
       if(i_returnUnitAtomNumbers) {
           SET_VECTOR_ELT(r_unit, ii++, 
-                         ScalarInteger(unit.GetNumLists()));
+                         ScalarInteger(buffer.unitNumLists[iuu]));
           SET_VECTOR_ELT(r_unit, ii++, 
-                         ScalarInteger(unit.GetNumCells()));
+                         ScalarInteger(buffer.unitNumCells[iuu]));
           SET_VECTOR_ELT(r_unit, ii++, 
-                         ScalarInteger(unit.GetNumCellsPerList()));
+                         ScalarInteger(buffer.unitNumCellsPerList[iuu]));
       }
 
       if(i_returnUnitNumber)
           SET_VECTOR_ELT(r_unit, ii++,
-                         ScalarInteger(unit.GetProbeSetNumber()));
+                         ScalarInteger(buffer.unitNumber[iuu]));
 
       PROTECT(r_blocks_list = NEW_LIST(unitNumBlocks));
       PROTECT(r_blocks_list_names = NEW_CHARACTER(unitNumBlocks));
@@ -853,10 +998,11 @@ extern "C" {
       */
 
       for (int iblock = 0; iblock < unitNumBlocks; iblock++) {
-        unit.GetGroupInformation(iblock, block);
+        int ig = firstBlock + iblock;
         PROTECT(r_block = NEW_LIST(numBlockArguments));
-        blockNumCells = block.GetNumCells();
-        blockName = block.GetName().c_str();
+        int firstCell = buffer.groupCells[ig];
+        blockNumCells = buffer.groupCells[ig+1] - firstCell;
+        blockName = buffer.groupNames[ig].c_str();
         if (i_verboseFlag >= R_AFFX_REALLY_VERBOSE) {
             Rprintf("Processing block %s\n", blockName);
         }
@@ -878,39 +1024,39 @@ extern "C" {
             PROTECT(r_ispm = NEW_LOGICAL(blockNumCells));
 
         for (int icell = 0; icell < blockNumCells; icell++) {
-          block.GetCell(icell, probe);
+          int kk = firstCell + icell;
           if (i_verboseFlag >= R_AFFX_REALLY_VERBOSE) {
             Rprintf("icell: %d x: %d, y: %d, pbase: %c, tbase: %c, expos: %d, indexpos: %d\n", 
-                    icell, probe.GetX(), probe.GetY(), probe.GetPBase(), 
-                    probe.GetTBase(), probe.GetExpos(), probe.GetListIndex());
+                    icell, buffer.x[kk], buffer.y[kk], buffer.pbase[kk], 
+                    buffer.tbase[kk], buffer.expos[kk], buffer.listIndex[kk]);
           }
 
           if(i_returnXY) {
-              INTEGER(r_xvals)[icell] = probe.GetX();
-              INTEGER(r_yvals)[icell] = probe.GetY();
+              INTEGER(r_xvals)[icell] = buffer.x[kk];
+              INTEGER(r_yvals)[icell] = buffer.y[kk];
           }
 
           if(i_returnIndices) {
-              INTEGER(r_indices)[icell] = probe.GetY() * numCols +
-                  probe.GetX() + 1;
+              INTEGER(r_indices)[icell] = buffer.y[kk] * numCols +
+                  buffer.x[kk] + 1;
           }
 
           if(i_returnBases) {
-              pbaseString = probe.GetPBase();
-              SET_STRING_ELT(r_pbase, icell, mkChar(pbaseString.c_str()));
-              tbaseString = probe.GetTBase();
-              SET_STRING_ELT(r_tbase, icell, mkChar(tbaseString.c_str()));
+              char base[2] = { buffer.pbase[kk], '\0' };
+              SET_STRING_ELT(r_pbase, icell, mkChar(base));
+              base[0] = buffer.tbase[kk];
+              SET_STRING_ELT(r_tbase, icell, mkChar(base));
           }
 
           if(i_returnAtoms)
-              INTEGER(r_expos)[icell] = probe.GetExpos();
+              INTEGER(r_expos)[icell] = buffer.expos[kk];
 
           if(i_returnIndexpos)
-              INTEGER(r_indexpos)[icell] = probe.GetListIndex();
+              INTEGER(r_indexpos)[icell] = buffer.listIndex[kk];
 
           if(i_returnIsPm) {
-              p_base = probe.GetPBase();
-              t_base = probe.GetTBase();
+              p_base = buffer.pbase[kk];
+              t_base = buffer.tbase[kk];
               LOGICAL(r_ispm)[icell] = R_affx_pt_base_is_pm(p_base, t_base);
           }
         }
@@ -947,7 +1093,7 @@ extern "C" {
             SET_VECTOR_ELT(r_block, ii++, r_ispm);
 
         if(i_returnBlockDirection) {
-          switch (block.GetDirection()) {
+          switch (buffer.groupDirection[ig]) {
           case affxcdf::NoDirection:
               SET_VECTOR_ELT(r_block, ii++, 
                              ScalarString(STRING_ELT(r_directionAsString, 0)));
@@ -969,22 +1115,16 @@ extern "C" {
         }
         if(i_returnBlockAtomNumbers) {
             SET_VECTOR_ELT(r_block, ii++,
-                           ScalarInteger(block.GetNumLists()));
+                           ScalarInteger(buffer.groupNumLists[ig]));
             SET_VECTOR_ELT(r_block, ii++, 
-                           ScalarInteger(block.GetNumCellsPerList()));
+                           ScalarInteger(buffer.groupNumCellsPerList[ig]));
         }
         setAttrib(r_block, R_NamesSymbol, r_block_names);
         UNPROTECT(unprotectBlockInfo);
 
         /** Put the block into the r_blocks_list and unprotect it **/
-        str = block.GetName();
-        str_length = str.size();
-        cstr = Calloc(str_length+1, char);
-        strncpy(cstr, str.c_str(), str_length);
-        cstr[str_length] = '\0';
         SET_VECTOR_ELT(r_blocks_list, iblock, r_block);
-        SET_STRING_ELT(r_blocks_list_names, iblock, mkChar(cstr));
-        Free(cstr);
+        SET_STRING_ELT(r_blocks_list_names, iblock, mkChar(blockName));
         UNPROTECT(1);
       }
 
@@ -1001,7 +1141,6 @@ extern "C" {
        ** and unprotect it. **/
       SET_VECTOR_ELT(r_units_list, iunit, r_unit);
       SET_STRING_ELT(r_units_list_names, iunit, mkChar(unitName));
-      Free(unitName);
       UNPROTECT(1);
     }
 
@@ -1259,12 +1398,9 @@ extern "C" {
    ************************************************************************/
   SEXP R_affx_get_cdf_units(SEXP fname, SEXP units, SEXP readXY, SEXP readBases, 
                             SEXP readExpos, SEXP readType, SEXP readDirection, 
-                            SEXP readIndices, SEXP verbose)
+                            SEXP readIndices, SEXP verbose, SEXP workers)
   {
     FusionCDFData cdf;
-    string str;
-    int str_length; 
-    char* cstr; 
 
     SEXP
       /* Returned list of units */
@@ -1310,6 +1446,7 @@ extern "C" {
     int i_readDirection = INTEGER(readDirection)[0];
     int i_readIndices   = INTEGER(readIndices)[0];
     int i_verboseFlag   = INTEGER(verbose)[0];
+    int i_workers       = INTEGER(workers)[0];
 
     int i_readGroups = i_readXY || i_readBases || i_readExpos || i_readIndices;
 
@@ -1327,6 +1464,7 @@ extern "C" {
      * Opens file
      * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
     cdf.SetFileName(cdfFileName);
+    cdf.SetNumThreads(i_workers);
     if (i_verboseFlag >= R_AFFX_VERBOSE) {
       Rprintf("Attempting to read CDF File: %s\n", cdf.GetFileName().c_str());
     }
@@ -1359,6 +1497,27 @@ extern "C" {
       ncol = header.GetCols();
     }
 
+    /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+     * Decode the units in parallel, before any R objects are created
+     * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+    std::vector<int> unitIdxs(nbrOfUnits);
+    for (int uu = 0; uu < nbrOfUnits; uu++) {
+      /* Unit indices are zero-based in Fusion SDK. */
+      unitIdxs[uu] = readAll ? uu : INTEGER(units)[uu] - 1;
+    }
+    std::vector<R_affx_cdf_units_buffer> chunks;
+    char msg[1024] = "";
+    try {
+      R_affx_cdf_decode_chunks(cdf, cdfFileName, unitIdxs, i_readGroups,
+                               i_workers, chunks);
+    } catch(std::exception& ex) {
+      snprintf(msg, sizeof(msg), "%s", ex.what());
+    }
+    if (msg[0] != '\0') {
+      std::vector<R_affx_cdf_units_buffer>().swap(chunks);
+      error("%s", msg);
+    }
+
     /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
      * Allocate 'resUnits' list
      * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
@@ -1428,13 +1587,17 @@ extern "C" {
     /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
      * For each unit
      * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-    FusionCDFProbeSetInformation probeset;
-
-
     for (int uu = 0; uu < nbrOfUnits; uu++) {
       /* Make it possible to interrupt */
       if(uu % 1000 == 999) R_CheckUserInterrupt();
 
+      /* The decoded unit; chunks are released once done with */
+      int iuu = uu % R_affx_cdf_units_chunk_size;
+      int ichunk = uu / R_affx_cdf_units_chunk_size;
+      if (iuu == 0 && ichunk > 0)
+        chunks[ichunk-1] = R_affx_cdf_units_buffer();
+      const R_affx_cdf_units_buffer& buffer = chunks[ichunk];
+
       if (i_verboseFlag >= R_AFFX_REALLY_VERBOSE) {
         Rprintf("Unit %d/%d...", uu+1, nbrOfUnits);
       } else if (i_verboseFlag >= R_AFFX_VERBOSE) {
@@ -1444,32 +1607,19 @@ extern "C" {
         }
       }
 
-      if (readAll) {
-        unitIdx = uu;
-      } else {
-        /* Unit indices are zero-based in Fusion SDK. */
-        unitIdx = INTEGER(units)[uu] - 1;
-      }
+      unitIdx = unitIdxs[uu];
 
       if (i_verboseFlag >= R_AFFX_REALLY_VERBOSE) {
         Rprintf("Unit: %d", unitIdx);
       }
 
-      cdf.GetProbeSetInformation(unitIdx, probeset);
-
       if (i_verboseFlag >= R_AFFX_REALLY_VERBOSE) {
         Rprintf(", ");
       }
       
       /* get the name */
-      str = cdf.GetProbeSetName(unitIdx);
-      str_length = str.size();
-      cstr = Calloc(str_length+1, char);
-      strncpy(cstr, str.c_str(), str_length);
-      cstr[str_length] = '\0';
       /** ...and add to list of unit names. **/
-			SET_STRING_ELT(unitNames, uu, mkChar(cstr));
-      Free(cstr);
+			SET_STRING_ELT(unitNames, uu, mkChar(buffer.unitNames[iuu].c_str()));
 
       
       PROTECT(r_probe_set = NEW_LIST(nbrOfUnitElements));
@@ -1478,7 +1628,7 @@ extern "C" {
       if (i_readType) {
         /* get the type */
         PROTECT(tmp = allocVector(INTSXP, 1));
-        INTEGER(tmp)[0] = probeset.GetProbeSetType();
+        INTEGER(tmp)[0] = buffer.unitType[iuu];
         SET_VECTOR_ELT(r_probe_set, rpsi++, tmp);
         UNPROTECT(1);
       }
@@ -1486,14 +1636,15 @@ extern "C" {
       if (i_readDirection) {
         /* get the direction */
         PROTECT(tmp = allocVector(INTSXP, 1));
-        INTEGER(tmp)[0] = probeset.GetDirection();
+        INTEGER(tmp)[0] = buffer.unitDirection[iuu];
         SET_VECTOR_ELT(r_probe_set, rpsi++, tmp);
         UNPROTECT(1);
       }
 
 
       if (i_readGroups) {
-        int ngroups = probeset.GetNumGroups();
+        int firstGroup = buffer.unitGroups[iuu];
+        int ngroups = buffer.unitGroups[iuu+1] - firstGroup;
      
         PROTECT(r_group_list = NEW_LIST(ngroups));
         PROTECT(r_group_names = NEW_CHARACTER(ngroups));
@@ -1508,10 +1659,9 @@ extern "C" {
             Rprintf("Group %d/%d...\n", igroup+1, ngroups);
           }
           */
-          FusionCDFProbeGroupInformation group;
-          probeset.GetGroupInformation(igroup, group);
-        
-          int ncells = group.GetNumCells();
+          int ig = firstGroup + igroup;
+          int firstCell = buffer.groupCells[ig];
+          int ncells = buffer.groupCells[ig+1] - firstCell;
         
           PROTECT(cell_list = NEW_LIST(nbrOfGroupElements));
 
@@ -1545,12 +1695,11 @@ extern "C" {
            * For each cell in the current group...
            * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
           for (int icell = 0; icell < ncells; icell++) {
-            FusionCDFProbeInformation probe;
-            group.GetCell(icell, probe);
+            int kk = firstCell + icell;
           
             if (i_readXY || i_readIndices) {
-              int x = probe.GetX();
-              int y = probe.GetY();
+              int x = buffer.x[kk];
+              int y = buffer.y[kk];
 
               if (i_readXY) {
                 INTEGER(xvals)[icell] = x;
@@ -1564,18 +1713,18 @@ extern "C" {
             }
 
             if (i_readBases) {
-              p_base[0] = probe.GetPBase();
-              t_base[0] = probe.GetTBase();
+              p_base[0] = buffer.pbase[kk];
+              t_base[0] = buffer.tbase[kk];
               SET_STRING_ELT(pbase, icell, mkChar(p_base));
               SET_STRING_ELT(tbase, icell, mkChar(t_base));
             }
             
             if (i_readExpos) {
-              INTEGER(expos)[icell] = probe.GetExpos();
+              INTEGER(expos)[icell] = buffer.expos[kk];
             }
 
             if (i_verboseFlag > R_AFFX_REALLY_VERBOSE) {
-              Rprintf("cell: %2d, (x,y)=(%4d,%4d), (pbase,tbase)=(%c,%c), expos: %2d\n", icell, probe.GetX(), probe.GetY(), probe.GetPBase(), probe.GetTBase(), probe.GetExpos());
+              Rprintf("cell: %2d, (x,y)=(%4d,%4d), (pbase,tbase)=(%c,%c), expos: %2d\n", icell, buffer.x[kk], buffer.y[kk], buffer.pbase[kk], buffer.tbase[kk], buffer.expos[kk]);
             }
           } /* for (int icell ...) */
 
@@ -1606,7 +1755,7 @@ extern "C" {
 
           if (i_readDirection) {
             PROTECT(tmp = allocVector(INTSXP, 1));
-            INTEGER(tmp)[0] = group.GetDirection();
+            INTEGER(tmp)[0] = buffer.groupDirection[ig];
             UNPROTECT(1);
             SET_VECTOR_ELT(cell_list, fieldIdx++, tmp);
           }
@@ -1620,13 +1769,7 @@ extern "C" {
 
           /** set these cells in the group list. **/
           SET_VECTOR_ELT(r_group_list, igroup, cell_list);
-          str = group.GetName();
-          str_length = str.size();
-          cstr = Calloc(str_length+1, char);
-          strncpy(cstr, str.c_str(), str_length);
-          cstr[str_length] = '\0';
-          SET_STRING_ELT(r_group_names, igroup, mkChar(cstr));
-          Free(cstr);
+          SET_STRING_ELT(r_group_names, igroup, mkChar(buffer.groupNames[ig].c_str()));
           UNPROTECT(1); /* 'cell_list' */
 
 					/*
@@ -1759,6 +1902,400 @@ extern "C" {
   }  /* R_affx_get_cdf_unit_names() */
 
 
+  /************************************************************************
+   *
+   * R_affx_get_cdf_unit_indices()
+   *
+   * Maps unit names to one-based unit indices, NA for names not in the
+   * file.  The names are looked up in a hash index of the unit names of
+   * the file.  The index is kept after the call, so it is only built
+   * again if the file is modified.
+   *
+   ************************************************************************/
+  SEXP R_affx_get_cdf_unit_indices(SEXP fname, SEXP names, SEXP verbose)
+  {
+    FusionCDFData cdf;
+    SEXP indices = R_NilValue;
+
+    const char* cdfFileName = CHAR(STRING_ELT(fname, 0));
+    int i_verboseFlag = INTEGER(verbose)[0];
+
+    cdf.SetFileName(cdfFileName);
+    if (i_verboseFlag >= R_AFFX_VERBOSE) {
+      Rprintf("Attempting to read CDF File: %s\n", cdf.GetFileName().c_str());
+    }
+
+    affymetrix_calvin_io::ProbeSetNameIndex *index = cdf.GetProbeSetNameIndex();
+    if (index == NULL) {
+      error("Failed to read the CDF file.");
+    }
+
+    int nbrOfNames = length(names);
+    PROTECT(indices = NEW_INTEGER(nbrOfNames));
+    int *ptr = INTEGER(indices);
+    for (int ii = 0; ii < nbrOfNames; ii++) {
+      SEXP name = STRING_ELT(names, ii);
+      if (name == NA_STRING) {
+        ptr[ii] = NA_INTEGER;
+        continue;
+      }
+      const char *cname = CHAR(name);
+      int unitIdx = index->Find(cname, strlen(cname));
+      /* Unit indices are zero-based in Fusion SDK. */
+      ptr[ii] = (unitIdx < 0) ? NA_INTEGER : unitIdx + 1;
+    }
+
+    UNPROTECT(1); /* 'indices' */
+
+    return indices;
+  }  /* R_affx_get_cdf_unit_indices() */
+
+
+  /************************************************************************
+   *
+   * R_affx_get_cdf_data_frame()
+   *
+   * Reads (a subset of) the cells of the units in a CDF file as flat
+   * columns, one row per cell, which is what readCdfDataFrame() returns.
+   * The file is walked twice; first to count the cells, and then to
+   * write each column value directly into its row.  Unit and group
+   * fields are repeated for all of their cells.  Strings that repeat,
+   * that is, unit types and directions, group names, and bases, are
+   * created once and shared by all rows.
+   *
+   * Argument 'fields' gives the columns to return; see
+   * readCdfDataFrame() for the names.  Arguments 'groups' and 'cells'
+   * are one-based indices of the groups in each unit and the cells in
+   * each group to read; NULL for all.
+   *
+   ************************************************************************/
+  enum R_affx_cdf_column_field {
+    R_AFFX_COLUMN_UNIT, R_AFFX_COLUMN_UNIT_NAME, R_AFFX_COLUMN_UNIT_TYPE,
+    R_AFFX_COLUMN_UNIT_DIRECTION, R_AFFX_COLUMN_UNIT_NATOMS,
+    R_AFFX_COLUMN_UNIT_NCELLS, R_AFFX_COLUMN_UNIT_NCELLSPERATOM,
+    R_AFFX_COLUMN_UNIT_NUMBER,
+    R_AFFX_COLUMN_GROUP, R_AFFX_COLUMN_GROUP_NAME,
+    R_AFFX_COLUMN_GROUP_DIRECTION, R_AFFX_COLUMN_GROUP_NATOMS,
+    R_AFFX_COLUMN_GROUP_NCELLSPERATOM,
+    R_AFFX_COLUMN_CELL, R_AFFX_COLUMN_X, R_AFFX_COLUMN_Y,
+    R_AFFX_COLUMN_PBASE, R_AFFX_COLUMN_TBASE, R_AFFX_COLUMN_ATOM,
+    R_AFFX_COLUMN_INDEXPOS,
+    R_AFFX_COLUMN_GROUP_FIELDS = R_AFFX_COLUMN_GROUP,
+    R_AFFX_COLUMN_CELL_FIELDS = R_AFFX_COLUMN_CELL
+  };
+
+  /* The column names as readCdfDataFrame() has always named them, which
+     is why the number of cells per atom of a group is named
+     'unitNbrOfCellsPerAtom' */
+  static const char* R_affx_cdf_column_names[] = {
+    "unit", "unitName", "unitType", "unitDirection", "unitNbrOfAtoms",
+    "unitNbrOfCells", "unitNbrOfCellsperatom", "unitNumber",
+    "group", "groupName", "groupDirection", "groupNbrOfAtoms",
+    "unitNbrOfCellsPerAtom",
+    "cell", "x", "y", "pbase", "tbase", "atom", "indexPos",
+    NULL
+  };
+
+  static const char* R_affx_cdf_unit_types[] = {
+    "unknown", "expression", "genotyping", "resequencing", "tag",
+    "copynumber", "genotypingcontrol", "expressioncontrol"
+  };
+
+  static const char* R_affx_cdf_directions[] = {
+    "nodirection", "sense", "antisense", "unknown"
+  };
+
+  SEXP R_affx_get_cdf_data_frame(SEXP fname, SEXP units, SEXP groups,
+                                 SEXP cells, SEXP fields, SEXP verbose)
+  {
+    SEXP res = R_NilValue, names = R_NilValue, column = R_NilValue,
+         unitTypes = R_NilValue, directions = R_NilValue, value;
+    char msg[1024] = "";
+
+    /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+     * Process arguments
+     * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+    const char* cdfFileName = CHAR(STRING_ELT(fname, 0));
+    int i_verboseFlag = INTEGER(verbose)[0];
+    int nbrOfFields = length(fields);
+    std::vector<int> columnFields(nbrOfFields);
+    bool readGroups = false, readCells = false;
+    for (int ff = 0; ff < nbrOfFields; ff++) {
+      const char* field = CHAR(STRING_ELT(fields, ff));
+      int kk = 0;
+      while (R_affx_cdf_column_names[kk] != NULL &&
+             strcmp(field, R_affx_cdf_column_names[kk]) != 0) kk++;
+      if (R_affx_cdf_column_names[kk] == NULL) {
+        error("Argument 'fields' contains an unknown field: %s", field);
+      }
+      columnFields[ff] = kk;
+      readGroups = readGroups || (kk >= R_AFFX_COLUMN_GROUP_FIELDS);
+      readCells = readCells || (kk >= R_AFFX_COLUMN_CELL_FIELDS);
+    }
+
+    /* The selected groups and cells, or everything if empty */
+    int nbrOfGroupIdxs = length(groups);
+    std::vector<bool> keepCell;
+    for (int ii = 0; ii < length(cells); ii++) {
+      int cell = INTEGER(cells)[ii];
+      if (cell == NA_INTEGER || cell < 1) continue;
+      if ((int) keepCell.size() < cell) keepCell.resize(cell, false);
+      keepCell[cell-1] = true;
+    }
+    bool allCells = (length(cells) == 0);
+
+    PROTECT(unitTypes = NEW_CHARACTER(8));
+    for (int ii = 0; ii < 8; ii++) {
+      SET_STRING_ELT(unitTypes, ii, mkChar(R_affx_cdf_unit_types[ii]));
+    }
+    PROTECT(directions = NEW_CHARACTER(4));
+    for (int ii = 0; ii < 4; ii++) {
+      SET_STRING_ELT(directions, ii, mkChar(R_affx_cdf_directions[ii]));
+    }
+    PROTECT(res = NEW_LIST(nbrOfFields));
+
+    try {
+      FusionCDFData cdf;
+      FusionCDFProbeSetInformation unit;
+      FusionCDFProbeGroupInformation group;
+      FusionCDFProbeInformation probe;
+
+      /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+       * Opens file
+       * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+      cdf.SetFileName(cdfFileName);
+      if (i_verboseFlag >= R_AFFX_VERBOSE) {
+        Rprintf("Attempting to read CDF File: %s\n", cdf.GetFileName().c_str());
+      }
+      if (cdf.Read() == false) {
+        throw std::runtime_error("Failed to read the CDF file.");
+      }
+
+      int numUnitsInFile = cdf.GetHeader().GetNumProbeSets();
+      int numCols = cdf.GetHeader().GetCols();
+      bool readEveryUnit = (length(units) == 0);
+      int numUnits = readEveryUnit ? numUnitsInFile : length(units);
+      for (int uu = 0; uu < numUnits && !readEveryUnit; uu++) {
+        int unitIdx = INTEGER(units)[uu];
+        if (unitIdx < 1 || unitIdx > numUnitsInFile) {
+          snprintf(msg, sizeof(msg), "Argument 'units' contains an element out of range [%d,%d]: %d", 1, numUnitsInFile, unitIdx);
+          throw std::runtime_error(msg);
+        }
+      }
+
+      /* The groups of a unit to read, in the order they are read */
+      std::vector<int> unitGroups;
+      auto selectGroups = [&](int unitIdx, int numGroups) {
+        unitGroups.clear();
+        for (int gg = 0; gg < numGroups; gg++) {
+          bool keep = (nbrOfGroupIdxs == 0);
+          for (int kk = 0; kk < nbrOfGroupIdxs && !keep; kk++) {
+            keep = (INTEGER(groups)[kk] == gg+1);
+          }
+          if (keep) unitGroups.push_back(gg);
+        }
+        if (nbrOfGroupIdxs > (int) unitGroups.size()) {
+          snprintf(msg, sizeof(msg), "Argument 'groups' contains an element out of range for unit %d, which has %d groups.", unitIdx+1, numGroups);
+          throw std::runtime_error(msg);
+        }
+      };
+      auto groupCells = [&](int numCells) {
+        if (allCells) return numCells;
+        int count = 0;
+        for (int cc = 0; cc < numCells && cc < (int) keepCell.size(); cc++) count += keepCell[cc];
+        return count;
+      };
+
+      /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+       * Count the cells
+       * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+      R_xlen_t nbrOfRows = 0;
+      for (int uu = 0; uu < numUnits; uu++) {
+        if (uu % 1000 == 999) R_CheckUserInterrupt();
+        int unitIdx = readEveryUnit ? uu : INTEGER(units)[uu] - 1;
+        cdf.GetProbeSetInformation(unitIdx, unit);
+        selectGroups(unitIdx, unit.GetNumGroups());
+        for (size_t gg = 0; gg < unitGroups.size(); gg++) {
+          unit.GetGroupInformation(unitGroups[gg], group);
+          nbrOfRows += groupCells(group.GetNumCells());
+        }
+      }
+      if (i_verboseFlag >= R_AFFX_VERBOSE) {
+        Rprintf("Reading %ld cells of %d units\n", (long) nbrOfRows, numUnits);
+      }
+
+      for (int ff = 0; ff < nbrOfFields; ff++) {
+        int kk = columnFields[ff];
+        bool isString = (kk == R_AFFX_COLUMN_UNIT_NAME || kk == R_AFFX_COLUMN_UNIT_TYPE ||
+                         kk == R_AFFX_COLUMN_UNIT_DIRECTION || kk == R_AFFX_COLUMN_GROUP_NAME ||
+                         kk == R_AFFX_COLUMN_GROUP_DIRECTION || kk == R_AFFX_COLUMN_PBASE ||
+                         kk == R_AFFX_COLUMN_TBASE);
+        SET_VECTOR_ELT(res, ff, allocVector(isString ? STRSXP : INTSXP, nbrOfRows));
+      }
+
+      /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+       * Fill in the columns, unit by unit
+       * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+      std::map<std::string, SEXP> groupNames;
+      SEXP bases[256];
+      for (int ii = 0; ii < 256; ii++) bases[ii] = NULL;
+
+      R_xlen_t row = 0;
+      for (int uu = 0; uu < numUnits; uu++) {
+        if (uu % 1000 == 999) R_CheckUserInterrupt();
+        int unitIdx = readEveryUnit ? uu : INTEGER(units)[uu] - 1;
+        cdf.GetProbeSetInformation(unitIdx, unit);
+        selectGroups(unitIdx, unit.GetNumGroups());
+
+        SEXP unitName = R_NilValue;
+        R_xlen_t unitRow = row;
+        for (size_t gg = 0; gg < unitGroups.size(); gg++) {
+          unit.GetGroupInformation(unitGroups[gg], group);
+          int numCells = group.GetNumCells();
+          R_xlen_t groupRow = row;
+
+          /* Cell fields */
+          for (int cc = 0; cc < numCells; cc++) {
+            if (!allCells && (cc >= (int) keepCell.size() || !keepCell[cc])) continue;
+            if (readCells) group.GetCell(cc, probe);
+            for (int ff = 0; ff < nbrOfFields; ff++) {
+              column = VECTOR_ELT(res, ff);
+              switch (columnFields[ff]) {
+                case R_AFFX_COLUMN_CELL:
+                  INTEGER(column)[row] = probe.GetY() * numCols + probe.GetX() + 1;
+                  break;
+                case R_AFFX_COLUMN_X:
+                  INTEGER(column)[row] = probe.GetX();
+                  break;
+                case R_AFFX_COLUMN_Y:
+                  INTEGER(column)[row] = probe.GetY();
+                  break;
+                case R_AFFX_COLUMN_PBASE:
+                case R_AFFX_COLUMN_TBASE: {
+                  unsigned char base = (columnFields[ff] == R_AFFX_COLUMN_PBASE) ?
+                                        probe.GetPBase() : probe.GetTBase();
+                  if (bases[base] == NULL) {
+                    char str[2] = { (char) base, '\0' };
+                    bases[base] = mkChar(str);
+                  }
+                  SET_STRING_ELT(column, row, bases[base]);
+                  break;
+                }
+                case R_AFFX_COLUMN_ATOM:
+                  INTEGER(column)[row] = probe.GetExpos();
+                  break;
+                case R_AFFX_COLUMN_INDEXPOS:
+                  INTEGER(column)[row] = probe.GetListIndex();
+                  break;
+              }
+            }
+            row++;
+          }
+
+          /* Group fields; the interned strings are kept alive by the
+             columns, so they are only created for groups with cells */
+          for (int ff = 0; ff < nbrOfFields && readGroups && groupRow < row; ff++) {
+            int kk = columnFields[ff];
+            if (kk < R_AFFX_COLUMN_GROUP_FIELDS || kk >= R_AFFX_COLUMN_CELL_FIELDS) continue;
+            column = VECTOR_ELT(res, ff);
+            if (kk == R_AFFX_COLUMN_GROUP_NAME || kk == R_AFFX_COLUMN_GROUP_DIRECTION) {
+              if (kk == R_AFFX_COLUMN_GROUP_NAME) {
+                std::string name = group.GetName();
+                std::map<std::string, SEXP>::iterator it = groupNames.find(name);
+                if (it == groupNames.end()) {
+                  it = groupNames.insert(std::make_pair(name, mkChar(name.c_str()))).first;
+                }
+                value = it->second;
+              } else {
+                int direction = group.GetDirection();
+                value = STRING_ELT(directions, (direction >= 0 && direction < 3) ? direction : 3);
+              }
+              for (R_xlen_t ii = groupRow; ii < row; ii++) SET_STRING_ELT(column, ii, value);
+              continue;
+            }
+            int ivalue = 0;
+            switch (kk) {
+              case R_AFFX_COLUMN_GROUP:
+                ivalue = (nbrOfGroupIdxs == 0) ? unitGroups[gg] + 1 : INTEGER(groups)[gg];
+                break;
+              case R_AFFX_COLUMN_GROUP_NATOMS:
+                ivalue = group.GetNumLists();
+                break;
+              case R_AFFX_COLUMN_GROUP_NCELLSPERATOM:
+                ivalue = group.GetNumCellsPerList();
+                break;
+            }
+            for (R_xlen_t ii = groupRow; ii < row; ii++) INTEGER(column)[ii] = ivalue;
+          }
+        }
+
+        /* Unit fields */
+        for (int ff = 0; ff < nbrOfFields && unitRow < row; ff++) {
+          int kk = columnFields[ff];
+          if (kk >= R_AFFX_COLUMN_GROUP_FIELDS) continue;
+          column = VECTOR_ELT(res, ff);
+          if (kk == R_AFFX_COLUMN_UNIT_NAME || kk == R_AFFX_COLUMN_UNIT_TYPE ||
+              kk == R_AFFX_COLUMN_UNIT_DIRECTION) {
+            if (kk == R_AFFX_COLUMN_UNIT_NAME) {
+              if (unitName == R_NilValue) {
+                unitName = mkChar(cdf.GetProbeSetName(unitIdx).c_str());
+              }
+              value = unitName;
+            } else if (kk == R_AFFX_COLUMN_UNIT_TYPE) {
+              int type = unit.GetProbeSetType();
+              value = STRING_ELT(unitTypes, (type >= 0 && type < 8) ? type : 0);
+            } else {
+              int direction = unit.GetDirection();
+              value = STRING_ELT(directions, (direction >= 0 && direction < 3) ? direction : 3);
+            }
+            for (R_xlen_t ii = unitRow; ii < row; ii++) SET_STRING_ELT(column, ii, value);
+            continue;
+          }
+          int ivalue = 0;
+          switch (kk) {
+            case R_AFFX_COLUMN_UNIT:
+              ivalue = unitIdx + 1;
+              break;
+            case R_AFFX_COLUMN_UNIT_NATOMS:
+              ivalue = unit.GetNumLists();
+              break;
+            case R_AFFX_COLUMN_UNIT_NCELLS:
+              ivalue = unit.GetNumCells();
+              break;
+            case R_AFFX_COLUMN_UNIT_NCELLSPERATOM:
+              ivalue = unit.GetNumCellsPerList();
+              break;
+            case R_AFFX_COLUMN_UNIT_NUMBER:
+              ivalue = unit.GetProbeSetNumber();
+              break;
+          }
+          for (R_xlen_t ii = unitRow; ii < row; ii++) INTEGER(column)[ii] = ivalue;
+        }
+      }
+    } catch(std::exception& ex) {
+      snprintf(msg, sizeof(msg), "%s", ex.what());
+    } catch(...) {
+      snprintf(msg, sizeof(msg), "[affxparser Fusion SDK exception] Failed to read CDF file: %s", cdfFileName);
+    }
+
+    /* Signal errors only when all C++ objects are gone */
+    if (msg[0] != '\0') {
+      UNPROTECT(3);
+      error("%s", msg);
+    }
+
+    PROTECT(names = NEW_CHARACTER(nbrOfFields));
+    for (int ff = 0; ff < nbrOfFields; ff++) {
+      SET_STRING_ELT(names, ff, STRING_ELT(fields, ff));
+    }
+    setAttrib(res, R_NamesSymbol, names);
+    UNPROTECT(4);
+
+    return res;
+  } /* R_affx_get_cdf_data_frame() */
+
+
+
 
 
 } /** end extern C **/
@@ -1766,6 +2303,16 @@ extern "C" {
 
 /***************************************************************************
  * HISTORY:
+ * 2026-10-19
+ * o Added R_affx_get_cdf_unit_indices(), which looks up unit names in
+ *   a hash index kept for the file.
+ * o R_affx_get_cdf_file() and R_affx_get_cdf_units() parse ASCII CDF
+ *   files using 'workers' threads.
+ * o R_affx_get_cdf_file() and R_affx_get_cdf_units() gained argument
+ *   'workers'.  They now decode the units by a pool of threads into
+ *   native buffers before building the R objects.
+ * o Added R_affx_get_cdf_data_frame(), which replaces the R code of
+ *   readCdfDataFrame().
  * 2014-10-28
  * o BUG FIX: Argument 'unitIndices' to R_affx_get_cdf_file_qc()  and
      R_affx_get_cdf_file() could contain elements out of range [1,J].
@@ -0,0 +1,460 @@
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "R_affx_constants.h"
+#include "R_affx_file_buffer.h"
+
+using namespace std;
+
+#include <R.h>
+#include <Rdefines.h>
+
+extern "C" {
+  /************************************************************************
+   *
+   * Binary XDA CDF layout
+   *
+   * Header (24 bytes + the reference sequence), unit names (64 bytes each),
+   * file offsets of the QC units and of the units (4 bytes each), then the
+   * QC units followed by the units.  All values are little endian.
+   *
+   *  QC unit: type (2), ncells (4) and per cell x, y (2+2), length, pm,
+   *           background (1+1+1) = 6 + 7*ncells bytes.
+   *  Unit:    unittype (2), direction (1), natoms, ngroups, ncells,
+   *           unitnumber (4*4), ncellsperatom (1) = 20 bytes, and then
+   *           per group natoms, ncells (4+4), ncellsperatom, direction
+   *           (1+1), start, stop (4+4), name (64) = 82 bytes, and
+   *           per cell indexpos (4), x, y (2+2), atom (4), pbase, tbase
+   *           (1+1) = 14 bytes.
+   *
+   ************************************************************************/
+  enum {
+    R_AFFX_CDF_HEADER_BYTES = 24,
+    R_AFFX_CDF_NAME_BYTES = 64,
+    R_AFFX_CDF_QCUNIT_BYTES = 6,
+    R_AFFX_CDF_QCCELL_BYTES = 7,
+    R_AFFX_CDF_UNIT_BYTES = 20,
+    R_AFFX_CDF_GROUP_BYTES = 18 + R_AFFX_CDF_NAME_BYTES,
+    R_AFFX_CDF_CELL_BYTES = 14
+  };
+
+  static const char* R_affx_cdf_unit_types[] = {
+    "unknown", "expression", "genotyping", "resequencing", "tag",
+    "copynumber", "genotypingcontrol", "expressioncontrol", NULL
+  };
+
+  static const char* R_affx_cdf_directions[] = {
+    "nodirection", "sense", "antisense", "unknown", NULL
+  };
+
+  static const char* R_affx_cdf_qc_types[] = {
+    "unknown",
+    "checkerboardNegative", "checkerboardPositive",
+    "hybeNegative", "hybePositive",
+    "textFeaturesNegative", "textFeaturesPositive",
+    "centralNegative", "centralPositive",
+    "geneExpNegative", "geneExpPositive",
+    "cycleFidelityNegative", "cycleFidelityPositive",
+    "centralCrossNegative", "centralCrossPositive",
+    "crossHybeNegative", "crossHybePositive",
+    "SpatialNormNegative", "SpatialNormPositive", NULL
+  };
+
+
+  static void R_affx_cdf_put_name(char* dest, const char* name, size_t maxLen)
+  {
+    size_t len = (name == NULL) ? 0 : strlen(name);
+    if (len > maxLen) len = maxLen;
+    memset(dest, 0, R_AFFX_CDF_NAME_BYTES);
+    if (len > 0) memcpy(dest, name, len);
+  }
+
+
+  /************************************************************************
+   *
+   * Accessing the elements of the CDF structures
+   *
+   ************************************************************************/
+  static SEXP R_affx_cdf_element(SEXP list, const char* name)
+  {
+    SEXP names = getAttrib(list, R_NamesSymbol);
+    if (TYPEOF(list) != VECSXP || names == R_NilValue) return R_NilValue;
+    for (int ii = 0; ii < LENGTH(list); ii++) {
+      if (strcmp(CHAR(STRING_ELT(names, ii)), name) == 0) {
+        return VECTOR_ELT(list, ii);
+      }
+    }
+    return R_NilValue;
+  }
+
+  static SEXP R_affx_cdf_field(SEXP list, const char* name, const char* what, int index)
+  {
+    SEXP value = R_affx_cdf_element(list, name);
+    if (value == R_NilValue) {
+      char msg[1024];
+      snprintf(msg, sizeof(msg), "Field '%s' of %s #%d is missing.", name, what, index+1);
+      throw std::runtime_error(msg);
+    }
+    return value;
+  }
+
+  /* The ii:th value of an integer, numeric or logical vector, NA as INT_MIN */
+  static inline int R_affx_cdf_int(SEXP values, R_xlen_t ii)
+  {
+    if (TYPEOF(values) == REALSXP) {
+      double value = REAL(values)[ii];
+      return ISNAN(value) ? NA_INTEGER : (int) value;
+    }
+    if (TYPEOF(values) == INTSXP || TYPEOF(values) == LGLSXP) {
+      return INTEGER(values)[ii];
+    }
+    throw std::runtime_error("Expected a numeric CDF field.");
+  }
+
+  static int R_affx_cdf_scalar(SEXP list, const char* name, const char* what, int index)
+  {
+    SEXP value = R_affx_cdf_field(list, name, what, index);
+    if (XLENGTH(value) < 1) {
+      char msg[1024];
+      snprintf(msg, sizeof(msg), "Field '%s' of %s #%d is empty.", name, what, index+1);
+      throw std::runtime_error(msg);
+    }
+    return R_affx_cdf_int(value, 0);
+  }
+
+  /* As R_affx_cdf_scalar(), but with a default for a missing field */
+  static int R_affx_cdf_scalar_or(SEXP list, const char* name, int value)
+  {
+    SEXP field = R_affx_cdf_element(list, name);
+    if (field == R_NilValue || XLENGTH(field) < 1 || TYPEOF(field) == STRSXP) return value;
+    return R_affx_cdf_int(field, 0);
+  }
+
+  /* A code given either as is or as one of the labels of a table */
+  static int R_affx_cdf_code(SEXP list, const char* name, const char** labels,
+                             const char* what, int index)
+  {
+    SEXP value = R_affx_cdf_field(list, name, what, index);
+    if (TYPEOF(value) != STRSXP) {
+      return R_affx_cdf_scalar(list, name, what, index);
+    }
+    const char* label = (LENGTH(value) > 0) ? CHAR(STRING_ELT(value, 0)) : "";
+    for (int ll = 0; labels[ll] != NULL; ll++) {
+      if (strcmp(label, labels[ll]) == 0) return ll;
+    }
+    char msg[1024];
+    snprintf(msg, sizeof(msg), "Unknown value of field '%s' of %s #%d: %s", name, what, index+1, label);
+    throw std::runtime_error(msg);
+  }
+
+  static SEXP R_affx_cdf_cell_field(SEXP group, const char* name, R_xlen_t ncells,
+                                    int unit, int index)
+  {
+    SEXP value = R_affx_cdf_field(group, name, "group", index);
+    if (XLENGTH(value) != ncells) {
+      char msg[1024];
+      snprintf(msg, sizeof(msg), "Field '%s' of group #%d in unit #%d has %ld values, not %ld.",
+               name, index+1, unit+1, (long) XLENGTH(value), (long) ncells);
+      throw std::runtime_error(msg);
+    }
+    if (TYPEOF(value) != INTSXP && TYPEOF(value) != REALSXP && TYPEOF(value) != STRSXP) {
+      char msg[1024];
+      snprintf(msg, sizeof(msg), "Field '%s' of group #%d in unit #%d is of the wrong type.",
+               name, index+1, unit+1);
+      throw std::runtime_error(msg);
+    }
+    return value;
+  }
+
+  /* The number of cells of a group is the number of x coordinates */
+  static R_xlen_t R_affx_cdf_group_ncells(SEXP group, int unit, int index)
+  {
+    if (TYPEOF(group) != VECSXP) {
+      char msg[1024];
+      snprintf(msg, sizeof(msg), "Group #%d of unit #%d is not a list.", index+1, unit+1);
+      throw std::runtime_error(msg);
+    }
+    return XLENGTH(R_affx_cdf_field(group, "x", "group", index));
+  }
+
+
+  /************************************************************************
+   *
+   * R_affx_write_cdf_units()
+   *
+   * Writes the whole CDF file.  The sizes of all (QC) units, and hence
+   * their file offsets, are calculated in a first pass over the
+   * structures, whereafter the file is written sequentially through a
+   * large buffer.
+   *
+   ************************************************************************/
+  static void R_affx_write_cdf_units(FILE* file, SEXP cdfheader, SEXP cdf, SEXP cdfqc,
+                                     int bufferSize, int verbose)
+  {
+    char msg[1024];
+    int nbrOfUnits = LENGTH(cdf);
+    int nbrOfQcUnits = LENGTH(cdfqc);
+
+    /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+     * The file offsets of all QC units and units
+     * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+    SEXP refseq = R_affx_cdf_element(cdfheader, "refseq");
+    const char* refSeq = (TYPEOF(refseq) == STRSXP && LENGTH(refseq) > 0 &&
+                          STRING_ELT(refseq, 0) != NA_STRING) ? CHAR(STRING_ELT(refseq, 0)) : "";
+    size_t refSeqLen = strlen(refSeq);
+
+    double offset = R_AFFX_CDF_HEADER_BYTES + (double) refSeqLen +
+                    (double) R_AFFX_CDF_NAME_BYTES * nbrOfUnits +
+                    4.0 * nbrOfQcUnits + 4.0 * nbrOfUnits;
+
+    std::vector<int> qcOffsets(nbrOfQcUnits);
+    for (int qq = 0; qq < nbrOfQcUnits; qq++) {
+      qcOffsets[qq] = (int) offset;
+      SEXP qcunit = VECTOR_ELT(cdfqc, qq);
+      if (TYPEOF(qcunit) != VECSXP) {
+        snprintf(msg, sizeof(msg), "QC unit #%d is not a list.", qq+1);
+        throw std::runtime_error(msg);
+      }
+      R_xlen_t ncells = XLENGTH(R_affx_cdf_field(qcunit, "x", "QC unit", qq));
+      offset += R_AFFX_CDF_QCUNIT_BYTES + (double) R_AFFX_CDF_QCCELL_BYTES * ncells;
+      if (offset > INT_MAX) break;
+    }
+
+    std::vector<int> unitOffsets(nbrOfUnits);
+    for (int uu = 0; uu < nbrOfUnits && offset <= INT_MAX; uu++) {
+      unitOffsets[uu] = (int) offset;
+      SEXP unit = VECTOR_ELT(cdf, uu);
+      if (TYPEOF(unit) != VECSXP) {
+        snprintf(msg, sizeof(msg), "Unit #%d is not a list.", uu+1);
+        throw std::runtime_error(msg);
+      }
+      SEXP groups = R_affx_cdf_field(unit, "groups", "unit", uu);
+      int nbrOfGroups = (TYPEOF(groups) == VECSXP) ? LENGTH(groups) : 0;
+      double ncells = 0;
+      for (int gg = 0; gg < nbrOfGroups; gg++) {
+        ncells += R_affx_cdf_group_ncells(VECTOR_ELT(groups, gg), uu, gg);
+      }
+      offset += R_AFFX_CDF_UNIT_BYTES + (double) R_AFFX_CDF_GROUP_BYTES * nbrOfGroups +
+                R_AFFX_CDF_CELL_BYTES * ncells;
+    }
+
+    /* File offsets are stored as 32-bit integers */
+    if (offset > INT_MAX) {
+      throw std::runtime_error("Cannot write CDF: The file would be larger than 2GB, which is the limit of the binary (XDA) CDF file format.");
+    }
+    double fileSize = offset;
+
+    if (verbose >= R_AFFX_VERBOSE) {
+      Rprintf("  Writing %d units and %d QC units (%.0f bytes)...\n",
+              nbrOfUnits, nbrOfQcUnits, fileSize);
+    }
+
+    R_affx_file_buffer out(file, bufferSize);
+
+    /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+     * Header, unit names and file offsets
+     * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+    char* ptr = out.reserve(R_AFFX_CDF_HEADER_BYTES);
+    R_affx_put_le(ptr, 67, 4);
+    R_affx_put_le(ptr + 4, 1, 4);
+    R_affx_put_le(ptr + 8, R_affx_cdf_scalar(cdfheader, "ncols", "CDF header", 0), 2);
+    R_affx_put_le(ptr + 10, R_affx_cdf_scalar(cdfheader, "nrows", "CDF header", 0), 2);
+    R_affx_put_le(ptr + 12, nbrOfUnits, 4);
+    R_affx_put_le(ptr + 16, nbrOfQcUnits, 4);
+    R_affx_put_le(ptr + 20, (uint32_t) refSeqLen, 4);
+    for (size_t pos = 0; pos < refSeqLen; ) {
+      size_t len = std::min(refSeqLen - pos, out.data.size());
+      memcpy(out.reserve(len), refSeq + pos, len);
+      pos += len;
+    }
+
+    /* Unit names are NUL terminated, i.e. at most 63 characters */
+    SEXP unitNames = getAttrib(cdf, R_NamesSymbol);
+    for (int uu = 0; uu < nbrOfUnits; uu++) {
+      const char* name = (unitNames == R_NilValue) ? "" : CHAR(STRING_ELT(unitNames, uu));
+      R_affx_cdf_put_name(out.reserve(R_AFFX_CDF_NAME_BYTES), name, R_AFFX_CDF_NAME_BYTES-1);
+    }
+    for (int qq = 0; qq < nbrOfQcUnits; qq++) {
+      R_affx_put_le(out.reserve(4), qcOffsets[qq], 4);
+    }
+    for (int uu = 0; uu < nbrOfUnits; uu++) {
+      R_affx_put_le(out.reserve(4), unitOffsets[uu], 4);
+    }
+
+    /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+     * QC units
+     * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+    for (int qq = 0; qq < nbrOfQcUnits; qq++) {
+      SEXP qcunit = VECTOR_ELT(cdfqc, qq);
+      SEXP x = R_affx_cdf_field(qcunit, "x", "QC unit", qq);
+      R_xlen_t ncells = XLENGTH(x);
+      SEXP y = R_affx_cdf_field(qcunit, "y", "QC unit", qq);
+      SEXP length = R_affx_cdf_field(qcunit, "length", "QC unit", qq);
+      SEXP pm = R_affx_cdf_field(qcunit, "pm", "QC unit", qq);
+      SEXP background = R_affx_cdf_field(qcunit, "background", "QC unit", qq);
+      if (XLENGTH(y) != ncells || XLENGTH(length) != ncells ||
+          XLENGTH(pm) != ncells || XLENGTH(background) != ncells) {
+        snprintf(msg, sizeof(msg), "The cell fields of QC unit #%d are of different lengths.", qq+1);
+        throw std::runtime_error(msg);
+      }
+
+      ptr = out.reserve(R_AFFX_CDF_QCUNIT_BYTES);
+      R_affx_put_le(ptr, R_affx_cdf_code(qcunit, "type", R_affx_cdf_qc_types, "QC unit", qq), 2);
+      R_affx_put_le(ptr + 2, R_affx_cdf_scalar_or(qcunit, "ncells", (int) ncells), 4);
+      for (R_xlen_t cc = 0; cc < ncells; cc++) {
+        ptr = out.reserve(R_AFFX_CDF_QCCELL_BYTES);
+        R_affx_put_le(ptr, R_affx_cdf_int(x, cc), 2);
+        R_affx_put_le(ptr + 2, R_affx_cdf_int(y, cc), 2);
+        R_affx_put_le(ptr + 4, R_affx_cdf_int(length, cc), 1);
+        R_affx_put_le(ptr + 5, R_affx_cdf_int(pm, cc), 1);
+        R_affx_put_le(ptr + 6, R_affx_cdf_int(background, cc), 1);
+      }
+    }
+
+    /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+     * Units
+     * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+    for (int uu = 0; uu < nbrOfUnits; uu++) {
+      SEXP unit = VECTOR_ELT(cdf, uu);
+      SEXP groups = R_affx_cdf_element(unit, "groups");
+      int nbrOfGroups = (TYPEOF(groups) == VECSXP) ? LENGTH(groups) : 0;
+      SEXP groupNames = (nbrOfGroups > 0) ? getAttrib(groups, R_NamesSymbol) : R_NilValue;
+      double unitEnd = (uu+1 < nbrOfUnits) ? unitOffsets[uu+1] : fileSize;
+      int ncells = (int) ((unitEnd - unitOffsets[uu] - R_AFFX_CDF_UNIT_BYTES -
+                           R_AFFX_CDF_GROUP_BYTES * nbrOfGroups) / R_AFFX_CDF_CELL_BYTES);
+
+      ptr = out.reserve(R_AFFX_CDF_UNIT_BYTES);
+      R_affx_put_le(ptr, R_affx_cdf_code(unit, "unittype", R_affx_cdf_unit_types, "unit", uu), 2);
+      R_affx_put_le(ptr + 2, R_affx_cdf_code(unit, "unitdirection", R_affx_cdf_directions, "unit", uu), 1);
+      R_affx_put_le(ptr + 3, R_affx_cdf_scalar(unit, "natoms", "unit", uu), 4);
+      R_affx_put_le(ptr + 7, nbrOfGroups, 4);
+      R_affx_put_le(ptr + 11, R_affx_cdf_scalar_or(unit, "ncells", ncells), 4);
+      R_affx_put_le(ptr + 15, R_affx_cdf_scalar(unit, "unitnumber", "unit", uu), 4);
+      R_affx_put_le(ptr + 19, R_affx_cdf_scalar(unit, "ncellsperatom", "unit", uu), 1);
+
+      for (int gg = 0; gg < nbrOfGroups; gg++) {
+        SEXP group = VECTOR_ELT(groups, gg);
+        R_xlen_t ncells = R_affx_cdf_group_ncells(group, uu, gg);
+        SEXP x = R_affx_cdf_cell_field(group, "x", ncells, uu, gg);
+        SEXP y = R_affx_cdf_cell_field(group, "y", ncells, uu, gg);
+        SEXP indexpos = R_affx_cdf_cell_field(group, "indexpos", ncells, uu, gg);
+        SEXP atom = R_affx_cdf_cell_field(group, "atom", ncells, uu, gg);
+        SEXP pbase = R_affx_cdf_cell_field(group, "pbase", ncells, uu, gg);
+        SEXP tbase = R_affx_cdf_cell_field(group, "tbase", ncells, uu, gg);
+        if (TYPEOF(pbase) != STRSXP || TYPEOF(tbase) != STRSXP ||
+            TYPEOF(x) == STRSXP || TYPEOF(y) == STRSXP ||
+            TYPEOF(indexpos) == STRSXP || TYPEOF(atom) == STRSXP) {
+          snprintf(msg, sizeof(msg), "The cell fields of group #%d in unit #%d are of the wrong types.", gg+1, uu+1);
+          throw std::runtime_error(msg);
+        }
+
+        /* As writeCdf() has always done: the start is min(atoms, 0) and
+           the stop NA, since groups read by readCdf() have no 'atoms' */
+        int start = 0;
+        SEXP atoms = R_affx_cdf_element(group, "atoms");
+        if (atoms != R_NilValue && TYPEOF(atoms) != STRSXP) {
+          for (R_xlen_t aa = 0; aa < XLENGTH(atoms); aa++) {
+            start = std::min(start, R_affx_cdf_int(atoms, aa));
+          }
+        }
+
+        ptr = out.reserve(R_AFFX_CDF_GROUP_BYTES);
+        R_affx_put_le(ptr, R_affx_cdf_scalar(group, "natoms", "group", gg), 4);
+        R_affx_put_le(ptr + 4, (uint32_t) ncells, 4);
+        R_affx_put_le(ptr + 8, R_affx_cdf_scalar(group, "ncellsperatom", "group", gg), 1);
+        R_affx_put_le(ptr + 9, R_affx_cdf_code(group, "groupdirection", R_affx_cdf_directions, "group", gg), 1);
+        R_affx_put_le(ptr + 10, start, 4);
+        R_affx_put_le(ptr + 14, NA_INTEGER, 4);
+        R_affx_cdf_put_name(ptr + 18, (groupNames == R_NilValue) ? "" : CHAR(STRING_ELT(groupNames, gg)),
+                            R_AFFX_CDF_NAME_BYTES);
+
+        for (R_xlen_t cc = 0; cc < ncells; cc++) {
+          ptr = out.reserve(R_AFFX_CDF_CELL_BYTES);
+          R_affx_put_le(ptr, R_affx_cdf_int(indexpos, cc), 4);
+          R_affx_put_le(ptr + 4, R_affx_cdf_int(x, cc), 2);
+          R_affx_put_le(ptr + 6, R_affx_cdf_int(y, cc), 2);
+          R_affx_put_le(ptr + 8, R_affx_cdf_int(atom, cc), 4);
+          ptr[12] = CHAR(STRING_ELT(pbase, cc))[0];
+          ptr[13] = CHAR(STRING_ELT(tbase, cc))[0];
+        }
+      }
+
+      if (verbose >= R_AFFX_REALLY_VERBOSE && (uu+1) % 10000 == 0) {
+        Rprintf("    Units left: %d\n", nbrOfUnits-uu-1);
+      }
+    }
+
+    out.flush();
+
+    if (out.tell() != fileSize) {
+      snprintf(msg, sizeof(msg), "File format write error: File size is not the expected one: %.0f != %.0f",
+               out.tell(), fileSize);
+      throw std::runtime_error(msg);
+    }
+  }
+
+
+  /************************************************************************
+   *
+   * R_affx_write_cdf_file()
+   *
+   * Writes a binary (XDA) CDF file from the structures of readCdfHeader(),
+   * readCdf() and readCdfQc().
+   *
+   ************************************************************************/
+  SEXP R_affx_write_cdf_file(SEXP fname, SEXP cdfheader, SEXP cdf, SEXP cdfqc,
+                             SEXP bufferSize, SEXP verbose)
+  {
+    char msg[1024] = "";
+    const char* cdfFileName = CHAR(STRING_ELT(fname, 0));
+    int i_bufferSize = INTEGER(bufferSize)[0];
+    int i_verboseFlag = INTEGER(verbose)[0];
+
+    if (TYPEOF(cdf) != VECSXP || (cdfqc != R_NilValue && TYPEOF(cdfqc) != VECSXP)) {
+      error("Arguments 'cdf' and 'cdfqc' must be lists.");
+    }
+    if (cdfqc == R_NilValue) cdfqc = allocVector(VECSXP, 0);
+    PROTECT(cdfqc);
+    /* Room for the largest fixed-size record */
+    if (i_bufferSize < R_AFFX_CDF_GROUP_BYTES) i_bufferSize = R_AFFX_CDF_GROUP_BYTES;
+
+    FILE* file = fopen(cdfFileName, "wb");
+    if (file == NULL) {
+      UNPROTECT(1);
+      error("Cannot write CDF: Failed to open file: %s", cdfFileName);
+    }
+
+    try {
+      R_affx_write_cdf_units(file, cdfheader, cdf, cdfqc, i_bufferSize, i_verboseFlag);
+    } catch(std::exception& ex) {
+      snprintf(msg, sizeof(msg), "%s", ex.what());
+    } catch(...) {
+      snprintf(msg, sizeof(msg), "[affxparser] Failed to write CDF file: %s", cdfFileName);
+    }
+
+    if (fclose(file) != 0 && msg[0] == '\0') {
+      snprintf(msg, sizeof(msg), "Failed to write to CDF file: %s", cdfFileName);
+    }
+    UNPROTECT(1);
+
+    /* Signal errors only when all C++ objects are gone */
+    if (msg[0] != '\0') {
+      error("%s", msg);
+    }
+
+    return R_NilValue;
+  } /* R_affx_write_cdf_file() */
+
+} /** end extern "C" **/
+
+/***************************************************************************
+ * HISTORY:
+ * 2026-10-19
+ * o Created.  Added R_affx_write_cdf_file(), which replaces the R code
+ *   of writeCdf().
+ **************************************************************************/
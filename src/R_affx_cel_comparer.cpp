@@ -0,0 +1,346 @@
+#include "FusionCELData.h"
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "R_affx_constants.h"
+
+using namespace std;
+using namespace affymetrix_fusion_io;
+
+#include <R.h>
+#include <Rdefines.h>
+
+extern "C" {
+  /************************************************************************
+   *
+   * Comparing CEL files
+   *
+   * The planes of the two files are streamed in blocks of cells through
+   * the range readers of FusionCELData and compared block by block, so
+   * memory usage does not depend on the size of the arrays.  A file with
+   * a read map is the exception; its planes are read as a whole, one at
+   * a time, since the map may refer to any cell.  Outlier and mask flags
+   * are compared as bitsets.
+   *
+   ************************************************************************/
+  enum {
+    R_AFFX_CEL_INTENSITIES = 0,
+    R_AFFX_CEL_STDVS = 1,
+    R_AFFX_CEL_PIXELS = 2,
+    R_AFFX_CEL_OUTLIERS = 3,
+    R_AFFX_CEL_MASKED = 4,
+    R_AFFX_CEL_NBR_OF_FIELDS = 5
+  };
+
+  static const char* R_affx_cel_field_names[R_AFFX_CEL_NBR_OF_FIELDS] = {
+    "intensities", "stdvs", "pixels", "outliers", "masked"
+  };
+
+  /* Cells per block */
+  static const int R_AFFX_CEL_COMPARE_BLOCK = 65536;
+
+  struct R_affx_cel_difference {
+    double count;       /* number of cells that differ */
+    int first;          /* the first (zero-based) cell that differs, or -1 */
+    double maxAbsDiff;  /* the largest absolute difference */
+  };
+
+  struct R_affx_cel_source {
+    FusionCELData cel;
+    const char* fileName;
+    const int* map;             /* one-based cell indices, or NULL */
+    std::vector<float> plane;   /* the whole plane, if there is a map */
+  };
+
+
+  static void R_affx_cel_read_block(R_affx_cel_source& src, int field, int start,
+                                    std::vector<float>& values)
+  {
+    int rc = 0;
+    if (field == R_AFFX_CEL_INTENSITIES) {
+      rc = src.cel.GetIntensities(start, values);
+    } else if (field == R_AFFX_CEL_STDVS) {
+      rc = src.cel.GetStdvs(start, values);
+    } else {
+      std::vector<short> pixels(values.size());
+      rc = src.cel.GetPixels(start, pixels);
+      for (size_t kk = 0; kk < pixels.size(); kk++) values[kk] = pixels[kk];
+    }
+    if (rc != 0 || (values.empty() && start < src.cel.GetNumCells())) {
+      char msg[1024];
+      snprintf(msg, sizeof(msg), "Failed to read the %s of CEL file: %s",
+               R_affx_cel_field_names[field], src.fileName);
+      throw std::runtime_error(msg);
+    }
+  }
+
+
+  /************************************************************************
+   *
+   * R_affx_cel_read_values()
+   *
+   * Reads the values of cells start, ..., start+values.size()-1 of a
+   * plane, after applying the read map, if any.
+   *
+   ************************************************************************/
+  static void R_affx_cel_read_values(R_affx_cel_source& src, int field, int start,
+                                     std::vector<float>& values)
+  {
+    if (src.map == NULL) {
+      R_affx_cel_read_block(src, field, start, values);
+      return;
+    }
+
+    if (src.plane.empty()) {
+      int nbrOfCells = src.cel.GetNumCells();
+      std::vector<float> block;
+      src.plane.resize(nbrOfCells);
+      for (int ss = 0; ss < nbrOfCells; ss += R_AFFX_CEL_COMPARE_BLOCK) {
+        block.resize(std::min(R_AFFX_CEL_COMPARE_BLOCK, nbrOfCells - ss));
+        R_affx_cel_read_block(src, field, ss, block);
+        std::copy(block.begin(), block.end(), src.plane.begin() + ss);
+      }
+    }
+    for (size_t kk = 0; kk < values.size(); kk++) {
+      values[kk] = src.plane[src.map[start + kk] - 1];
+    }
+  }
+
+
+  static R_affx_cel_difference R_affx_cel_compare_plane(R_affx_cel_source& src1,
+                                                        R_affx_cel_source& src2,
+                                                        int field, int nbrOfCells,
+                                                        double tolerance)
+  {
+    R_affx_cel_difference diff = { 0, -1, 0 };
+    std::vector<float> values1, values2;
+
+    for (int ss = 0; ss < nbrOfCells; ss += R_AFFX_CEL_COMPARE_BLOCK) {
+      int n = std::min(R_AFFX_CEL_COMPARE_BLOCK, nbrOfCells - ss);
+      values1.resize(n);
+      values2.resize(n);
+      R_affx_cel_read_values(src1, field, ss, values1);
+      R_affx_cel_read_values(src2, field, ss, values2);
+
+      /* First a tight pass over the block; NaNs compare as equal */
+      const float* v1 = &values1[0];
+      const float* v2 = &values2[0];
+      double maxAbsDiff = 0;
+      int count = 0;
+      for (int kk = 0; kk < n; kk++) {
+        double d = fabs((double) v1[kk] - (double) v2[kk]);
+        if (d > maxAbsDiff) maxAbsDiff = d;
+        count += (d > tolerance) | ((d != d) & ((v1[kk] == v1[kk]) | (v2[kk] == v2[kk])));
+      }
+      if (maxAbsDiff > diff.maxAbsDiff) diff.maxAbsDiff = maxAbsDiff;
+      if (count == 0) continue;
+
+      if (diff.first < 0) {
+        for (int kk = 0; kk < n; kk++) {
+          double d = fabs((double) v1[kk] - (double) v2[kk]);
+          if (d > tolerance || (d != d && (v1[kk] == v1[kk] || v2[kk] == v2[kk]))) {
+            diff.first = ss + kk;
+            break;
+          }
+        }
+      }
+      diff.count += count;
+    }
+
+    /* Only one plane is kept in memory at any time */
+    src1.plane.clear();
+    src2.plane.clear();
+
+    return diff;
+  }
+
+
+  static void R_affx_cel_flags(R_affx_cel_source& src, int field, int nbrOfCells,
+                               std::vector<unsigned long long>& bits)
+  {
+    bits.assign((nbrOfCells + 63) / 64, 0);
+    bool outliers = (field == R_AFFX_CEL_OUTLIERS);
+    if ((outliers ? src.cel.GetNumOutliers() : src.cel.GetNumMasked()) == 0) return;
+    for (int ii = 0; ii < nbrOfCells; ii++) {
+      int index = (src.map == NULL) ? ii : src.map[ii] - 1;
+      bool flag = outliers ? src.cel.IsOutlier(index) : src.cel.IsMasked(index);
+      if (flag) bits[ii / 64] |= 1ULL << (ii % 64);
+    }
+  }
+
+
+  static R_affx_cel_difference R_affx_cel_compare_flags(R_affx_cel_source& src1,
+                                                        R_affx_cel_source& src2,
+                                                        int field, int nbrOfCells)
+  {
+    R_affx_cel_difference diff = { 0, -1, 0 };
+    std::vector<unsigned long long> bits1, bits2;
+
+    R_affx_cel_flags(src1, field, nbrOfCells, bits1);
+    R_affx_cel_flags(src2, field, nbrOfCells, bits2);
+    for (size_t ww = 0; ww < bits1.size(); ww++) {
+      unsigned long long x = bits1[ww] ^ bits2[ww];
+      if (x == 0) continue;
+      diff.count += std::bitset<64>(x).count();
+      if (diff.first < 0) {
+        int bb = 0;
+        while (((x >> bb) & 1ULL) == 0) bb++;
+        diff.first = (int) ww * 64 + bb;
+      }
+    }
+    diff.maxAbsDiff = (diff.count > 0) ? 1 : 0;
+
+    return diff;
+  }
+
+
+  static void R_affx_cel_open(R_affx_cel_source& src, const char* fileName,
+                              SEXP map, bool readFlags)
+  {
+    char msg[1024];
+    src.fileName = fileName;
+    src.cel.SetFileName(fileName);
+    /* The outlier and mask flags are only read if asked for */
+    if (src.cel.Read(readFlags) == false) {
+      snprintf(msg, sizeof(msg), "Failed to read CEL file: %s", fileName);
+      throw std::runtime_error(msg);
+    }
+
+    src.map = NULL;
+    if (map == R_NilValue) return;
+
+    int nbrOfCells = src.cel.GetNumCells();
+    if (LENGTH(map) != nbrOfCells) {
+      snprintf(msg, sizeof(msg), "The length of the read map does not match the number of cells in CEL file %s: %d != %d",
+               fileName, LENGTH(map), nbrOfCells);
+      throw std::runtime_error(msg);
+    }
+    src.map = INTEGER(map);
+    for (int ii = 0; ii < nbrOfCells; ii++) {
+      if (src.map[ii] == NA_INTEGER || src.map[ii] < 1 || src.map[ii] > nbrOfCells) {
+        snprintf(msg, sizeof(msg), "The read map for CEL file %s contains an element out of range: %d",
+                 fileName, src.map[ii]);
+        throw std::runtime_error(msg);
+      }
+    }
+  }
+
+
+  /************************************************************************
+   *
+   * R_affx_compare_cel_files()
+   *
+   * Compares the cell data of two CEL files.  Argument 'fields' is a
+   * logical vector flagging which of the intensities, stdvs, pixels,
+   * outliers and masked fields to compare, and two values are considered
+   * equal if they differ by at most 'tolerance'.  Returns a numeric
+   * matrix with one row per field compared and columns 'count', the
+   * number of cells that differ, 'first', the first (one-based) cell
+   * that differs or NA, and 'maxAbsDiff', the largest absolute
+   * difference.  If the number of cells differ, the number of cells of
+   * the two files are returned instead.
+   *
+   ************************************************************************/
+  SEXP R_affx_compare_cel_files(SEXP fname, SEXP other, SEXP readMap,
+                                SEXP otherReadMap, SEXP tolerance, SEXP fields,
+                                SEXP verbose)
+  {
+    SEXP res = R_NilValue, dimnames = R_NilValue, rownames = R_NilValue,
+      colnames = R_NilValue;
+    char msg[1024] = "";
+    std::vector<int> compared;
+    std::vector<R_affx_cel_difference> diffs;
+    int nbrOfCells1 = -1, nbrOfCells2 = -1;
+
+    /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+     * Process arguments
+     * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+    const char* celFileName1 = CHAR(STRING_ELT(fname, 0));
+    const char* celFileName2 = CHAR(STRING_ELT(other, 0));
+    double d_tolerance = REAL(tolerance)[0];
+    int i_verboseFlag = INTEGER(verbose)[0];
+    if (LENGTH(fields) != R_AFFX_CEL_NBR_OF_FIELDS) {
+      error("Argument 'fields' should be of length %d: %d", R_AFFX_CEL_NBR_OF_FIELDS, LENGTH(fields));
+    }
+    bool readFlags = false;
+    for (int ff = 0; ff < R_AFFX_CEL_NBR_OF_FIELDS; ff++) {
+      if (LOGICAL(fields)[ff] != TRUE) continue;
+      compared.push_back(ff);
+      if (ff >= R_AFFX_CEL_OUTLIERS) readFlags = true;
+    }
+
+    try {
+      R_affx_cel_source src1, src2;
+      R_affx_cel_open(src1, celFileName1, readMap, readFlags);
+      R_affx_cel_open(src2, celFileName2, otherReadMap, readFlags);
+      nbrOfCells1 = src1.cel.GetNumCells();
+      nbrOfCells2 = src2.cel.GetNumCells();
+
+      if (nbrOfCells1 == nbrOfCells2) {
+        for (size_t ff = 0; ff < compared.size(); ff++) {
+          int field = compared[ff];
+          if (i_verboseFlag >= R_AFFX_VERBOSE) {
+            Rprintf("Comparing %s of %d cells\n", R_affx_cel_field_names[field], nbrOfCells1);
+          }
+          if (field >= R_AFFX_CEL_OUTLIERS) {
+            diffs.push_back(R_affx_cel_compare_flags(src1, src2, field, nbrOfCells1));
+          } else {
+            diffs.push_back(R_affx_cel_compare_plane(src1, src2, field, nbrOfCells1, d_tolerance));
+          }
+        }
+      }
+    } catch(std::exception& ex) {
+      snprintf(msg, sizeof(msg), "%s", ex.what());
+    } catch(...) {
+      snprintf(msg, sizeof(msg), "[affxparser Fusion SDK exception] Failed to compare CEL files: %s and %s", celFileName1, celFileName2);
+    }
+
+    /* Signal errors only when all C++ objects are gone */
+    if (msg[0] != '\0') {
+      error("%s", msg);
+    }
+
+    if (nbrOfCells1 != nbrOfCells2) {
+      PROTECT(res = NEW_INTEGER(2));
+      INTEGER(res)[0] = nbrOfCells1;
+      INTEGER(res)[1] = nbrOfCells2;
+      UNPROTECT(1);
+      return res;
+    }
+
+    int nbrOfFields = (int) compared.size();
+    PROTECT(res = allocMatrix(REALSXP, nbrOfFields, 3));
+    PROTECT(rownames = NEW_CHARACTER(nbrOfFields));
+    for (int ff = 0; ff < nbrOfFields; ff++) {
+      REAL(res)[ff] = diffs[ff].count;
+      /* Cell indices are one-based in R */
+      REAL(res)[ff + nbrOfFields] = (diffs[ff].first < 0) ? NA_REAL : diffs[ff].first + 1;
+      REAL(res)[ff + 2*nbrOfFields] = diffs[ff].maxAbsDiff;
+      SET_STRING_ELT(rownames, ff, mkChar(R_affx_cel_field_names[compared[ff]]));
+    }
+    PROTECT(colnames = NEW_CHARACTER(3));
+    SET_STRING_ELT(colnames, 0, mkChar("count"));
+    SET_STRING_ELT(colnames, 1, mkChar("first"));
+    SET_STRING_ELT(colnames, 2, mkChar("maxAbsDiff"));
+    PROTECT(dimnames = NEW_LIST(2));
+    SET_VECTOR_ELT(dimnames, 0, rownames);
+    SET_VECTOR_ELT(dimnames, 1, colnames);
+    setAttrib(res, R_DimNamesSymbol, dimnames);
+    UNPROTECT(4);
+
+    return res;
+  } /* R_affx_compare_cel_files() */
+
+} /** end extern "C" **/
+
+/***************************************************************************
+ * HISTORY:
+ * 2026-10-19
+ * o Created.  Added R_affx_compare_cel_files(), which replaces the R code
+ *   of compareCels().
+ **************************************************************************/
@@ -1,5 +1,12 @@
 #include "FusionCELData.h"
+#include "MappedFile.h"
+#include "StringUtils.h"
+#include <algorithm>
+#include <climits>
+#include <cstdio>
 #include <iostream>
+#include <stdexcept>
+#include <vector>
 
 #include "R_affx_constants.h"
 
@@ -8,6 +15,7 @@ using namespace affymetrix_fusion_io;
 
 #include <R.h>
 #include <Rdefines.h>  
+#include "R_affx_strings.h"
 #include <wchar.h>
 #include <wctype.h>
  
@@ -65,76 +73,23 @@ extern "C" {
     UNPROTECT(1);
    
 
-#ifdef SUPPORT_MBCS
-    str_length = cel.GetAlg().size();
-    cstr = Calloc(str_length+1, char);
-    wcstombs(cstr, cel.GetAlg().c_str(), str_length);
-    cstr[str_length] = '\0';
-    SET_STRING_ELT(names, kk, mkChar("algorithm"));
-    SET_VECTOR_ELT(vals, kk++, mkString(cstr)); 
-    Free(cstr);
-
-    str_length = cel.GetParams().size();
-    cstr = Calloc(str_length+1, char);
-    wcstombs(cstr, cel.GetParams().c_str(), str_length);
-    cstr[str_length] = '\0';
-    SET_STRING_ELT(names, kk, mkChar("parameters"));
-    SET_VECTOR_ELT(vals, kk++, mkString(cstr));
-    Free(cstr);
-   
-    str_length = cel.GetChipType().size();
-    cstr = Calloc(str_length+1, char);
-    wcstombs(cstr, cel.GetChipType().c_str(), str_length);
-    cstr[str_length] = '\0';
-    SET_STRING_ELT(names, kk, mkChar("chiptype"));
-    SET_VECTOR_ELT(vals, kk++, mkString(cstr));
-    Free(cstr);
-        
-    str_length = cel.GetHeader().size();
-    cstr = Calloc(str_length+1, char);
-    wcstombs(cstr, cel.GetHeader().c_str(), str_length);
-    cstr[str_length] = '\0';
-    SET_STRING_ELT(names, kk, mkChar("header"));
-    SET_VECTOR_ELT(vals, kk++, mkString(cstr));
-    Free(cstr);
-
-    str_length = cel.GetDatHeader().size();
-    cstr = Calloc(str_length+1, char);
-    wcstombs(cstr, cel.GetDatHeader().c_str(), str_length);
-    cstr[str_length] = '\0';
-    SET_STRING_ELT(names, kk, mkChar("datheader"));
-    SET_VECTOR_ELT(vals, kk++, mkString(cstr));
-    Free(cstr);
-
-    str_length = cel.GetLibraryPackageName().size();
-    cstr = Calloc(str_length+1, char);
-    wcstombs(cstr, cel.GetLibraryPackageName().c_str(), str_length);
-    cstr[str_length] = '\0';
-    SET_STRING_ELT(names, kk, mkChar("librarypackage"));
-    SET_VECTOR_ELT(vals, kk++, mkString(cstr));
-    Free(cstr);
-
-#else
-
     SET_STRING_ELT(names, kk, mkChar("algorithm"));
-    SET_VECTOR_ELT(vals, kk++, R_NilValue);
+    SET_VECTOR_ELT(vals, kk++, R_affx_mkStringUTF8(cel.GetAlg()));
 
     SET_STRING_ELT(names, kk, mkChar("parameters"));
-    SET_VECTOR_ELT(vals, kk++, R_NilValue);
+    SET_VECTOR_ELT(vals, kk++, R_affx_mkStringUTF8(cel.GetParams()));
 
     SET_STRING_ELT(names, kk, mkChar("chiptype"));
-    SET_VECTOR_ELT(vals, kk++, R_NilValue);
+    SET_VECTOR_ELT(vals, kk++, R_affx_mkStringUTF8(cel.GetChipType()));
 
     SET_STRING_ELT(names, kk, mkChar("header"));
-    SET_VECTOR_ELT(vals, kk++, R_NilValue);
+    SET_VECTOR_ELT(vals, kk++, R_affx_mkStringUTF8(cel.GetHeader()));
 
     SET_STRING_ELT(names, kk, mkChar("datheader"));
-    SET_VECTOR_ELT(vals, kk++, R_NilValue);
+    SET_VECTOR_ELT(vals, kk++, R_affx_mkStringUTF8(cel.GetDatHeader()));
 
     SET_STRING_ELT(names, kk, mkChar("librarypackage"));
-    SET_VECTOR_ELT(vals, kk++, R_NilValue);
-
-#endif    
+    SET_VECTOR_ELT(vals, kk++, R_affx_mkStringUTF8(cel.GetLibraryPackageName()));
 
     SET_STRING_ELT(names, kk, mkChar("cellmargin"));
     PROTECT(tmp = allocVector(INTSXP, 1));
@@ -552,12 +507,445 @@ extern "C" {
 
 
 
+  /************************************************************************
+   *
+   * R_affx_prefetch_cel_files()
+   *
+   * Hints the OS to read CEL files ahead, so that their I/O overlaps
+   * with the decoding of the file currently read.  The whole files are
+   * hinted; their headers are not parsed, since that would read the
+   * head of each file synchronously.
+   * Returns a logical vector telling for which files a hint was given.
+   *
+   ************************************************************************/
+  SEXP R_affx_prefetch_cel_files(SEXP fnames)
+  {
+    int nbrOfFiles = LENGTH(fnames);
+
+    SEXP res = PROTECT(NEW_LOGICAL(nbrOfFiles));
+    for (int ii = 0; ii < nbrOfFiles; ii++) {
+      const char* celFileName = CHAR(STRING_ELT(fnames, ii));
+      LOGICAL(res)[ii] = MappedFile::prefetch(celFileName, 0, 0);
+    }
+    UNPROTECT(1);
+
+    return res;
+  } /* R_affx_prefetch_cel_files() */
+
+
+
+  /************************************************************************
+   *
+   * R_affx_read_cel_units()
+   *
+   * Reads the cells of a set of CDF units from one or more CEL files and
+   * returns them structured by units and groups, where each field of a
+   * group is a [cells x arrays] block.  This is the engine of
+   * readCelUnits().
+   *
+   * Argument 'cdfUnits' is a list of units, each a list whose first
+   * element is the list of groups, and the first field of each group
+   * holds the (one-based) cell indices; its dimension and dimnames are
+   * carried over to the returned fields.
+   *
+   * The CEL values are scattered straight into the returned blocks, so
+   * there is no [cells x arrays] intermediate.  The cells of each chunk
+   * of at most 'chunkSize' cells are sorted by their position in the CEL
+   * file once, such that each CEL file is read chunk by chunk in file
+   * order.  The chunks only order the reads; the returned blocks hold
+   * all cells of all arrays.
+   *
+   ************************************************************************/
+
+  /* A cell to be read: its position in the CEL file and in its group */
+  struct R_affx_cel_unit_cell {
+    int index;  /* zero-based cell index in the CEL file */
+    int group;  /* the group among all groups read */
+    int row;    /* the cell of the group */
+  };
+
+  /* A group of a unit and where its fields are stored */
+  struct R_affx_cel_unit_group {
+    int ncells;
+    int offset;         /* of its first cell among all cells read */
+    double* values[4];  /* x, y, intensities and stdvs, or NULL */
+    int* pixels;
+  };
+
+  static bool R_affx_cel_unit_cell_less(const R_affx_cel_unit_cell& a,
+                                        const R_affx_cel_unit_cell& b)
+  {
+    return a.index < b.index;
+  }
+
+  /* Allocates a field of a group, with the dimensions of the CDF field */
+  static SEXP R_affx_alloc_cel_unit_field(SEXPTYPE type, SEXP cdfField, int ncells,
+                                          int nbrOfArrays, bool addArrayDim,
+                                          bool addDimnames)
+  {
+    SEXP field, dim, dimnames = R_NilValue, cdfDim, cdfDimnames;
+    int ndim, jj;
+
+    PROTECT(field = allocVector(type, (R_xlen_t) ncells * nbrOfArrays));
+
+    cdfDim = getAttrib(cdfField, R_DimSymbol);
+    ndim = (cdfDim == R_NilValue) ? 1 : LENGTH(cdfDim);
+    PROTECT(dim = NEW_INTEGER(ndim + (addArrayDim ? 1 : 0)));
+    if (cdfDim == R_NilValue) {
+      INTEGER(dim)[0] = ncells;
+    } else {
+      for (jj = 0; jj < ndim; jj++) INTEGER(dim)[jj] = INTEGER(cdfDim)[jj];
+    }
+    if (addArrayDim) INTEGER(dim)[ndim] = nbrOfArrays;
+
+    if (addDimnames) {
+      cdfDimnames = getAttrib(cdfField, R_DimNamesSymbol);
+      PROTECT(dimnames = NEW_LIST(LENGTH(dim)));
+      for (jj = 0; jj < LENGTH(dim); jj++) {
+        SEXP names = R_NilValue;
+        if (jj < ndim && cdfDimnames != R_NilValue) {
+          names = VECTOR_ELT(cdfDimnames, jj);
+        }
+        if (names == R_NilValue) {
+          /* Default names are 1, 2, ... */
+          int n = INTEGER(dim)[jj];
+          PROTECT(names = NEW_CHARACTER(n));
+          for (int kk = 0; kk < n; kk++) {
+            char buf[16];
+            snprintf(buf, sizeof(buf), "%d", kk+1);
+            SET_STRING_ELT(names, kk, mkChar(buf));
+          }
+          SET_VECTOR_ELT(dimnames, jj, names);
+          UNPROTECT(1);
+        } else {
+          SET_VECTOR_ELT(dimnames, jj, names);
+        }
+      }
+    }
+
+    if (LENGTH(dim) > 1) {
+      setAttrib(field, R_DimSymbol, dim);
+      if (addDimnames) setAttrib(field, R_DimNamesSymbol, dimnames);
+    } else if (addDimnames) {
+      setAttrib(field, R_NamesSymbol, VECTOR_ELT(dimnames, 0));
+    }
+
+    UNPROTECT(addDimnames ? 3 : 2);
+
+    return field;
+  }
+
+  /* Does the work of R_affx_read_cel_units(); throws on errors */
+  static SEXP R_affx_read_cel_units_fill(SEXP fnames, SEXP cdfUnits, SEXP readMap,
+                                         const bool* readField, SEXP transforms,
+                                         bool addDimnames, bool addArrayDim,
+                                         int chunkSize, int prefetch, int verbose)
+  {
+    static const char* fieldNames[] = { "x", "y", "intensities", "stdvs", "pixels" };
+    const int maxNbrOfFields = 5, INTENSITIES = 2, STDVS = 3, PIXELS = 4;
+    char msg[1024];
+
+    int nbrOfArrays = LENGTH(fnames);
+    int nbrOfUnits = LENGTH(cdfUnits);
+    int nbrOfFields = 0;
+    for (int ff = 0; ff < maxNbrOfFields; ff++) {
+      if (readField[ff]) nbrOfFields++;
+    }
+    bool hasTransforms = (transforms != R_NilValue);
+
+    SEXP res, unitNames, fieldNamesR, field;
+    int protectCount = 0;
+
+    /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+     * Allocate the returned structure and locate the cells to be read
+     * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+    /* All groups share the same field names */
+    PROTECT(fieldNamesR = NEW_CHARACTER(nbrOfFields));
+    protectCount++;
+    for (int ff = 0, jj = 0; ff < maxNbrOfFields; ff++) {
+      if (readField[ff]) SET_STRING_ELT(fieldNamesR, jj++, mkChar(fieldNames[ff]));
+    }
+
+    PROTECT(res = NEW_LIST(nbrOfUnits));
+    protectCount++;
+    unitNames = getAttrib(cdfUnits, R_NamesSymbol);
+    if (unitNames != R_NilValue) setAttrib(res, R_NamesSymbol, unitNames);
+
+    std::vector<R_affx_cel_unit_group> groups;
+    std::vector<R_affx_cel_unit_cell> cells;
+    /* Chunks of cells; chunk cc is [chunkEnds[cc-1], chunkEnds[cc]) */
+    std::vector<size_t> chunkEnds;
+    int maxIndex = -1;
+    int nbrOfMapped = (readMap == R_NilValue) ? 0 : LENGTH(readMap);
+
+    for (int uu = 0; uu < nbrOfUnits; uu++) {
+      SEXP cdfUnit = VECTOR_ELT(cdfUnits, uu);
+      if (TYPEOF(cdfUnit) != VECSXP || LENGTH(cdfUnit) == 0 ||
+          TYPEOF(VECTOR_ELT(cdfUnit, 0)) != VECSXP) {
+        snprintf(msg, sizeof(msg), "Unit #%d of the CDF structure contains no list of groups.", uu+1);
+        throw std::runtime_error(msg);
+      }
+      SEXP cdfGroups = VECTOR_ELT(cdfUnit, 0);
+      int nbrOfGroups = LENGTH(cdfGroups);
+
+      SEXP groupList;
+      PROTECT(groupList = NEW_LIST(nbrOfGroups));
+      SEXP groupNames = getAttrib(cdfGroups, R_NamesSymbol);
+      if (groupNames != R_NilValue) setAttrib(groupList, R_NamesSymbol, groupNames);
+
+      for (int gg = 0; gg < nbrOfGroups; gg++) {
+        SEXP cdfGroup = VECTOR_ELT(cdfGroups, gg);
+        SEXP cdfField = (TYPEOF(cdfGroup) == VECSXP && LENGTH(cdfGroup) > 0) ?
+          VECTOR_ELT(cdfGroup, 0) : R_NilValue;
+        int ncells = (cdfField == R_NilValue) ? 0 : LENGTH(cdfField);
+        if (ncells > 0 && !isInteger(cdfField) && !isReal(cdfField)) {
+          snprintf(msg, sizeof(msg), "The cell indices of group #%d in unit #%d are not numeric.", gg+1, uu+1);
+          throw std::runtime_error(msg);
+        }
+
+        R_affx_cel_unit_group group;
+        group.ncells = ncells;
+        group.offset = (int) cells.size();
+        group.pixels = NULL;
+        for (int ff = 0; ff < maxNbrOfFields-1; ff++) group.values[ff] = NULL;
+
+        SEXP fields;
+        PROTECT(fields = NEW_LIST(nbrOfFields));
+        setAttrib(fields, R_NamesSymbol, fieldNamesR);
+        /* Empty groups get NULL fields */
+        for (int ff = 0, jj = 0; ncells > 0 && ff < maxNbrOfFields; ff++) {
+          if (!readField[ff]) continue;
+          SEXPTYPE type = (ff == PIXELS) ? INTSXP : REALSXP;
+          field = R_affx_alloc_cel_unit_field(type, cdfField, ncells, nbrOfArrays,
+                                              addArrayDim, addDimnames);
+          SET_VECTOR_ELT(fields, jj++, field);
+          if (ff == PIXELS) {
+            group.pixels = INTEGER(field);
+          } else {
+            group.values[ff] = REAL(field);
+          }
+        }
+        SET_VECTOR_ELT(groupList, gg, fields);
+        UNPROTECT(1);
+
+        /* The cells of the group, after remapping */
+        for (int rr = 0; rr < ncells; rr++) {
+          double value = isInteger(cdfField) ?
+            ((INTEGER(cdfField)[rr] == NA_INTEGER) ? -1.0 : INTEGER(cdfField)[rr]) :
+            REAL(cdfField)[rr];
+          if (!(value >= 1 && value <= INT_MAX)) {
+            snprintf(msg, sizeof(msg), "Unit #%d contains a cell index out of range.", uu+1);
+            throw std::runtime_error(msg);
+          }
+          int index = (int) value;
+          if (nbrOfMapped > 0) {
+            if (index > nbrOfMapped) {
+              snprintf(msg, sizeof(msg), "Unit #%d contains a cell index that is not in the read map: %d", uu+1, index);
+              throw std::runtime_error(msg);
+            }
+            index = INTEGER(readMap)[index-1];
+            if (index == NA_INTEGER || index < 1) {
+              snprintf(msg, sizeof(msg), "The read map maps a cell of unit #%d to an invalid cell index.", uu+1);
+              throw std::runtime_error(msg);
+            }
+          }
+          R_affx_cel_unit_cell cell;
+          /* Cell indices are zero-based in Fusion SDK */
+          cell.index = index - 1;
+          cell.group = (int) groups.size();
+          cell.row = rr;
+          cells.push_back(cell);
+          if (cell.index > maxIndex) maxIndex = cell.index;
+        }
+        groups.push_back(group);
+
+        /* A chunk ends with the group that fills it */
+        size_t chunkStart = chunkEnds.empty() ? 0 : chunkEnds.back();
+        if (cells.size() - chunkStart >= (size_t) chunkSize) chunkEnds.push_back(cells.size());
+      } /* for (gg ...) */
+
+      /* As before, a unit is the list of its groups */
+      SET_VECTOR_ELT(res, uu, groupList);
+      UNPROTECT(1);  /* 'groupList' */
+    } /* for (uu ...) */
+
+    if (chunkEnds.empty() || chunkEnds.back() < cells.size()) chunkEnds.push_back(cells.size());
+
+    /* Order the cells of each chunk as they are stored in the CEL files */
+    for (size_t cc = 0, start = 0; cc < chunkEnds.size(); start = chunkEnds[cc++]) {
+      std::sort(cells.begin() + start, cells.begin() + chunkEnds[cc], R_affx_cel_unit_cell_less);
+    }
+
+    if (verbose >= R_AFFX_VERBOSE) {
+      Rprintf("Reading %d cells of %d units in %d chunks from %d CEL files.\n",
+              (int) cells.size(), nbrOfUnits, (int) chunkEnds.size(), nbrOfArrays);
+    }
+
+    /* Transforms are applied to all intensities of an array at once */
+    SEXP allIntensities = R_NilValue;
+    if (hasTransforms && readField[INTENSITIES]) {
+      PROTECT(allIntensities = NEW_NUMERIC(cells.size()));
+      protectCount++;
+    }
+
+    /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+     * For each array
+     * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+    for (int kk = 0; kk < nbrOfArrays; kk++) {
+      const char* celFileName = CHAR(STRING_ELT(fnames, kk));
+
+      /* Have the OS read ahead the files entering the read-ahead window */
+      if (prefetch > 0) {
+        int first = (kk == 0) ? 1 : kk + prefetch;
+        int last = std::min(kk + prefetch, nbrOfArrays - 1);
+        for (int jj = first; jj <= last; jj++) {
+          MappedFile::prefetch(CHAR(STRING_ELT(fnames, jj)), 0, 0);
+        }
+      }
+
+      if (verbose >= R_AFFX_VERBOSE) {
+        Rprintf("Reading CEL file #%d: %s\n", kk+1, celFileName);
+      }
+
+      FusionCELData cel;
+      cel.SetFileName(celFileName);
+      if (cel.Exists() == false) {
+        snprintf(msg, sizeof(msg), "Cannot read CEL file. File not found: %s", celFileName);
+        throw std::runtime_error(msg);
+      }
+      if (cel.Read(false) == false) {
+        snprintf(msg, sizeof(msg), "Cannot read CEL file: %s", celFileName);
+        throw std::runtime_error(msg);
+      }
+      if (maxIndex >= cel.GetNumCells()) {
+        snprintf(msg, sizeof(msg), "Cell index out of range [1,%d] in CEL file: %d (%s)",
+                 cel.GetNumCells(), maxIndex+1, celFileName);
+        throw std::runtime_error(msg);
+      }
+
+      double* tmp = (allIntensities == R_NilValue) ? NULL : REAL(allIntensities);
+
+      for (size_t cc = 0, start = 0; cc < chunkEnds.size(); start = chunkEnds[cc++]) {
+        for (size_t ii = start; ii < chunkEnds[cc]; ii++) {
+          const R_affx_cel_unit_cell& cell = cells[ii];
+          const R_affx_cel_unit_group& group = groups[cell.group];
+          R_xlen_t pos = cell.row + (R_xlen_t) group.ncells * kk;
+          if (group.values[0] != NULL) {
+            group.values[0][pos] = cel.IndexToX(cell.index);
+            group.values[1][pos] = cel.IndexToY(cell.index);
+          }
+          if (tmp != NULL) {
+            tmp[group.offset + cell.row] = cel.GetIntensity(cell.index);
+          } else if (group.values[INTENSITIES] != NULL) {
+            group.values[INTENSITIES][pos] = cel.GetIntensity(cell.index);
+          }
+          if (group.values[STDVS] != NULL) {
+            group.values[STDVS][pos] = cel.GetStdv(cell.index);
+          }
+          if (group.pixels != NULL) {
+            group.pixels[pos] = cel.GetPixels(cell.index);
+          }
+        }
+      } /* for (cc ...) */
+
+      /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+       * Transform signals?
+       * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+      if (tmp != NULL) {
+        SEXP call, value;
+        int failed = 0;
+        PROTECT(call = lang2(VECTOR_ELT(transforms, kk), allIntensities));
+        value = R_tryEval(call, R_GlobalEnv, &failed);
+        UNPROTECT(1);
+        if (failed || value == R_NilValue || !isNumeric(value) ||
+            XLENGTH(value) != XLENGTH(allIntensities)) {
+          snprintf(msg, sizeof(msg), "Failed to transform the signals of array #%d", kk+1);
+          throw std::runtime_error(msg);
+        }
+        PROTECT(value = coerceVector(value, REALSXP));
+        const double* values = REAL(value);
+        for (size_t gg = 0; gg < groups.size(); gg++) {
+          const R_affx_cel_unit_group& group = groups[gg];
+          if (group.values[INTENSITIES] == NULL) continue;
+          double* dest = group.values[INTENSITIES] + (R_xlen_t) group.ncells * kk;
+          for (int rr = 0; rr < group.ncells; rr++) dest[rr] = values[group.offset + rr];
+        }
+        UNPROTECT(1);
+      }
+    } /* for (kk ...) */
+
+    UNPROTECT(protectCount);
+
+    return res;
+  }
+
+
+  SEXP R_affx_read_cel_units(SEXP fnames, SEXP cdfUnits, SEXP readMap,
+                             SEXP readXY, SEXP readIntensities, SEXP readStdvs,
+                             SEXP readPixels, SEXP transforms, SEXP addDimnames,
+                             SEXP dropArrayDim, SEXP chunkSize, SEXP prefetch,
+                             SEXP verbose)
+  {
+    SEXP res = R_NilValue;
+    char msg[1024] = "";
+
+    /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+     * Process arguments
+     * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+    int nbrOfArrays = LENGTH(fnames);
+    bool readField[5];
+    readField[0] = readField[1] = (LOGICAL(readXY)[0] == TRUE);
+    readField[2] = (LOGICAL(readIntensities)[0] == TRUE);
+    readField[3] = (LOGICAL(readStdvs)[0] == TRUE);
+    readField[4] = (LOGICAL(readPixels)[0] == TRUE);
+    bool b_addDimnames = (LOGICAL(addDimnames)[0] == TRUE);
+    /* Add a dimension for the arrays, unless only one array is read
+       and the array dimension is not wanted. */
+    bool addArrayDim = (nbrOfArrays >= 2 || LOGICAL(dropArrayDim)[0] != TRUE);
+    int i_chunkSize = INTEGER(chunkSize)[0];
+    int i_prefetch = INTEGER(prefetch)[0];
+    int i_verboseFlag = INTEGER(verbose)[0];
+
+    if (i_chunkSize == NA_INTEGER || i_chunkSize < 1) {
+      error("Argument 'chunkSize' must be a positive integer: %d", i_chunkSize);
+    }
+    if (i_prefetch == NA_INTEGER) i_prefetch = 0;
+    if (transforms != R_NilValue && LENGTH(transforms) != nbrOfArrays) {
+      error("Length of argument 'transforms' does not match the number of arrays: %d != %d",
+            LENGTH(transforms), nbrOfArrays);
+    }
+
+    try {
+      res = R_affx_read_cel_units_fill(fnames, cdfUnits, readMap, readField,
+                                       transforms, b_addDimnames, addArrayDim,
+                                       i_chunkSize, i_prefetch, i_verboseFlag);
+    } catch(std::exception& ex) {
+      snprintf(msg, sizeof(msg), "%s", ex.what());
+    } catch(...) {
+      snprintf(msg, sizeof(msg), "[affxparser Fusion SDK exception] Failed to parse CEL file.");
+    }
+
+    /* Signal errors only when all C++ objects are gone */
+    if (msg[0] != '\0') {
+      error("%s", msg);
+    }
+
+    return res;
+  } /* R_affx_read_cel_units() */
+
+
+
 
 
 } /** end extern "C" **/
 
 /***************************************************************************
  * HISTORY:
+ * 2026-10-19
+ * o Added R_affx_read_cel_units(), the engine of readCelUnits().
+ * o Added R_affx_prefetch_cel_files().
+ * o The wide strings of the header are now converted to UTF-8 by
+ *   R_affx_mkStringUTF8() instead of wcstombs().
  * 2015-05-05
  * o ROBUSTNESS: Now using try-catch to pass exceptions to R.
  * 2006-09-15
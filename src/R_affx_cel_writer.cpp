@@ -0,0 +1,691 @@
+#include "CELData.h"
+#include "CELFileData.h"
+#include "FusionCELData.h"
+#include "GenericData.h"
+#include "GenericFileReader.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "R_affx_constants.h"
+#include "R_affx_file_buffer.h"
+#include "R_affx_thread_pool.h"
+
+using namespace std;
+
+#include <R.h>
+#include <Rdefines.h>
+
+extern "C" {
+  /************************************************************************
+   *
+   * Cell data layouts
+   *
+   * The values of cell 'index' of a field are stored at file offset
+   * start + index*stride + offset.  Binary XDA (v4) CEL files store the
+   * (intensity, stdv, pixels) records of all cells after the header, all
+   * little endian, whereas Calvin CEL files store each field in a data
+   * set of its own, big endian.
+   *
+   ************************************************************************/
+  enum { R_AFFX_CEL_FLOAT = 0, R_AFFX_CEL_SHORT = 1 };
+
+  struct R_affx_cel_field {
+    int offset;             /* within the record of a cell */
+    int type;               /* R_AFFX_CEL_FLOAT or R_AFFX_CEL_SHORT */
+    const double* dvalues;  /* new values, for floats */
+    const int* ivalues;     /* new values, for shorts */
+  };
+
+  struct R_affx_cel_layout {
+    int64_t start;
+    int stride;
+    bool bigEndian;
+    std::vector<R_affx_cel_field> fields;
+  };
+
+  static void R_affx_put_bytes(char* dest, uint32_t value, int size, bool bigEndian)
+  {
+    for (int bb = 0; bb < size; bb++) {
+      int shift = 8 * (bigEndian ? (size - 1 - bb) : bb);
+      dest[bb] = (char) ((value >> shift) & 0xFF);
+    }
+  }
+
+  static void R_affx_put_cel_value(char* dest, const R_affx_cel_field& field,
+                                   R_xlen_t ii, bool bigEndian)
+  {
+    if (field.type == R_AFFX_CEL_FLOAT) {
+      float value = (float) field.dvalues[ii];
+      uint32_t bits;
+      memcpy(&bits, &value, sizeof(bits));
+      R_affx_put_bytes(dest + field.offset, bits, 4, bigEndian);
+    } else {
+      /* As writeBin(size=2): the lower 16 bits */
+      uint16_t bits = (uint16_t) field.ivalues[ii];
+      R_affx_put_bytes(dest + field.offset, bits, 2, bigEndian);
+    }
+  }
+
+
+  /************************************************************************
+   *
+   * R_affx_get_cel_layouts()
+   *
+   * Locates the cell data of a CEL file.  Returns the number of cells
+   * in the file.  Throws if the file is not a binary XDA or Calvin CEL
+   * file.
+   *
+   ************************************************************************/
+  static int R_affx_get_cel_layouts(const char* celFileName, const double* intensities,
+                                    const double* stdvs, const int* pixels,
+                                    std::vector<R_affx_cel_layout>& layouts)
+  {
+    char msg[1024];
+    bool isCalvin = false;
+    int nbrOfCells = -1;
+
+    /* Calvin CEL file? */
+    try {
+      affymetrix_calvin_io::GenericData data;
+      affymetrix_calvin_io::GenericFileReader reader;
+      reader.SetFilename(celFileName);
+      reader.ReadHeader(data, affymetrix_calvin_io::GenericFileReader::ReadLazyDataGroupHeader);
+      isCalvin = true;
+
+      const std::wstring names[3] = { CelIntensityLabel, CelStdDevLabel, CelPixelLabel };
+      const void* values[3] = { intensities, stdvs, pixels };
+      affymetrix_calvin_io::DataGroupHeader* dch = data.FindDataGroupHeader(0);
+      for (int ff = 0; dch != NULL && ff < 3; ff++) {
+        data.IndexDataSetHeaders(dch, names[ff]);
+        affymetrix_calvin_io::DataSetHeader* dsh =
+          affymetrix_calvin_io::GenericData::FindDataSetHeader(dch, names[ff]);
+        if (dsh == NULL) {
+          if (values[ff] == NULL) continue;
+          snprintf(msg, sizeof(msg), "Cannot update CEL file. It has no '%ls' data set: %s",
+                   names[ff].c_str(), celFileName);
+          throw std::runtime_error(msg);
+        }
+        data.ReadFullDataSetHeader(dsh);
+        if (ff == 0) nbrOfCells = dsh->GetRowCnt();
+        if (values[ff] == NULL) continue;
+
+        int type = (ff == 2) ? R_AFFX_CEL_SHORT : R_AFFX_CEL_FLOAT;
+        affymetrix_calvin_io::DataSetColumnTypes expected = (ff == 2) ?
+          affymetrix_calvin_io::ShortColType : affymetrix_calvin_io::FloatColType;
+        if (dsh->GetColumnCnt() < 1 || dsh->GetColumnInfo(0).GetColumnType() != expected) {
+          snprintf(msg, sizeof(msg), "Cannot update CEL file. Unexpected column type of the '%ls' data set: %s",
+                   names[ff].c_str(), celFileName);
+          throw std::runtime_error(msg);
+        }
+
+        R_affx_cel_layout layout;
+        layout.start = dsh->GetDataStartFilePos();
+        layout.stride = dsh->GetRowSize();
+        layout.bigEndian = true;
+        R_affx_cel_field field = { 0, type, (const double*) values[ff], (const int*) values[ff] };
+        layout.fields.push_back(field);
+        layouts.push_back(layout);
+      }
+    } catch(std::runtime_error&) {
+      throw;
+    } catch(...) {
+      if (isCalvin) {
+        snprintf(msg, sizeof(msg), "[affxparser Fusion SDK exception] Failed to parse CEL file: %s", celFileName);
+        throw std::runtime_error(msg);
+      }
+      /* Not a Calvin file */
+    }
+    if (isCalvin) {
+      if (nbrOfCells < 0) {
+        snprintf(msg, sizeof(msg), "Cannot update CEL file. It has no intensities: %s", celFileName);
+        throw std::runtime_error(msg);
+      }
+      return nbrOfCells;
+    }
+
+    /* Binary XDA (v4) CEL file? */
+    affxcel::CCELFileData gcos;
+    gcos.SetFileName(celFileName);
+    if (gcos.ReadHeader() == false) {
+      snprintf(msg, sizeof(msg), "Cannot update CEL file. Failed to read header: %s", celFileName);
+      throw std::runtime_error(msg);
+    }
+    if (gcos.GetFileFormat() != affxcel::CCELFileData::XDA_BCEL) {
+      snprintf(msg, sizeof(msg), "Updating CEL v%d files is not supported: %s",
+               gcos.GetVersion(), celFileName);
+      throw std::runtime_error(msg);
+    }
+
+    /* (float intensity, float stdv, short pixels) = 10 bytes per cell */
+    R_affx_cel_layout layout;
+    layout.start = gcos.GetDataStartFilePos();
+    layout.stride = 10;
+    layout.bigEndian = false;
+    if (intensities != NULL) {
+      R_affx_cel_field field = { 0, R_AFFX_CEL_FLOAT, intensities, NULL };
+      layout.fields.push_back(field);
+    }
+    if (stdvs != NULL) {
+      R_affx_cel_field field = { 4, R_AFFX_CEL_FLOAT, stdvs, NULL };
+      layout.fields.push_back(field);
+    }
+    if (pixels != NULL) {
+      R_affx_cel_field field = { 8, R_AFFX_CEL_SHORT, NULL, pixels };
+      layout.fields.push_back(field);
+    }
+    if (!layout.fields.empty()) layouts.push_back(layout);
+
+    return gcos.GetNumCells();
+  }
+
+
+  /************************************************************************
+   *
+   * R_affx_update_cel_file()
+   *
+   * Updates the intensities, stdvs and/or pixels of a set of cells of
+   * a binary XDA (v4) or a Calvin CEL file in place.
+   *
+   * The cells are sorted by index and split up in runs of cells less
+   * than a page apart, and each run is mapped as a writable window of
+   * the file into which the values are scattered directly.  Hence only
+   * the pages holding updated cells are read and written, whereas
+   * updating all cells streams through the data section once.  When
+   * a cell index occurs more than once, the last value is written.
+   *
+   ************************************************************************/
+  static int R_affx_update_cel_file_runs(const char* celFileName, SEXP indices,
+                                         const double* intensities, const double* stdvs,
+                                         const int* pixels, R_xlen_t nbrOfValues)
+  {
+    /* Largest window mapped at once */
+    const int64_t maxWindowSize = int64_t(64) * 1024 * 1024;
+    char msg[1024];
+
+    std::vector<R_affx_cel_layout> layouts;
+    int nbrOfCells = R_affx_get_cel_layouts(celFileName, intensities, stdvs, pixels, layouts);
+
+    /* The cells in file order; 'order' maps them to their values */
+    std::vector<int> cells;
+    std::vector<R_xlen_t> order;
+    if (indices == R_NilValue) {
+      if (nbrOfValues != nbrOfCells) {
+        snprintf(msg, sizeof(msg), "Number of values does not match the number of cells: %ld != %d",
+                 (long) nbrOfValues, nbrOfCells);
+        throw std::runtime_error(msg);
+      }
+    } else {
+      order.resize(nbrOfValues);
+      for (R_xlen_t ii = 0; ii < nbrOfValues; ii++) {
+        int index = INTEGER(indices)[ii];
+        /* Cell indices are one-based in R */
+        if (index == NA_INTEGER || index < 1 || index > nbrOfCells) {
+          snprintf(msg, sizeof(msg), "Argument 'indices' is out of range [1,%d]: %d", nbrOfCells, index);
+          throw std::runtime_error(msg);
+        }
+        order[ii] = ii;
+      }
+      /* Stable, such that the last of duplicated indices is written last */
+      const int* idxs = INTEGER(indices);
+      std::stable_sort(order.begin(), order.end(),
+                       [idxs](R_xlen_t a, R_xlen_t b) { return idxs[a] < idxs[b]; });
+      cells.resize(nbrOfValues);
+      for (R_xlen_t ii = 0; ii < nbrOfValues; ii++) cells[ii] = idxs[order[ii]] - 1;
+    }
+
+    MappedFileWriter writer;
+    if (!writer.open(celFileName)) {
+      snprintf(msg, sizeof(msg), "Cannot open CEL file for writing: %s", celFileName);
+      throw std::runtime_error(msg);
+    }
+    int64_t pageSize = MappedFileWriter::getPageSize();
+    int nbrOfRuns = 0;
+
+    for (size_t ll = 0; ll < layouts.size(); ll++) {
+      const R_affx_cel_layout& layout = layouts[ll];
+      int recordSize = 0;
+      for (size_t ff = 0; ff < layout.fields.size(); ff++) {
+        int size = (layout.fields[ff].type == R_AFFX_CEL_FLOAT) ? 4 : 2;
+        recordSize = std::max(recordSize, layout.fields[ff].offset + size);
+      }
+
+      /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+       * For each run of cells
+       * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+      for (R_xlen_t aa = 0, bb; aa < nbrOfValues; aa = bb) {
+        int64_t first = cells.empty() ? aa : cells[aa];
+        int64_t last = first;
+        for (bb = aa + 1; bb < nbrOfValues; bb++) {
+          int64_t next = cells.empty() ? bb : cells[bb];
+          if ((next - last) * layout.stride > pageSize ||
+              (next - first) * layout.stride + recordSize > maxWindowSize) break;
+          last = next;
+        }
+
+        int64_t offset = layout.start + first * layout.stride;
+        int64_t len = (last - first) * layout.stride + recordSize;
+        char* window = writer.map(offset, len);
+        if (window == NULL) {
+          snprintf(msg, sizeof(msg), "Failed to access bytes [%.0f,%.0f) of CEL file: %s",
+                   (double) offset, (double) (offset + len), celFileName);
+          throw std::runtime_error(msg);
+        }
+
+        for (R_xlen_t ii = aa; ii < bb; ii++) {
+          int64_t cell = cells.empty() ? ii : cells[ii];
+          R_xlen_t value = order.empty() ? ii : order[ii];
+          char* record = window + (cell - first) * layout.stride;
+          for (size_t ff = 0; ff < layout.fields.size(); ff++) {
+            R_affx_put_cel_value(record, layout.fields[ff], value, layout.bigEndian);
+          }
+        }
+        nbrOfRuns++;
+      } /* for (aa ...) */
+    } /* for (ll ...) */
+
+    if (!writer.close()) {
+      snprintf(msg, sizeof(msg), "Failed to write CEL file: %s", celFileName);
+      throw std::runtime_error(msg);
+    }
+
+    return nbrOfRuns;
+  }
+
+
+  SEXP R_affx_update_cel_file(SEXP fname, SEXP indices, SEXP intensities,
+                              SEXP stdvs, SEXP pixels, SEXP verbose)
+  {
+    char msg[1024] = "";
+    int nbrOfRuns = 0;
+
+    /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+     * Process arguments
+     * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+    const char* celFileName = CHAR(STRING_ELT(fname, 0));
+    int i_verboseFlag = INTEGER(verbose)[0];
+    R_xlen_t nbrOfValues = -1;
+    SEXP fields[3] = { intensities, stdvs, pixels };
+    for (int ff = 0; ff < 3; ff++) {
+      if (fields[ff] == R_NilValue) continue;
+      if (nbrOfValues >= 0 && XLENGTH(fields[ff]) != nbrOfValues) {
+        error("The number of values to update differ between fields.");
+      }
+      nbrOfValues = XLENGTH(fields[ff]);
+    }
+    if (indices != R_NilValue && nbrOfValues >= 0 && XLENGTH(indices) != nbrOfValues) {
+      error("The number of values does not match the number of cell indices: %ld != %ld",
+            (long) nbrOfValues, (long) XLENGTH(indices));
+    }
+
+    /* Nothing to do? */
+    if (nbrOfValues <= 0) {
+      return R_NilValue;
+    }
+
+    if (i_verboseFlag >= R_AFFX_VERBOSE) {
+      Rprintf("Updating %ld cells of CEL file: %s\n", (long) nbrOfValues, celFileName);
+    }
+
+    try {
+      nbrOfRuns = R_affx_update_cel_file_runs(celFileName, indices,
+        (intensities == R_NilValue) ? NULL : REAL(intensities),
+        (stdvs == R_NilValue) ? NULL : REAL(stdvs),
+        (pixels == R_NilValue) ? NULL : INTEGER(pixels),
+        nbrOfValues);
+    } catch(std::exception& ex) {
+      snprintf(msg, sizeof(msg), "%s", ex.what());
+    } catch(...) {
+      snprintf(msg, sizeof(msg), "[affxparser Fusion SDK exception] Failed to update CEL file: %s", celFileName);
+    }
+
+    /* Signal errors only when all C++ objects are gone */
+    if (msg[0] != '\0') {
+      error("%s", msg);
+    }
+
+    if (i_verboseFlag >= R_AFFX_VERBOSE) {
+      Rprintf("Updated the cells in %d runs.\n", nbrOfRuns);
+    }
+
+    return R_NilValue;
+  } /* R_affx_update_cel_file() */
+
+
+  /* XDA cell entry: (float, float, short) = 4+4+2 = 10 bytes/cell */
+  static inline void R_affx_put_xda_cel_entry(char* record, float intensity,
+                                              float stdv, int pixels)
+  {
+    uint32_t bits;
+    memcpy(&bits, &intensity, sizeof(bits));
+    R_affx_put_le(record, bits, 4);
+    memcpy(&bits, &stdv, sizeof(bits));
+    R_affx_put_le(record + 4, bits, 4);
+    R_affx_put_le(record + 8, (uint16_t) pixels, 2);
+  }
+
+
+  /************************************************************************
+   *
+   * R_affx_write_cel_data()
+   *
+   * Writes a binary XDA (v4) CEL file in one sequential pass: the header
+   * as already encoded by writeCelHeader(), the number of sub-grids, the
+   * (intensity, stdv, pixels) records of all cells, and then zeros for
+   * the masked cells, the outliers and the sub-grids.  Missing fields
+   * are written as zeros.
+   *
+   ************************************************************************/
+  static void R_affx_write_cel_data(FILE* file, SEXP header, int nbrOfCells,
+                                    const double* intensities, const double* stdvs,
+                                    const int* pixels, int nbrOfMasked, int nbrOfOutliers,
+                                    int nbrOfSubgrids, int bufferSize)
+  {
+    R_affx_file_buffer out(file, bufferSize);
+
+    const char* bytes = (const char*) RAW(header);
+    for (R_xlen_t pos = 0, len = XLENGTH(header); pos < len; ) {
+      size_t nn = std::min((size_t) (len - pos), out.data.size());
+      memcpy(out.reserve(nn), bytes + pos, nn);
+      pos += nn;
+    }
+    R_affx_put_le(out.reserve(4), nbrOfSubgrids, 4);
+
+    for (int ii = 0; ii < nbrOfCells; ii++) {
+      R_affx_put_xda_cel_entry(out.reserve(10),
+        (intensities == NULL) ? 0.0f : (float) intensities[ii],
+        (stdvs == NULL) ? 0.0f : (float) stdvs[ii],
+        (pixels == NULL) ? 0 : pixels[ii]);
+    }
+
+    /* Masked and outlier entries: (short, short) = 4 bytes/cell, and
+       sub-grid entries: 6*integer + 8*float = 64 bytes/sub-grid */
+    out.zeros(4.0 * nbrOfMasked + 4.0 * nbrOfOutliers + 64.0 * nbrOfSubgrids);
+
+    out.flush();
+  }
+
+
+  SEXP R_affx_write_cel_file(SEXP fname, SEXP header, SEXP ncells,
+                             SEXP intensities, SEXP stdvs, SEXP pixels,
+                             SEXP nmasked, SEXP noutliers, SEXP nsubgrids,
+                             SEXP bufferSize, SEXP verbose)
+  {
+    char msg[1024] = "";
+
+    /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+     * Process arguments
+     * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+    const char* celFileName = CHAR(STRING_ELT(fname, 0));
+    int nbrOfCells = INTEGER(ncells)[0];
+    int i_bufferSize = INTEGER(bufferSize)[0];
+    int i_verboseFlag = INTEGER(verbose)[0];
+    if (TYPEOF(header) != RAWSXP) {
+      error("Argument 'header' must be a raw vector.");
+    }
+    SEXP fields[3] = { intensities, stdvs, pixels };
+    for (int ff = 0; ff < 3; ff++) {
+      if (fields[ff] != R_NilValue && XLENGTH(fields[ff]) != nbrOfCells) {
+        error("The number of values does not match the number of cells: %ld != %d",
+              (long) XLENGTH(fields[ff]), nbrOfCells);
+      }
+    }
+    if (i_bufferSize < 64) i_bufferSize = 64;
+
+    if (i_verboseFlag >= R_AFFX_VERBOSE) {
+      Rprintf("Writing CEL file with %d cells: %s\n", nbrOfCells, celFileName);
+    }
+
+    FILE* file = fopen(celFileName, "wb");
+    if (file == NULL) {
+      error("Cannot create CEL file. Failed to open file: %s", celFileName);
+    }
+
+    try {
+      R_affx_write_cel_data(file, header, nbrOfCells,
+        (intensities == R_NilValue) ? NULL : REAL(intensities),
+        (stdvs == R_NilValue) ? NULL : REAL(stdvs),
+        (pixels == R_NilValue) ? NULL : INTEGER(pixels),
+        INTEGER(nmasked)[0], INTEGER(noutliers)[0], INTEGER(nsubgrids)[0],
+        i_bufferSize);
+    } catch(std::exception& ex) {
+      snprintf(msg, sizeof(msg), "%s", ex.what());
+    } catch(...) {
+      snprintf(msg, sizeof(msg), "[affxparser] Failed to write CEL file: %s", celFileName);
+    }
+
+    if (fclose(file) != 0 && msg[0] == '\0') {
+      snprintf(msg, sizeof(msg), "Failed to write CEL file: %s", celFileName);
+    }
+
+    /* Signal errors only when all C++ objects are gone */
+    if (msg[0] != '\0') {
+      error("%s", msg);
+    }
+
+    return R_NilValue;
+  } /* R_affx_write_cel_file() */
+
+
+  /************************************************************************
+   *
+   * R_affx_convert_cel_data()
+   *
+   * Converts a CEL file of any format into a binary XDA (v4) CEL file
+   * with the given encoded header.  The cells are streamed from the
+   * source to the destination through the write buffer, so memory usage
+   * does not grow with the size of the array.  Cell 'jj' of the
+   * destination gets the values of source cell map[jj] (one-based),
+   * or zeros if that is zero or NA; without a map the cells are copied
+   * as is.
+   *
+   * This is run by worker threads, so it must not call the R API.
+   *
+   ************************************************************************/
+  struct R_affx_cel_conversion {
+    std::string source;
+    std::string destination;
+    const char* header;
+    size_t headerLength;
+    int nbrOfMasked;
+    int nbrOfOutliers;
+    std::string error;
+  };
+
+  static void R_affx_convert_cel_data(R_affx_cel_conversion& job, const int* map,
+                                      R_xlen_t mapLength, int bufferSize)
+  {
+    char msg[1024];
+
+    affymetrix_fusion_io::FusionCELData cel;
+    cel.SetFileName(job.source.c_str());
+    if (!cel.Read(false)) {
+      snprintf(msg, sizeof(msg), "Failed to read CEL file: %s", job.source.c_str());
+      throw std::runtime_error(msg);
+    }
+    int nbrOfCells = cel.GetNumCells();
+    if (map != NULL && mapLength != nbrOfCells) {
+      snprintf(msg, sizeof(msg), "The length of the cell map does not match the number of cells in CEL file %s: %ld != %d",
+               job.source.c_str(), (long) mapLength, nbrOfCells);
+      throw std::runtime_error(msg);
+    }
+
+    FILE* file = fopen(job.destination.c_str(), "wb");
+    if (file == NULL) {
+      snprintf(msg, sizeof(msg), "Cannot create CEL file. Failed to open file: %s", job.destination.c_str());
+      throw std::runtime_error(msg);
+    }
+
+    try {
+      R_affx_file_buffer out(file, bufferSize);
+      for (size_t pos = 0; pos < job.headerLength; ) {
+        size_t nn = std::min(job.headerLength - pos, out.data.size());
+        memcpy(out.reserve(nn), job.header + pos, nn);
+        pos += nn;
+      }
+      /* No sub-grids */
+      R_affx_put_le(out.reserve(4), 0, 4);
+
+      for (int jj = 0; jj < nbrOfCells; jj++) {
+        int index = jj;
+        if (map != NULL) {
+          index = map[jj];
+          if (index == NA_INTEGER || index == 0) {
+            R_affx_put_xda_cel_entry(out.reserve(10), 0.0f, 0.0f, 0);
+            continue;
+          }
+          if (index < 1 || index > nbrOfCells) {
+            snprintf(msg, sizeof(msg), "Cell map contains an index out of range [1,%d]: %d", nbrOfCells, index);
+            throw std::runtime_error(msg);
+          }
+          index--;
+        }
+        R_affx_put_xda_cel_entry(out.reserve(10), cel.GetIntensity(index),
+                                 cel.GetStdv(index), cel.GetPixels(index));
+      }
+
+      out.zeros(4.0 * job.nbrOfMasked + 4.0 * job.nbrOfOutliers);
+      out.flush();
+    } catch(...) {
+      fclose(file);
+      throw;
+    }
+
+    if (fclose(file) != 0) {
+      snprintf(msg, sizeof(msg), "Failed to write CEL file: %s", job.destination.c_str());
+      throw std::runtime_error(msg);
+    }
+  }
+
+
+  /************************************************************************
+   *
+   * R_affx_run_cel_conversions()
+   *
+   * Converts the CEL files using a pool of worker threads, where each
+   * worker takes the next file not yet taken.  Incomplete destination
+   * files are removed.  Returns the number of files that failed and
+   * the first error in 'msg'.
+   *
+   ************************************************************************/
+  static int R_affx_run_cel_conversions(SEXP fnames, SEXP outFnames, SEXP headers,
+                                        SEXP nmasked, SEXP noutliers, SEXP map,
+                                        int nbrOfWorkers, int bufferSize, int verbose,
+                                        char* msg, size_t msgSize)
+  {
+    int nbrOfFiles = LENGTH(fnames);
+    const int* cellMap = (map == R_NilValue) ? NULL : INTEGER(map);
+    R_xlen_t mapLength = (map == R_NilValue) ? 0 : XLENGTH(map);
+
+    /* Everything needed from R is extracted before the workers start */
+    std::vector<R_affx_cel_conversion> jobs(nbrOfFiles);
+    for (int ii = 0; ii < nbrOfFiles; ii++) {
+      SEXP header = VECTOR_ELT(headers, ii);
+      jobs[ii].source = CHAR(STRING_ELT(fnames, ii));
+      jobs[ii].destination = CHAR(STRING_ELT(outFnames, ii));
+      jobs[ii].header = (const char*) RAW(header);
+      jobs[ii].headerLength = XLENGTH(header);
+      jobs[ii].nbrOfMasked = INTEGER(nmasked)[ii];
+      jobs[ii].nbrOfOutliers = INTEGER(noutliers)[ii];
+    }
+
+    /* A failing file does not stop the others */
+    R_affx_work_queue queue(nbrOfFiles);
+    R_affx_run_workers(queue, nbrOfWorkers, [&](int) {
+      int start, stop;
+      while (queue.next(start, stop)) {
+        for (int ii = start; ii < stop; ii++) {
+          try {
+            R_affx_convert_cel_data(jobs[ii], cellMap, mapLength, bufferSize);
+          } catch(std::exception& ex) {
+            jobs[ii].error = ex.what();
+          } catch(...) {
+            jobs[ii].error = "[affxparser Fusion SDK exception] Failed to convert CEL file: " + jobs[ii].source;
+          }
+        }
+      }
+    });
+
+    int nbrOfFailed = 0;
+    for (int ii = 0; ii < nbrOfFiles; ii++) {
+      if (jobs[ii].error.empty()) {
+        if (verbose >= R_AFFX_REALLY_VERBOSE) {
+          Rprintf("Converted CEL file: %s\n", jobs[ii].source.c_str());
+        }
+        continue;
+      }
+      remove(jobs[ii].destination.c_str());
+      if (nbrOfFailed++ == 0) {
+        snprintf(msg, msgSize, "%s", jobs[ii].error.c_str());
+      }
+    }
+
+    return nbrOfFailed;
+  }
+
+
+  SEXP R_affx_convert_cel_files(SEXP fnames, SEXP outFnames, SEXP headers,
+                                SEXP nmasked, SEXP noutliers, SEXP map,
+                                SEXP workers, SEXP bufferSize, SEXP verbose)
+  {
+    char msg[1024] = "";
+    int nbrOfFailed = 0;
+
+    /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+     * Process arguments
+     * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+    int nbrOfFiles = LENGTH(fnames);
+    int i_workers = INTEGER(workers)[0];
+    int i_bufferSize = INTEGER(bufferSize)[0];
+    int i_verboseFlag = INTEGER(verbose)[0];
+    if (LENGTH(outFnames) != nbrOfFiles || LENGTH(headers) != nbrOfFiles ||
+        LENGTH(nmasked) != nbrOfFiles || LENGTH(noutliers) != nbrOfFiles) {
+      error("The number of destination files and headers does not match the number of CEL files.");
+    }
+    for (int ii = 0; ii < nbrOfFiles; ii++) {
+      if (TYPEOF(VECTOR_ELT(headers, ii)) != RAWSXP) {
+        error("Element #%d of argument 'headers' is not a raw vector.", ii+1);
+      }
+    }
+    if (i_workers == NA_INTEGER || i_workers < 1) i_workers = 1;
+    if (i_workers > nbrOfFiles) i_workers = nbrOfFiles;
+    if (i_bufferSize < 64) i_bufferSize = 64;
+
+    if (i_verboseFlag >= R_AFFX_VERBOSE) {
+      Rprintf("Converting %d CEL files using %d worker(s).\n", nbrOfFiles, i_workers);
+    }
+
+    try {
+      nbrOfFailed = R_affx_run_cel_conversions(fnames, outFnames, headers, nmasked,
+                      noutliers, map, i_workers, i_bufferSize, i_verboseFlag,
+                      msg, sizeof(msg));
+    } catch(std::exception& ex) {
+      nbrOfFailed = nbrOfFiles;
+      snprintf(msg, sizeof(msg), "%s", ex.what());
+    }
+
+    /* Signal errors only when all C++ objects are gone */
+    if (nbrOfFailed == 1) {
+      error("%s", msg);
+    } else if (nbrOfFailed > 1) {
+      error("Failed to convert %d of %d CEL files. The first error was: %s",
+            nbrOfFailed, nbrOfFiles, msg);
+    }
+
+    return R_NilValue;
+  } /* R_affx_convert_cel_files() */
+
+} /** end extern "C" **/
+
+/***************************************************************************
+ * HISTORY:
+ * 2026-10-19
+ * o Created.  Added R_affx_update_cel_file().
+ * o Added R_affx_write_cel_file().
+ * o Added R_affx_convert_cel_files().
+ * o R_affx_convert_cel_files() runs its workers via R_affx_run_workers().
+ **************************************************************************/
@@ -8,7 +8,10 @@
 #include "CHPReseqEntry.h"
 #include "StringUtils.h"
 #include "ParameterNameValueType.h"
+#include <algorithm>
+#include <cmath>
 #include <string>
+#include <vector>
 
 
 using namespace std;
@@ -19,38 +22,14 @@ using namespace affymetrix_fusion_io;
 using namespace affymetrix_calvin_parameter;
 
 #include <Rdefines.h>
+#include "R_affx_strings.h"
 
 #define SET_NAMED_ELT(lst, index, val, nameLst, nameVal) \
   SET_ELEMENT(lst, index, val); \
   SET_STRING_ELT(nameLst, index, mkChar(nameVal))
 
-// const char *
-// wcs_to_cstr(std::wstring wstr)
-// {
-// #ifdef SUPPORT_MBCS
-//   return StringUtils::ConvertWCSToMBS(wstr).c_str();
-// #else
-//   return "\0";
-// #endif
-// }
-
-char *
-wcs_to_cstr(std::wstring wstr)
-{
-#ifdef SUPPORT_MBCS
-  string str;
-  int str_length; 
-  char* cstr; 
-  str_length = wstr.size();
-  cstr = Calloc(str_length+1, char);
-  wcstombs(cstr, wstr.c_str(), str_length);
-  cstr[str_length] = '\0';
-  return cstr;
-#else
-  return "\0";
-#endif
-}
-
+/* The number of probe set results of legacy CHP files copied at a time */
+static const int R_AFFX_CHP_BLOCK = 4096;
 
 int
 R_affx_AddCHPMeta(AffymetrixGuidType fileId, 
@@ -58,17 +37,13 @@ R_affx_AddCHPMeta(AffymetrixGuidType fileId,
 		  wstring arrayType, 
 		  SEXP lst, SEXP nms, int lstIdx)
 {
-  char* cstr;
   SET_NAMED_ELT(lst, lstIdx, mkString(fileId.c_str()), nms, "FileId");
-  SET_NAMED_ELT(lst, lstIdx+1, mkString(cstr = wcs_to_cstr(algName)),
+  SET_NAMED_ELT(lst, lstIdx+1, R_affx_mkStringUTF8(algName),
 		nms, "AlgorithmName");
-  Free(cstr);
-  SET_NAMED_ELT(lst, lstIdx+2, mkString(cstr = wcs_to_cstr(algVersion)),
+  SET_NAMED_ELT(lst, lstIdx+2, R_affx_mkStringUTF8(algVersion),
 		nms, "AlgorithmVersion");
-  Free(cstr);
-  SET_NAMED_ELT(lst, lstIdx+3, mkString(cstr = wcs_to_cstr(arrayType)),
+  SET_NAMED_ELT(lst, lstIdx+3, R_affx_mkStringUTF8(arrayType),
 		nms, "ArrayType");
-  Free(cstr);
   return lstIdx+4;
 }
 
@@ -77,14 +52,11 @@ R_affx_AddCHPTileMeta(AffymetrixGuidType fileId,
 		  wstring algName, wstring algVersion, 
 		  SEXP lst, SEXP nms, int lstIdx)
 {
-  char* cstr;
   SET_NAMED_ELT(lst, lstIdx, mkString(fileId.c_str()), nms, "FileId");
-  SET_NAMED_ELT(lst, lstIdx+1, mkString(cstr = wcs_to_cstr(algName)),
+  SET_NAMED_ELT(lst, lstIdx+1, R_affx_mkStringUTF8(algName),
 		nms, "AlgorithmName"); 
-  Free(cstr);
-  SET_NAMED_ELT(lst, lstIdx+2, mkString(cstr = wcs_to_cstr(algVersion)),
+  SET_NAMED_ELT(lst, lstIdx+2, R_affx_mkStringUTF8(algVersion),
 		nms, "AlgorithmVersion");
-  Free(cstr);
   return lstIdx+3;
 }
 
@@ -93,17 +65,14 @@ R_affx_GetList(FusionTagValuePairTypeList& params)
 {
   SEXP pLst, pNms, pVal;
   int pIdx = 0, pNbr = params.size();
-  char* cstr;
   PROTECT(pLst = NEW_LIST(pNbr));
   PROTECT(pNms = NEW_CHARACTER(pNbr));
       
   for(FusionTagValuePairTypeList::iterator param=params.begin();
       param != params.end(); ++pIdx, ++param) {
-    PROTECT(pVal = mkString(cstr = wcs_to_cstr(param->Value)));
-    Free(cstr);
-    SET_NAMED_ELT(pLst, pIdx, pVal, pNms, 
-		  cstr = wcs_to_cstr(param->Tag));
-    Free(cstr);
+    PROTECT(pVal = R_affx_mkStringUTF8(param->Value));
+    SET_ELEMENT(pLst, pIdx, pVal);
+    SET_STRING_ELT(pNms, pIdx, R_affx_mkCharUTF8(param->Tag));
     UNPROTECT(1);
   }
   SET_NAMES(pLst, pNms);
@@ -117,7 +86,6 @@ R_affx_GetList(ParameterNameValueTypeList params)
 {
   SEXP pLst, pNms, pVal, pName;
   int pIdx=0, pNbr = params.size();
-  char* cstr;
   PROTECT(pLst = NEW_LIST(pNbr));
   PROTECT(pNms = NEW_CHARACTER(pNbr));
   
@@ -125,8 +93,7 @@ R_affx_GetList(ParameterNameValueTypeList params)
      but the former works and the latter does not */    
   for(ParameterNameValueTypeList::iterator param=params.begin();
       param != params.end(); ++pIdx, ++param) {
-    PROTECT(pName = mkString(cstr = wcs_to_cstr(param->GetName())));
-    Free(cstr);
+    PROTECT(pName = R_affx_mkStringUTF8(param->GetName()));
     switch(param->GetParameterType()) 
       {
       case ParameterNameValueType::Int8Type:
@@ -149,8 +116,7 @@ R_affx_GetList(ParameterNameValueTypeList params)
 	PROTECT(pVal = ScalarReal(param->GetValueFloat()));
 	break;
       case ParameterNameValueType::TextType:
-	PROTECT(pVal = mkString(cstr = wcs_to_cstr(param->GetValueText())));
-        Free(cstr);
+	PROTECT(pVal = R_affx_mkStringUTF8(param->GetValueText()));
 	break;
       case ParameterNameValueType::AsciiType:
 	PROTECT(pVal = mkString(param->GetValueAscii().c_str()));
@@ -296,16 +262,28 @@ SEXP
 R_affx_GetCHPUniversalResults(FusionCHPLegacyData *chp)
 {
   SEXP ans;
-  CHPUniversalEntry Uentry;
-  FusionUniversalProbeSetResults rFU;
-  int count, i;
+  int count, first, n, i;
 
   count = chp->GetHeader().GetNumProbeSets();
   PROTECT(ans = NEW_NUMERIC(count));
 
-  for(i = 0; i < count; ++i) {
-    chp->GetUniversalResults(i, rFU);
-    REAL(ans)[i] = rFU.GetBackground();
+  /* The results are copied block by block */
+  {
+    std::vector<FusionUniversalProbeSetResults> rFU(std::min(R_AFFX_CHP_BLOCK, count));
+    for(first = 0; first < count; first += n) {
+      n = std::min(R_AFFX_CHP_BLOCK, count - first);
+      if (!chp->GetUniversalResults(first, n, &rFU[0]))
+        break;
+      for(i = 0; i < n; ++i)
+        REAL(ans)[first+i] = rFU[i].GetBackground();
+    }
+  }
+
+  if (first < count) {
+    for(i = first; i < count; ++i)
+      REAL(ans)[i] = NA_REAL;
+    warning("failed to read the universal results of probe sets %d to %d; they are NA",
+            first+1, count);
   }
 
   UNPROTECT(1);
@@ -316,9 +294,8 @@ SEXP
 R_affx_GetCHPGenotypingResults(FusionCHPLegacyData *chp)
 {
   SEXP rval, ras1, ras2, aa, ab, bb, nocall, call, conf, callstr, alg;
-  int qNbr = chp->GetHeader().GetNumProbeSets(), i, nprotect=0, nelt;
+  int qNbr = chp->GetHeader().GetNumProbeSets(), first, n, i, nprotect=0, nelt;
   bool bWholeGenome = false, bDynamicModel = false;
-  char* cstr;
 
   PROTECT(call = NEW_INTEGER(qNbr));
   PROTECT(conf = NEW_NUMERIC(qNbr));
@@ -327,8 +304,7 @@ R_affx_GetCHPGenotypingResults(FusionCHPLegacyData *chp)
 
   //FIXME: I did not think AlgName could be "", it is, so we are stuck
   //with that
-  PROTECT(alg = mkString(cstr = wcs_to_cstr(chp->GetHeader().GetAlgName())));
-  Free(cstr);
+  PROTECT(alg = R_affx_mkStringUTF8(chp->GetHeader().GetAlgName()));
   nprotect++;
 
   if(chp->GetHeader().GetAlgName() == L"WholeGenome") {
@@ -349,22 +325,51 @@ R_affx_GetCHPGenotypingResults(FusionCHPLegacyData *chp)
   }
 
 
-  FusionGenotypeProbeSetResults f;
-  for(i=0; i<qNbr; i++) {
-    chp->GetGenotypingResults(i, f);
-    INTEGER(call)[i] = f.GetAlleleCall();
-    SET_STRING_ELT(callstr, i, mkChar(f.GetAlleleCallString().c_str()));
-    REAL(conf)[i] = f.GetConfidence();
-    if( bWholeGenome ) {
-      REAL(ras1)[i] =  f.GetRAS1();
-      REAL(ras2)[i] =  f.GetRAS2();
+  /* The results are copied block by block */
+  {
+    std::vector<FusionGenotypeProbeSetResults> block(std::min(R_AFFX_CHP_BLOCK, qNbr));
+    for(first=0; first<qNbr; first+=n) {
+      n = std::min(R_AFFX_CHP_BLOCK, qNbr - first);
+      if (!chp->GetGenotypingResults(first, n, &block[0]))
+        break;
+      for(int j=0; j<n; j++) {
+        FusionGenotypeProbeSetResults &f = block[j];
+        i = first + j;
+        INTEGER(call)[i] = f.GetAlleleCall();
+        SET_STRING_ELT(callstr, i, mkChar(f.GetAlleleCallString().c_str()));
+        REAL(conf)[i] = f.GetConfidence();
+        if( bWholeGenome ) {
+          REAL(ras1)[i] =  f.GetRAS1();
+          REAL(ras2)[i] =  f.GetRAS2();
+        }
+        if( bDynamicModel ) {
+          REAL(aa)[i] = f.GetPValueAA();
+          REAL(ab)[i] = f.GetPValueAB();
+          REAL(bb)[i] = f.GetPValueBB();
+          REAL(nocall)[i] = f.GetPValueNoCall();
+        }
+      }
     }
-    if( bDynamicModel ) {
-      REAL(aa)[i] = f.GetPValueAA();
-      REAL(ab)[i] = f.GetPValueAB();
-      REAL(bb)[i] = f.GetPValueBB();
-      REAL(nocall)[i] = f.GetPValueNoCall();
+  }
+
+  if (first < qNbr) {
+    for(i=first; i<qNbr; i++) {
+      INTEGER(call)[i] = NA_INTEGER;
+      SET_STRING_ELT(callstr, i, NA_STRING);
+      REAL(conf)[i] = NA_REAL;
+      if( bWholeGenome ) {
+        REAL(ras1)[i] = NA_REAL;
+        REAL(ras2)[i] = NA_REAL;
+      }
+      if( bDynamicModel ) {
+        REAL(aa)[i] = NA_REAL;
+        REAL(ab)[i] = NA_REAL;
+        REAL(bb)[i] = NA_REAL;
+        REAL(nocall)[i] = NA_REAL;
+      }
     }
+    warning("failed to read the genotyping results of probe sets %d to %d; they are NA",
+            first+1, qNbr);
   }
 
 
@@ -421,7 +426,7 @@ R_affx_GetCHPExpressionResults(FusionCHPLegacyData *chp)
     detectionPValue, signal, numPairs, numUsedPairs, detection, 
     hasCompResults, changePValue, signalLogRatio, signalLogRatioLow, 
     signalLogRatioHigh, numCommonPairs, change;
-  int qNbr=chp->GetHeader().GetNumProbeSets();
+  int qNbr=chp->GetHeader().GetNumProbeSets(), first, n;
 
   PROTECT(detectionPValue = NEW_NUMERIC(qNbr));
   PROTECT(signal = NEW_NUMERIC(qNbr));
@@ -437,23 +442,50 @@ R_affx_GetCHPExpressionResults(FusionCHPLegacyData *chp)
   PROTECT(change = NEW_INTEGER(qNbr));
 
   // FIXME: probe set names need to come from PSI file
-  // FIXME: very inefficient -- function calls for each assignment
-  FusionExpressionProbeSetResults psResults;
-  for (int qIdx=0; qIdx<qNbr; ++qIdx) {
-    chp->GetExpressionResults(qIdx, psResults);
-    REAL(detectionPValue)[qIdx] = psResults.GetDetectionPValue();
-    REAL(signal)[qIdx] = psResults.GetSignal();
-    INTEGER(numPairs)[qIdx] = psResults.GetNumPairs();
-    INTEGER(numUsedPairs)[qIdx] = psResults.GetNumUsedPairs();
-    INTEGER(detection)[qIdx] = psResults.GetDetection();
-    LOGICAL(hasCompResults)[qIdx] =
-      (psResults.HasCompResults() ? TRUE : FALSE);
-    REAL(changePValue)[qIdx] = psResults.GetChangePValue();
-    REAL(signalLogRatio)[qIdx] = psResults.GetSignalLogRatio();
-    REAL(signalLogRatioLow)[qIdx] = psResults.GetSignalLogRatioLow();
-    REAL(signalLogRatioHigh)[qIdx] = psResults.GetSignalLogRatioHigh();
-    INTEGER(numCommonPairs)[qIdx] = psResults.GetNumCommonPairs();
-    INTEGER(change)[qIdx] = psResults.GetChange();
+  /* The results are copied block by block */
+  {
+    std::vector<FusionExpressionProbeSetResults> block(std::min(R_AFFX_CHP_BLOCK, qNbr));
+    for (first=0; first<qNbr; first+=n) {
+      n = std::min(R_AFFX_CHP_BLOCK, qNbr - first);
+      if (!chp->GetExpressionResults(first, n, &block[0]))
+        break;
+      for (int jj=0; jj<n; ++jj) {
+        FusionExpressionProbeSetResults &psResults = block[jj];
+        int qIdx = first + jj;
+        REAL(detectionPValue)[qIdx] = psResults.GetDetectionPValue();
+        REAL(signal)[qIdx] = psResults.GetSignal();
+        INTEGER(numPairs)[qIdx] = psResults.GetNumPairs();
+        INTEGER(numUsedPairs)[qIdx] = psResults.GetNumUsedPairs();
+        INTEGER(detection)[qIdx] = psResults.GetDetection();
+        LOGICAL(hasCompResults)[qIdx] =
+          (psResults.HasCompResults() ? TRUE : FALSE);
+        REAL(changePValue)[qIdx] = psResults.GetChangePValue();
+        REAL(signalLogRatio)[qIdx] = psResults.GetSignalLogRatio();
+        REAL(signalLogRatioLow)[qIdx] = psResults.GetSignalLogRatioLow();
+        REAL(signalLogRatioHigh)[qIdx] = psResults.GetSignalLogRatioHigh();
+        INTEGER(numCommonPairs)[qIdx] = psResults.GetNumCommonPairs();
+        INTEGER(change)[qIdx] = psResults.GetChange();
+      }
+    }
+  }
+
+  if (first < qNbr) {
+    for (int qIdx=first; qIdx<qNbr; ++qIdx) {
+      REAL(detectionPValue)[qIdx] = NA_REAL;
+      REAL(signal)[qIdx] = NA_REAL;
+      INTEGER(numPairs)[qIdx] = NA_INTEGER;
+      INTEGER(numUsedPairs)[qIdx] = NA_INTEGER;
+      INTEGER(detection)[qIdx] = NA_INTEGER;
+      LOGICAL(hasCompResults)[qIdx] = NA_LOGICAL;
+      REAL(changePValue)[qIdx] = NA_REAL;
+      REAL(signalLogRatio)[qIdx] = NA_REAL;
+      REAL(signalLogRatioLow)[qIdx] = NA_REAL;
+      REAL(signalLogRatioHigh)[qIdx] = NA_REAL;
+      INTEGER(numCommonPairs)[qIdx] = NA_INTEGER;
+      INTEGER(change)[qIdx] = NA_INTEGER;
+    }
+    warning("failed to read the expression results of probe sets %d to %d; they are NA",
+            first+1, qNbr);
   }
 
   SEXP result;
@@ -503,7 +535,7 @@ R_affx_GetCHPEntries(FusionCHPQuantificationData *qData)
   ProbeSetQuantificationData psData;
   for (int qIdx=0; qIdx < qNbr; ++qIdx) {
     qData->GetQuantificationEntry(qIdx, psData);
-    SET_STRING_ELT(qNm, qIdx, mkChar(psData.name.c_str()));
+    SET_STRING_ELT(qNm, qIdx, R_affx_mkCharUTF8(psData.name));
     INTEGER(qId)[qIdx] = psData.id;
     REAL(qVec)[qIdx] = psData.quantification;
   }    
@@ -542,7 +574,7 @@ R_affx_GetCHPEntries(FusionCHPQuantificationDetectionData *qData)
     q[qIdx] = psData.quantification;
     pValue[qIdx] = psData.pvalue;
     INTEGER(qID)[qIdx] = psData.id;
-    SET_STRING_ELT(qNm, qIdx, mkChar(psData.name.c_str()));
+    SET_STRING_ELT(qNm, qIdx, R_affx_mkCharUTF8(psData.name));
   }
     
   SEXP result;
@@ -644,19 +676,15 @@ R_affx_ReadCHP(FusionCHPLegacyData *chp, bool isBrief)
 SEXP R_affx_ReadTilingDataSeqHeader(TilingSequenceData seq)
 {
   SEXP header, hnames;
-  char* cstr;
   
   //read in the header/params
   PROTECT(header = NEW_LIST(4));
   PROTECT(hnames = NEW_CHARACTER(4));
-  SET_NAMED_ELT(header, 0, mkString(cstr = wcs_to_cstr(seq.name)), hnames, "name");
-  Free(cstr);
-  SET_NAMED_ELT(header, 1, mkString(cstr = wcs_to_cstr(seq.groupName)), hnames,
+  SET_NAMED_ELT(header, 0, R_affx_mkStringUTF8(seq.name), hnames, "name");
+  SET_NAMED_ELT(header, 1, R_affx_mkStringUTF8(seq.groupName), hnames,
 		"groupName"); 
-  Free(cstr);
-  SET_NAMED_ELT(header, 2, mkString(cstr = wcs_to_cstr(seq.version)), hnames,
+  SET_NAMED_ELT(header, 2, R_affx_mkStringUTF8(seq.version), hnames,
 		"version");
-  Free(cstr);
   SET_NAMED_ELT(header, 3,
 		R_affx_GetList(seq.parameters),
 		hnames, "parameters");
@@ -665,20 +693,50 @@ SEXP R_affx_ReadTilingDataSeqHeader(TilingSequenceData seq)
   return header;
 }
 
-SEXP R_affx_ReadTilingDataSeqEntries(FusionCHPTilingData *chp, int Entry) 
+/* The index of the first entry of the open tiling sequence with a
+   genomic position not less than 'position'. */
+static int R_affx_TilingLowerBound(FusionCHPTilingData *chp, int eCount, double position)
 {
-  int eCount, i;
+  if (position <= 0)
+    return 0;
+  if (position > 4294967295.0)
+    return eCount;
+  return chp->FindTilingSequenceEntry((u_int32_t) ceil(position));
+}
+
+SEXP R_affx_ReadTilingDataSeqEntries(FusionCHPTilingData *chp, int Entry, SEXP region) 
+{
+  int eCount, first = 0, nRead, i;
   SEXP rval, position, value, nms;
-  CHPTilingEntry e;
 
   eCount = chp->GetTilingSequenceEntryCount(Entry);
+
+  /* Only the entries within the region [start,end], which are found by
+     a binary search on the sorted position column. */
+  if (region != R_NilValue) {
+    double start = REAL(region)[0], end = REAL(region)[1];
+    int last;
+    first = R_affx_TilingLowerBound(chp, eCount, start);
+    last = R_affx_TilingLowerBound(chp, eCount, floor(end) + 1);
+    eCount = (last > first ? last - first : 0);
+  }
+
   PROTECT(position = NEW_INTEGER(eCount));
   PROTECT(value = NEW_NUMERIC(eCount));
- 
-  for(i=0; i<eCount; i++) {
-    chp->GetTilingSequenceEntry(i, e);
-    INTEGER(position)[i] = e.position;
-    REAL(value)[i] =e.value;
+
+  /* Read the two columns as a whole.  The positions are stored
+     directly into the R integer vector, as unsigned 32-bit integers. */
+  std::vector<float> values(eCount);
+  nRead = 0;
+  if (eCount > 0)
+    nRead = chp->GetTilingSequenceEntries(first, eCount,
+					  (u_int32_t *) INTEGER(position),
+					  &values[0]);
+  for(i=0; i<nRead; i++)
+    REAL(value)[i] = values[i];
+  for(i=nRead; i<eCount; i++) {
+    INTEGER(position)[i] = NA_INTEGER;
+    REAL(value)[i] = NA_REAL;
   }
 
   PROTECT(rval = NEW_LIST(2));
@@ -694,7 +752,7 @@ SEXP R_affx_ReadTilingDataSeqEntries(FusionCHPTilingData *chp, int Entry)
 }
 
 SEXP
-R_affx_ReadCHP(FusionCHPTilingData *chp, bool isBrief)
+R_affx_ReadCHP(FusionCHPTilingData *chp, bool isBrief, SEXP region)
 {
   SEXP lst, nms, seqList, seqi, seqiNms, tmp;
   int lstIdx = 0, lstNbr = 6, numSeq=0, i;
@@ -722,7 +780,7 @@ R_affx_ReadCHP(FusionCHPTilingData *chp, bool isBrief)
     PROTECT(seqi = NEW_LIST(2));
     SET_ELEMENT(seqi, 0,
 		R_affx_ReadTilingDataSeqHeader(chp->GetTilingSequenceData())); 
-    SET_ELEMENT(seqi, 1, R_affx_ReadTilingDataSeqEntries(chp, i));
+    SET_ELEMENT(seqi, 1, R_affx_ReadTilingDataSeqEntries(chp, i, region));
     PROTECT(seqiNms = NEW_CHARACTER(2));
     SET_STRING_ELT(seqiNms, 0, mkChar("seq"));
     SET_STRING_ELT(seqiNms, 1, mkChar("entries"));
@@ -882,7 +940,7 @@ R_affx_ReadCHP(FusionCHPQuantificationDetectionData *chp, bool isBrief)
 extern "C" {
 
   SEXP 
-  R_affx_get_chp_file(SEXP fname, SEXP withQuantifications)
+  R_affx_get_chp_file(SEXP fname, SEXP withQuantifications, SEXP region)
   {
     if (IS_CHARACTER(fname) == FALSE || LENGTH(fname) != 1)
       error("argument '%s' should be '%s'", "fname",
@@ -891,6 +949,10 @@ extern "C" {
 	LENGTH(withQuantifications) != 1)
       error("argument '%s' should be '%s'", 
 	       "withQuantifications", "logical(1)");
+    if (region != R_NilValue &&
+	(IS_NUMERIC(region) == FALSE || LENGTH(region) != 2))
+      error("argument '%s' should be '%s'", "region",
+	       "NULL or numeric(2)");
 
     const char *chpFileName = CHAR(STRING_ELT(fname, 0));
     bool
@@ -939,7 +1001,7 @@ extern "C" {
       FusionCHPTilingData *tChp = FusionCHPTilingData::FromBase(chp);
       if(tChp != NULL) {
         processed = true;
-        PROTECT(result = R_affx_ReadCHP(tChp, isBrief));
+        PROTECT(result = R_affx_ReadCHP(tChp, isBrief, region));
         ++protectionCount;
         delete tChp;
       }
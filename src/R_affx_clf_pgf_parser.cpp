@@ -2,6 +2,9 @@
 #include "ClfFile.h"
 #include "PgfFile.h"
 #include "TsvFile.h"
+#include <cstdarg>
+#include <cstdio>
+#include <stdexcept>
 #include <string>
 
 using namespace std;
@@ -10,6 +13,19 @@ using namespace affx;
 #include "RAffxErrHandler.h"
 #include <Rdefines.h>
 
+/* Errors in reading the body are thrown as exceptions, such that the
+   callers can release their C++ objects before calling error(). */
+static void
+R_affx_throw(const char *format, ...)
+{
+  char msg[1024];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(msg, sizeof(msg), format, args);
+  va_end(args);
+  throw std::runtime_error(msg);
+}
+
 int *
 new_int_elt(const char* symbol, int length, SEXP rho)
 {
@@ -109,9 +125,9 @@ R_affx_get_body(PgfFile* pgf, SEXP rho, SEXP indices)
         for (i=0; i < length(indices); i++) {
 	    currIndex = pindices[i];
             if (currIndex == prevIndex) {
-	        error("Argument 'indices' must not contain duplicated entries: %d", currIndex);
+	        R_affx_throw("Argument 'indices' must not contain duplicated entries: %d", currIndex);
             } else if (currIndex < prevIndex) {
-	        error("Argument 'indices' must be sorted.");
+	        R_affx_throw("Argument 'indices' must be sorted.");
 	    } else if (currIndex > maxIndex) {
                 maxIndex = currIndex;
 	    }
@@ -131,8 +147,8 @@ R_affx_get_body(PgfFile* pgf, SEXP rho, SEXP indices)
           // Don't read this probeset?
 	  if (nProbesets < currIndex) continue;
 
-          // Next index
-          currIndex = pindices[++i];
+          // Next index, if any
+          if (++i < length(indices)) currIndex = pindices[i];
 	}
 
         while (pgf->next_atom() == TSV_OK) {
@@ -160,9 +176,9 @@ R_affx_get_body(PgfFile* pgf, SEXP rho, SEXP indices)
         for (i=0; i < length(indices); i++) {
             currIndex = pindices[i];
             if (currIndex <= 0) {
-                error("Argument 'indices' contains a non-positive element: %d", currIndex);
+                R_affx_throw("Argument 'indices' contains a non-positive element: %d", currIndex);
             } else if (currIndex > maxIndex) {
-                error("Argument 'indices' contains an element out of range [1,%d]: %d", maxIndex, currIndex);
+                R_affx_throw("Argument 'indices' contains an element out of range [1,%d]: %d", maxIndex, currIndex);
             }
         }
     }
@@ -211,7 +227,8 @@ R_affx_get_body(PgfFile* pgf, SEXP rho, SEXP indices)
   
         // Sanity check
         if (nProbesets < nextIndex) {
-          error("INTERNAL ERROR: Expected %d more probesets to skip in PGF file, but reached end of file.", nextIndex-nProbesets);
+          if (readAll) UNPROTECT(1);
+          R_affx_throw("INTERNAL ERROR: Expected %d more probesets to skip in PGF file, but reached end of file.", nextIndex-nProbesets);
         }
   
         // Read probeset
@@ -261,35 +278,39 @@ extern "C" {
       error("argument '%s' should be '%s'", "rho", "environment");
     
     const char *clfFileName = CHAR(STRING_ELT(fname, 0));
-
-    ClfFile *clf = new ClfFile();
-    
-    // FIXME: shortcut with sequential headers -- id, x, y are sequences
-    try {
-      RAffxErrHandler *err = new RAffxErrHandler(true);
-      Err::pushHandler(err);
-      if (clf->open(string(clfFileName)) != TSV_OK) {
-        delete clf;
-        error("could not open clf file '%s'", clfFileName);
-      }
-      // header
-      SEXP tmp;
-      PROTECT(tmp = R_affx_read_tsv_header(clf->m_tsv));
-      defineVar(install("header"), tmp, rho);
-      UNPROTECT(1);
-      if (LOGICAL(readBody)[0] == TRUE) {
-          R_affx_get_body(clf, rho);
+    char msg[1024] = "";
+
+    {
+      ReaderContext::Scope scope(R_affx_reader_context());
+      ClfFile clf;
+
+      // FIXME: shortcut with sequential headers -- id, x, y are sequences
+      try {
+        if (clf.open(string(clfFileName)) != TSV_OK) {
+          snprintf(msg, sizeof(msg), "could not open clf file '%s'", clfFileName);
+        } else {
+          // header
+          SEXP tmp;
+          PROTECT(tmp = R_affx_read_tsv_header(clf.m_tsv));
+          defineVar(install("header"), tmp, rho);
+          UNPROTECT(1);
+          if (LOGICAL(readBody)[0] == TRUE) {
+            R_affx_get_body(&clf, rho);
+          }
+        }
+      } catch (std::exception& ex) {
+        snprintf(msg, sizeof(msg), "%s", ex.what());
+      } catch (...) {
+        snprintf(msg, sizeof(msg), "[affxparser Fusion SDK exception] Failed to parse CLF file: %s", clfFileName);
       }
-      delete Err::popHandler();
-    } catch (Except& ex) {
-      delete Err::popHandler();
-      clf->close();
-      delete clf;
-      error("%s", ex.what());
+      clf.close();
+    }
+
+    /* Signal errors only when all C++ objects are gone */
+    if (msg[0] != '\0') {
+      error("%s", msg);
     }
 
-    clf->close();
-    delete clf;
     return rho;
   }
 
@@ -306,32 +327,37 @@ extern "C" {
       error("argument '%s' should be '%s'", "rho", "environments");
 
     const char *pgfFileName = CHAR(STRING_ELT(fname, 0));
-
-    PgfFile *pgf = new PgfFile();
-    try {
-      RAffxErrHandler *err = new RAffxErrHandler(true);
-      Err::pushHandler(err);
-      if (pgf->open(string(pgfFileName)) != TSV_OK) {
-        delete pgf;
-        error("could not open pgf file '%s'", pgfFileName);
-      }
-      SEXP tmp;
-      PROTECT(tmp = R_affx_read_tsv_header(pgf->m_tsv));
-      defineVar(install("header"), tmp, rho);
-      UNPROTECT(1);
-      if (LOGICAL(readBody)[0] == TRUE) {
-          R_affx_get_body(pgf, rho, indices);
+    char msg[1024] = "";
+
+    {
+      ReaderContext::Scope scope(R_affx_reader_context());
+      PgfFile pgf;
+
+      try {
+        if (pgf.open(string(pgfFileName)) != TSV_OK) {
+          snprintf(msg, sizeof(msg), "could not open pgf file '%s'", pgfFileName);
+        } else {
+          SEXP tmp;
+          PROTECT(tmp = R_affx_read_tsv_header(pgf.m_tsv));
+          defineVar(install("header"), tmp, rho);
+          UNPROTECT(1);
+          if (LOGICAL(readBody)[0] == TRUE) {
+            R_affx_get_body(&pgf, rho, indices);
+          }
+        }
+      } catch (std::exception& ex) {
+        snprintf(msg, sizeof(msg), "%s", ex.what());
+      } catch (...) {
+        snprintf(msg, sizeof(msg), "[affxparser Fusion SDK exception] Failed to parse PGF file: %s", pgfFileName);
       }
-      pgf->close();
-      delete Err::popHandler();
-    } catch (Except& ex) {
-      delete Err::popHandler();	// errors now are fatal
-      pgf->close();
-      delete pgf;
-      error("%s", ex.what());
+      pgf.close();
+    }
+
+    /* Signal errors only when all C++ objects are gone */
+    if (msg[0] != '\0') {
+      error("%s", msg);
     }
 
-    delete pgf;
     return rho;
   }
 }
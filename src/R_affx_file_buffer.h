@@ -0,0 +1,59 @@
+#if !defined(R_AFFX_FILE_BUFFER_H)
+#define R_AFFX_FILE_BUFFER_H
+#include <cstdio>
+#include <stdexcept>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+
+/*
+ * Collects the bytes of a file being written in a large buffer, which
+ * is written to the file whenever it fills up.  Used by the writers of
+ * binary CDF and CEL files, which write their files in one sequential
+ * pass.
+ */
+struct R_affx_file_buffer {
+  FILE* file;
+  std::vector<char> data;
+  size_t used;
+  double written;
+
+  R_affx_file_buffer(FILE* file, size_t size) : file(file), data(size), used(0), written(0) {}
+
+  void flush() {
+    if (used > 0 && fwrite(&data[0], 1, used, file) != used) {
+      throw std::runtime_error("Failed to write to file.");
+    }
+    written += used;
+    used = 0;
+  }
+
+  /* Get room for 'len' bytes; 'len' must not exceed the buffer size */
+  char* reserve(size_t len) {
+    if (used + len > data.size()) flush();
+    char* ptr = &data[used];
+    used += len;
+    return ptr;
+  }
+
+  /* Append 'len' zero bytes */
+  void zeros(double len) {
+    while (len > 0) {
+      size_t nn = (len < data.size()) ? (size_t) len : data.size();
+      memset(reserve(nn), 0, nn);
+      len -= nn;
+    }
+  }
+
+  double tell() const { return written + used; }
+};
+
+/* Store the lower 'size' bytes of a value in little endian byte order */
+static inline void R_affx_put_le(char* dest, uint32_t value, int size)
+{
+  for (int bb = 0; bb < size; bb++) {
+    dest[bb] = (char) ((value >> (8*bb)) & 0xFF);
+  }
+}
+
+#endif
@@ -0,0 +1,29 @@
+#if !defined(R_AFFX_STRINGS_H)
+#define R_AFFX_STRINGS_H
+#include <string>
+#include "StringUtils.h"
+
+#include <Rinternals.h>
+
+/*
+ * Makes R strings from the wide strings of the Fusion SDK.  These are
+ * converted to UTF-8 regardless of the locale, so characters outside
+ * ASCII are kept.  Shared by the CCG, CEL and CHP parsers.
+ */
+inline SEXP R_affx_mkCharUTF8(const std::string& str) {
+  return mkCharCE(str.c_str(), CE_UTF8);
+}
+
+inline SEXP R_affx_mkCharUTF8(const std::wstring& wstr) {
+  return R_affx_mkCharUTF8(affymetrix_calvin_utilities::StringUtils::ConvertWCSToUTF8(wstr));
+}
+
+inline SEXP R_affx_mkStringUTF8(const std::wstring& wstr) {
+  SEXP res;
+  PROTECT(res = allocVector(STRSXP, 1));
+  SET_STRING_ELT(res, 0, R_affx_mkCharUTF8(wstr));
+  UNPROTECT(1);
+  return res;
+}
+
+#endif
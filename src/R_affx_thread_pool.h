@@ -0,0 +1,99 @@
+#if !defined(R_AFFX_THREAD_POOL_H)
+#define R_AFFX_THREAD_POOL_H
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Hands out the tasks 0, ..., nbrOfTasks-1 in chunks of 'chunkSize'
+ * tasks to the workers of R_affx_run_workers(), which take chunks until
+ * none is left.  Once stopped, e.g. after a failure, no more chunks are
+ * handed out.  No R API calls are made here, such that it can be used
+ * by the Fusion SDK readers too.
+ */
+class R_affx_work_queue {
+ public:
+  R_affx_work_queue(int nbrOfTasks, int chunkSize = 1) :
+    m_nbrOfTasks(nbrOfTasks), m_chunkSize(std::max(chunkSize, 1)),
+    m_next(0), m_stopped(false) {}
+
+  /* Takes the next chunk of tasks [start, stop); false if there is none */
+  bool next(int& start, int& stop) {
+    if (m_stopped) return false;
+    start = m_next.fetch_add(m_chunkSize);
+    if (start >= m_nbrOfTasks) return false;
+    stop = std::min(start + m_chunkSize, m_nbrOfTasks);
+    return true;
+  }
+
+  int nbrOfChunks() const {
+    return (m_nbrOfTasks + m_chunkSize - 1) / m_chunkSize;
+  }
+
+  /* Stops handing out chunks */
+  void stop() { m_stopped = true; }
+
+  bool stopped() const { return m_stopped; }
+
+  /* Stops handing out chunks and records the error, unless an earlier
+     one was recorded */
+  void fail(const std::string& error) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_error.empty()) m_error = error.empty() ? "Unknown error." : error;
+    m_stopped = true;
+  }
+
+  const std::string& error() const { return m_error; }
+
+ private:
+  int m_nbrOfTasks;
+  int m_chunkSize;
+  std::atomic<int> m_next;
+  std::atomic<bool> m_stopped;
+  std::mutex m_mutex;
+  std::string m_error;
+};
+
+/*
+ * Calls work(worker) for workers 0, ..., nbrOfWorkers-1, which take
+ * their tasks from 'queue'.  Worker 0 runs on the calling thread and
+ * the others on threads of their own, but no more workers than there
+ * are chunks.  If a thread cannot be started, the workers already
+ * running take over its tasks.  An exception thrown by a worker stops
+ * the queue, and the first one is rethrown as a std::runtime_error when
+ * all workers are done.
+ */
+template <class Work>
+static void R_affx_run_workers(R_affx_work_queue& queue, int nbrOfWorkers, Work work)
+{
+  auto run = [&queue, &work](int worker) {
+    try {
+      work(worker);
+    } catch(std::exception& ex) {
+      queue.fail(ex.what());
+    } catch(...) {
+      queue.fail("");
+    }
+  };
+
+  nbrOfWorkers = std::min(nbrOfWorkers, queue.nbrOfChunks());
+
+  std::vector<std::thread> threads;
+  try {
+    /* Reserved first, such that no started thread is lost to a failing push_back() */
+    threads.reserve(std::max(nbrOfWorkers - 1, 0));
+    for (int ww = 1; ww < nbrOfWorkers; ww++) threads.push_back(std::thread(run, ww));
+  } catch(...) {
+    /* Fewer threads than asked for; the others take over */
+  }
+  run(0);
+  for (size_t ww = 0; ww < threads.size(); ww++) threads[ww].join();
+
+  if (!queue.error().empty()) throw std::runtime_error(queue.error());
+}
+
+#endif
@@ -246,6 +246,7 @@ void CelFileData::SetMaskCount(int32_t ln)
 void CelFileData::UpdateDataSetRowCount(const DataSetHeader &hdr)
 {
 	DataGroupHeader* grpHdr = &genericData.Header().GetDataGroup(0);
+	genericData.IndexDataSetHeaders(grpHdr);
 	bool found = false;
 	int sz = grpHdr->GetDataSetCnt();
 	for(int i = 0; i < sz; i++)
@@ -267,6 +268,7 @@ void CelFileData::UpdateDataSetRowCount(const DataSetHeader &hdr)
 void CelFileData::InsertDataSetHeader(const DataSetHeader &hdr)
 {
 	DataGroupHeader* dcHdr = &genericData.Header().GetDataGroup(0);
+	genericData.IndexDataSetHeaders(dcHdr);
 	dcHdr->AddDataSetHdr(hdr);
 }
 
@@ -960,8 +962,14 @@ DataSetHeader* CelFileData::FindDataSetHeader(const std::wstring& name)
 	if (grpHdr)
 	{
 		DataSetHeader* setHdr = genericData.FindDataSetHeader(grpHdr, name);
+		if (setHdr == 0)
+		{
+			genericData.IndexDataSetHeaders(grpHdr, name);
+			setHdr = genericData.FindDataSetHeader(grpHdr, name);
+		}
 		if (setHdr)
 		{
+			genericData.ReadFullDataSetHeader(setHdr);
 			return setHdr;
 		}
 	}
@@ -128,11 +128,7 @@ void CHPData::GetEntry(int32_t row, CHPGenotypeEntry& e)
 		if (wideProbeSetNames == false)
 			entriesGeno->GetData(row, 0, probeSetName);
 		else
-		{
-			std::wstring wprobeSetName;
-			entriesGeno->GetData(row, 0, wprobeSetName);
-			probeSetName = StringUtils::ConvertWCSToMBS(wprobeSetName);
-		}
+			entriesGeno->GetDataUTF8(row, 0, probeSetName);
 		e.SetProbeSetName(probeSetName);
 
 		u_int8_t call = 0;
@@ -179,11 +175,7 @@ void CHPData::GetEntry(int32_t row, CHPExpressionEntry& e)
 		if (wideProbeSetNames == false)
 			entriesExp->GetData(row, colIndex++, probeSetName);
 		else
-		{
-			std::wstring wprobeSetName;
-			entriesExp->GetData(row, colIndex++, wprobeSetName);
-			probeSetName = StringUtils::ConvertWCSToMBS(wprobeSetName);
-		}
+			entriesExp->GetDataUTF8(row, colIndex++, probeSetName);
 		e.SetProbeSetName(probeSetName);
 
 		u_int8_t detection = 0;
@@ -225,6 +225,7 @@ const static std::wstring SIGNAL_STRENGTH = L"SignalStrength";
 	/*! constructor */
 DataSetInfo::DataSetInfo()    {
   entries = NULL;
+  nameIndex = NULL;
   maxName = -1;
   maxSegmentType = -1;
   maxReferenceSegmentID = -1;
@@ -288,13 +289,17 @@ DataSetHeader *CHPMultiDataData::GetDataSetHeader(MultiDataType dataType)
     for (int ig=0; ig<ng; ig++)
     {
         DataGroupHeader &dh = genericData.Header().GetDataGroup(ig);
-	    int n = dh.GetDataSetCnt();
-	    for (int i=0; i<n; i++)
-	    {
-		    DataSetHeader &h = dh.GetDataSet(i);
-		    if (h.GetName() == MultiDataDataSetNames[(int)dataType])
-			    return &h;
-	    }
+        DataSetHeader *h = dh.FindDataSetHeader(MultiDataDataSetNames[(int)dataType]);
+        if (h == NULL && dh.GetUnindexedDataSetCnt() > 0)
+        {
+            genericData.IndexDataSetHeaders(&dh, MultiDataDataSetNames[(int)dataType]);
+            h = dh.FindDataSetHeader(MultiDataDataSetNames[(int)dataType]);
+        }
+        if (h != NULL)
+        {
+            genericData.ReadFullDataSetHeader(h);
+            return h;
+        }
     }
 	return NULL;
 }
@@ -305,6 +310,8 @@ void CHPMultiDataData::Clear()
 	{
 		DataSetInfo &info = it->second;
 		info.metricColumns.clear();
+		ProbeSetNameIndex::release(info.nameIndex);
+		info.nameIndex = NULL;
 		if (info.entries){ info.entries->Delete();  info.entries = 0; }
 	}
 	dataSetInfo.clear();
@@ -929,6 +936,24 @@ std::string CHPMultiDataData::GetProbeSetName(MultiDataType dataType, int index)
 	return name;
 }
 
+ProbeSetNameIndex *CHPMultiDataData::GetProbeSetNameIndex(MultiDataType dataType)
+{
+	DataSetInfo *ds = OpenMultiDataDataSet(dataType);
+	if (ds == NULL || ds->entries == NULL || ds->entries->IsOpen() == false)
+		return NULL;
+	if (ds->nameIndex == NULL)
+		ds->nameIndex = ProbeSetNameIndex::acquire(ds->entries, 0);
+	return ds->nameIndex;
+}
+
+int CHPMultiDataData::FindProbeSet(MultiDataType dataType, const std::string &name)
+{
+	const ProbeSetNameIndex *index = GetProbeSetNameIndex(dataType);
+	if (index == NULL)
+		return -1;
+	return index->Find(name);
+}
+
 void CHPMultiDataData::AddColumns(DataSetInfo &info, DataSetHeader& hdr)
 {
 	switch (info.dataType)
@@ -1166,6 +1191,7 @@ DataSetInfo *CHPMultiDataData::OpenMultiDataDataSet(MultiDataType dataType)
         {
             DataGroupHeader &dh = genericData.Header().GetDataGroup(ig);
             std::wstring name = dh.GetName();
+            genericData.IndexDataSetHeaders(&dh);
             int ns = dh.GetDataSetCnt();
             for (int is=0; is<ns; is++)
             {
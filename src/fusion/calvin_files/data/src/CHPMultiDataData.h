@@ -30,6 +30,7 @@
 #include "calvin_files/data/src/GenericData.h"
 #include "calvin_files/data/src/MarkerABSignals.h"
 #include "calvin_files/data/src/ProbeSetMultiDataData.h"
+#include "calvin_files/data/src/ProbeSetNameIndex.h"
 #include "calvin_files/data/src/CytoGenotypeCallMultiDataData.h"
 #include "calvin_files/portability/src/AffymetrixBaseTypes.h"
 //
@@ -158,6 +159,9 @@ public:
 	/*! chp data sets */
 	DataSet* entries;
 
+	/*! The index of the probe set names, shared with other files; NULL until used. */
+	ProbeSetNameIndex* nameIndex;
+
 	/*! The maximum length of the name column. */
 	int maxName;
 
@@ -504,6 +508,23 @@ public:
 	*/
 	std::string GetProbeSetName(MultiDataType dataType, int index);
 
+	/*! Finds a probe set by name. The names are hashed on first use; the index is
+	* shared by all CHP files whose name column is identical.
+	* @param dataType The data type
+	* @param name The probe set name.
+	* @return The row index, or -1 if not found.
+	*/
+	int FindProbeSet(MultiDataType dataType, const std::string &name);
+
+	/*! Gets the probe set name index used by FindProbeSet. Files whose probe set names
+	* are identical get the same index, so a caller looking up the same names in many
+	* files may reuse the rows found for the previous file when the index is the same.
+	* @param dataType The data type
+	* @return The index, or NULL if there is no such data set. It is released with this
+	* object; use ProbeSetNameIndex::retain to keep it longer.
+	*/
+	ProbeSetNameIndex *GetProbeSetNameIndex(MultiDataType dataType);
+
 	/*! Returns the data set header.
 	* @param dataType The data type.
 	*/
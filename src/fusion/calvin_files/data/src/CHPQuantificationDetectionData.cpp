@@ -132,11 +132,7 @@ void CHPQuantificationDetectionData::GetQuantificationDetectionEntry(int index,
 		if (firstColumnType == ASCIICharColType)
 			entries->GetData(index, 0, entry.name);
 		else if (firstColumnType == UnicodeCharColType)
-		{
-            std::wstring wprobeSetName;
-            entries->GetData(index, 0, wprobeSetName);
-            entry.name = StringUtils::ConvertWCSToMBS(wprobeSetName);
-		}
+            entries->GetDataUTF8(index, 0, entry.name);
         else if (firstColumnType == IntColType)
             entries->GetData(index, 0, entry.id);
         entries->GetData(index, 1, entry.quantification);
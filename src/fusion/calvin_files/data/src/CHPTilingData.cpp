@@ -58,6 +58,34 @@ void CHPTilingData::GetTilingSequenceEntry(int row, CHPTilingEntry& e)
 	}
 }
 
+int32_t CHPTilingData::GetTilingSequenceEntries(int row, int count, u_int32_t *positions, float *values)
+{
+	if (entries == 0 || entries->IsOpen() == false)
+		return 0;
+	int32_t n = entries->GetDataRaw(0, row, count, positions);
+	entries->GetDataRaw(1, row, n, values);
+	return n;
+}
+
+int32_t CHPTilingData::FindTilingSequenceEntry(u_int32_t position)
+{
+	if (entries == 0 || entries->IsOpen() == false)
+		return 0;
+	int32_t lo = 0;
+	int32_t hi = entries->Rows();
+	u_int32_t p;
+	while (lo < hi)
+	{
+		int32_t mid = lo + (hi - lo) / 2;
+		entries->GetData(mid, 0, p);
+		if (p < position)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
 CHPTilingData::~CHPTilingData() 
 { 
 	Clear(); 
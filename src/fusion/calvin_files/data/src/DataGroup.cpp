@@ -55,7 +55,10 @@ DataGroup::DataGroup(const std::string& filename_, const DataGroupHeader& dch, s
 	*/
 affymetrix_calvin_io::DataSet* DataGroup::DataSet(u_int32_t dataSetIdx)
 {
-	DataSetHeader* dph = GenericData::FindDataSetHeader(&dataGroupHeader, dataSetIdx);
+	// The DataGroupHeader of a DataGroup has all of its DataSetHeaders.
+	DataSetHeader* dph = 0;
+	if ((int32_t)dataSetIdx < dataGroupHeader.GetDataSetCnt())
+		dph = &dataGroupHeader.GetDataSet(dataSetIdx);
 	if (dph)
 	{
 		if (useMemoryMapping)
@@ -29,6 +29,9 @@ DataGroupHeader::DataGroupHeader()
 {
 	dataSetPos = 0;
 	nextGrpPos = 0;
+	headerStartFilePos = 0;
+	unindexedDataSetCnt = 0;
+	unindexedDataSetPos = 0;
 }
 DataGroupHeader::DataGroupHeader(const std::wstring &n) 
 {
@@ -36,6 +39,8 @@ DataGroupHeader::DataGroupHeader(const std::wstring &n)
 	dataSetPos = 0;
 	nextGrpPos = 0;
 	headerStartFilePos = 0;
+	unindexedDataSetCnt = 0;
+	unindexedDataSetPos = 0;
 }
 
 DataGroupHeader::~DataGroupHeader() 
@@ -49,6 +54,8 @@ void DataGroupHeader::Clear()
 	dataSetPos = 0;
 	nextGrpPos = 0;
 	dataSetHdrs.clear();
+	unindexedDataSetCnt = 0;
+	unindexedDataSetPos = 0;
 }
 
 void DataGroupHeader::SetName(const std::wstring &p)
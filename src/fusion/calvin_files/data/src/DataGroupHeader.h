@@ -55,6 +55,10 @@ private:
 	u_int32_t headerStartFilePos;
 	/*! data dataSets in this dataGroup */
 	DataSetHdrVector dataSetHdrs;
+	/*! number of DataSetHeaders in the file that have not been indexed yet (lazy reading) */
+	u_int32_t unindexedDataSetCnt;
+	/*! file position of the first DataSetHeader that has not been indexed yet */
+	u_int32_t unindexedDataSetPos;
 
 public:
 
@@ -99,6 +103,17 @@ public:
 	void SetNextGroupPos(u_int32_t pos) { nextGrpPos  = pos; }
 	/*! Get the file position of the next DataGroup header. */
 	u_int32_t GetNextGroupPos() const { return nextGrpPos; }
+	/*! Set the DataSetHeaders that are still to be read from the file.
+	 *	Used when the DataGroupHeader is read lazily; the DataSetHeaders are then
+	 *	indexed on first access through GenericData.
+	 *	@param cnt The number of DataSetHeaders not yet read.
+	 *	@param pos The file position of the first DataSetHeader not yet read.
+	 */
+	void SetUnindexedDataSets(u_int32_t cnt, u_int32_t pos) { unindexedDataSetCnt = cnt; unindexedDataSetPos = pos; }
+	/*! Get the number of DataSetHeaders not yet read from the file. */
+	u_int32_t GetUnindexedDataSetCnt() const { return unindexedDataSetCnt; }
+	/*! Get the file position of the first DataSetHeader not yet read from the file. */
+	u_int32_t GetUnindexedDataSetPos() const { return unindexedDataSetPos; }
 	/*!
 	 */
 	affymetrix_calvin_io::DataSetHeader* FindDataSetHeader(const std::wstring& dataSetName);
@@ -31,24 +31,6 @@
 
 using namespace affymetrix_calvin_io;
 
-#ifndef _MSC_VER
-#include <unistd.h>
-#include <sys/mman.h>
-
-#ifndef PAGE_SIZE
-/// Page size used for memory mapping in non Windows environment
-#define PAGE_SIZE (getpagesize())
-#endif
-#ifndef PAGE_MASK
-/// Page mask used for memory mapping in non Windows environment
-#define PAGE_MASK ~(PAGE_SIZE-1)
-#endif
-#ifndef PAGE_TRUNC
-/// Page truncation pointer used for memory mapping in non Windows environment
-#define PAGE_TRUNC(ptr) (ptr&(PAGE_MASK))
-#endif
-#endif
-
 /*
  * Initialize the object to use memory-mapping to access the file.
  */
@@ -57,20 +39,21 @@ DataSet::DataSet(const std::string& fileName_, const DataSetHeader& header_, voi
 	fileName = fileName_;
 	header = header_;
 
-	mappedData = 0;
 	data = 0;
 	isOpen = false;
 
-#ifdef _MSC_VER
-	fileMapHandle = handle;
-#else
-	fp = 0;
-#endif
 	mapStart = 0;
 	mapLen = 0;
 	fileStream = 0;
 	useMemoryMapping = true;
 	loadEntireDataSetHint = loadEntireDataSetHint_;
+	streamBuffer = 0;
+	streamBufferSize = 0;
+	windowStartRow = 0;
+	windowRowCount = 0;
+	windowFirstCol = 0;
+	windowLastCol = 0;
+	readAheadSize = DefaultReadAheadSize;
 }
 
 /*
@@ -81,20 +64,21 @@ DataSet::DataSet(const std::string& fileName_, const affymetrix_calvin_io::DataS
 	fileName = fileName_;
 	header = header_;
 
-	mappedData = 0;
 	data = 0;
 	isOpen = false;
 
-#ifdef _MSC_VER
-	fileMapHandle = 0;
-#else
-	fp = 0;
-#endif
 	mapStart = 0;
 	mapLen = 0;
 	fileStream = &ifs;
 	useMemoryMapping = false;
 	loadEntireDataSetHint = loadEntireDataSetHint_;
+	streamBuffer = 0;
+	streamBufferSize = 0;
+	windowStartRow = 0;
+	windowRowCount = 0;
+	windowFirstCol = 0;
+	windowLastCol = 0;
+	readAheadSize = DefaultReadAheadSize;
 }
 
 /*
@@ -137,21 +121,18 @@ bool DataSet::Open()
  */
 bool DataSet::OpenMM()
 {
-#ifdef _MSC_VER
-	if (MapDataWin32(header.GetDataStartFilePos(), header.GetDataSize()) == false)
+	// The mapping is shared with other readers of the same file.
+	if (mappedFile.open(fileName) == false)
 		return false;
-#else
-	// Open the file
-	fp = fopen(fileName.c_str(), "r");
-	if (fp == NULL)
+
+	if (MapData(header.GetDataStartFilePos(), header.GetDataSize()) == false)
 	{
+		UnmapFile();
 		return false;
 	}
 
-	if (MapDataPosix(header.GetDataStartFilePos(), header.GetDataSize()) == false)
-		return false;
-#endif
-
+	// The data is usually read front to back.
+	mappedFile.advise(mapStart, mapLen, MappedFile::ADVICE_SEQUENTIAL);
 	return true;
 }
 
@@ -166,7 +147,7 @@ void DataSet::ReadDataSetUsingStream()
 	mapLen = header.GetDataSize();
 	mapStart = header.GetDataStartFilePos();
 
-	data = new char[mapLen];
+	data = AcquireStreamBuffer(mapLen);
 	fileStream->seekg(mapStart);
 	fileStream->read(data, mapLen);
 }
@@ -182,143 +163,45 @@ void DataSet::Close()
 		ClearStreamData();
 }
 
-#ifdef _MSC_VER
-
-std::string GetErrorMsg()
-{
-	LPVOID lpMsgBuf;
-	if (!FormatMessage( 
-			FORMAT_MESSAGE_ALLOCATE_BUFFER | 
-			FORMAT_MESSAGE_FROM_SYSTEM | 
-			FORMAT_MESSAGE_IGNORE_INSERTS,
-			NULL,
-			GetLastError(),
-			MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), // Default language
-			(LPTSTR) &lpMsgBuf,
-			0,
-			NULL ))
-	{
-		// Handle the error.
-		return "";
-	}
-
-	std::string message = (char*)lpMsgBuf;
-
-	// Free the buffer.
-	LocalFree( lpMsgBuf );
-
-	return message;
-}
-
 /*
- * Map the data on Win32
+ * Map the data.  Files too large to be mapped as a whole are mapped
+ * in views of at most MaxViewSize bytes.
  */
-bool DataSet::MapDataWin32(u_int32_t start, u_int32_t bytes)
+bool DataSet::MapData(u_int32_t start, u_int32_t bytes)
 {
-	mapStart = start;
+	// Don't map beyond the end of the file
+	int64_t fileLen = mappedFile.size();
+	if (int64_t(start) + bytes > fileLen)
+		bytes = (int64_t(start) < fileLen) ? u_int32_t(fileLen - start) : 0;
 
-	if (bytes > MaxViewSize)
+	if (mappedFile.isShared() == false && bytes > MaxViewSize)
 	{
 		bytes = MaxViewSize;	// limit the amount of data mapped
 	}
 
-	SYSTEM_INFO sysinfo;
-	GetSystemInfo (&sysinfo);
-	u_int64_t qwFileOffset = u_int64_t(start);
-	DWORD dwOffset = DWORD(qwFileOffset % sysinfo.dwAllocationGranularity);
-	qwFileOffset = (qwFileOffset / sysinfo.dwAllocationGranularity) *
-								sysinfo.dwAllocationGranularity;
-	DWORD dwOffsetHigh = DWORD(qwFileOffset >> 32);
-	DWORD dwOffsetLow  = DWORD(qwFileOffset & 0xFFFFFFFF);
-	DWORD dwBytesToMap = bytes + dwOffset;
-
-	if (mappedData != 0)
+	const char* ptr = mappedFile.map(start, bytes);
+	if (ptr == 0)
 	{
-		UnmapViewOfFile (mappedData);
-	}
-	mappedData = MapViewOfFile(fileMapHandle, FILE_MAP_READ, dwOffsetHigh, dwOffsetLow, dwBytesToMap);
-	if (mappedData == 0)
-	{
-		std::string msg = GetErrorMsg();
 		data = 0;
-		fileMapHandle = NULL;
 		mapStart = 0;
+		mapLen = 0;
 		return false;
 	}
-	mapLen = bytes;
-	data = (char *)mappedData + dwOffset;
-	return true;
-}
-
-#else
-
-/*
- * Map the data on Linux
- */
-bool DataSet::MapDataPosix(u_int32_t start, u_int32_t bytes)
-{
 	mapStart = start;
-	if (fp == NULL)
-		return false;
-
-	u_int32_t page_start = PAGE_TRUNC(start);
-	u_int32_t page_offset = start - page_start;
-	mapLen = bytes + page_offset;
-
-	// Get the file size
-	if (Fs::fileExists(fileName))
-	{
-          int64_t fileLen = Fs::fileSize(fileName);
-		if (fileLen < page_start + mapLen)
-			mapLen = fileLen - page_start;
-	}
-
-	// Map the file.
-	mappedData = mmap(NULL, mapLen, PROT_READ, MAP_SHARED, fileno(fp), page_start);
-	if (mappedData == MAP_FAILED)
-	{
-		Close();
-		return false;
-	}
-	else
-	{
-		data = ((char *)mappedData) + page_offset;
-	}
+	mapLen = bytes;
+	data = (char*)ptr;
 	return true;
 }
-#endif
 
 /*
  * Close the memory-map
  */
 void DataSet::UnmapFile()
 {
-#ifdef _MSC_VER
-
-	// Unmap the view
-	if (mappedData != 0 )
-	{
-		UnmapViewOfFile(mappedData);
-		mappedData = 0;
-	}
-	fileMapHandle = NULL;
+	mappedFile.close();
 	data = 0;
 	mapStart = 0;
 	mapLen = 0;
-
-#else
-	if (fp != NULL)
-	{
-		if (mappedData)
-		{
-			munmap(mappedData, mapLen);
-			mapLen = 0;
-			mappedData = 0;
-		}
-		fclose(fp);
-		fp = NULL;
-	}
-#endif
 }
 
 /*
@@ -326,10 +209,30 @@ void DataSet::UnmapFile()
  */
 void DataSet::ClearStreamData()
 {
-	delete[] data;
+	delete[] streamBuffer;
+	streamBuffer = 0;
+	streamBufferSize = 0;
 	data = 0;
 	mapStart = 0;
 	mapLen = 0;
+	windowRowCount = 0;
+}
+
+/*
+ * Get an aligned buffer, reusing the current one if it is large enough.
+ */
+char* DataSet::AcquireStreamBuffer(u_int32_t bytes)
+{
+	if (streamBuffer == 0 || bytes > streamBufferSize)
+	{
+		delete[] streamBuffer;
+		streamBuffer = 0;
+		streamBufferSize = 0;
+		streamBuffer = new char[bytes + StreamBufferAlignment];
+		streamBufferSize = bytes;
+	}
+	size_t misalignment = ((size_t) streamBuffer) % StreamBufferAlignment;
+	return streamBuffer + (misalignment == 0 ? 0 : StreamBufferAlignment - misalignment);
 }
 
 /*
@@ -387,8 +290,6 @@ char* DataSet::FilePosition(int32_t rowStart, int32_t col, int32_t rowCount)
 	// Byte offset in data set + byte offset of data set in file
 	u_int32_t startByte = BytesPerRow()*rowStart + columnByteOffsets[col] + header.GetDataStartFilePos();
 
-#ifdef _MSC_VER
-
 	if (useMemoryMapping)
 	{
 		// Byte offset in data set + byte offset of data set in file
@@ -407,7 +308,7 @@ char* DataSet::FilePosition(int32_t rowStart, int32_t col, int32_t rowCount)
 				if (reverseStartByte < header.GetDataStartFilePos())
 					reverseStartByte = header.GetDataStartFilePos();
 
-				if (MapDataWin32(reverseStartByte, header.GetDataStartFilePos() + header.GetDataSize() - reverseStartByte) == false)
+				if (MapData(reverseStartByte, header.GetDataStartFilePos() + header.GetDataSize() - reverseStartByte) == false)
 				{
 					affymetrix_calvin_exceptions::DataSetRemapException e(L"Calvin",L"Default Description, Please Update!",affymetrix_calvin_utilities::DateTime::GetCurrentDateTime().ToString(),std::string(__FILE__),(u_int16_t)__LINE__,0);
 					throw e;
@@ -415,7 +316,7 @@ char* DataSet::FilePosition(int32_t rowStart, int32_t col, int32_t rowCount)
 			}
 			else	// forward
 			{
-				if (MapDataWin32(startByte, header.GetDataStartFilePos() + header.GetDataSize() - startByte) == false)
+				if (MapData(startByte, header.GetDataStartFilePos() + header.GetDataSize() - startByte) == false)
 				{
 					affymetrix_calvin_exceptions::DataSetRemapException e(L"Calvin",L"Default Description, Please Update!",affymetrix_calvin_utilities::DateTime::GetCurrentDateTime().ToString(),std::string(__FILE__),(u_int16_t)__LINE__,0);
 					throw e;
@@ -423,7 +324,6 @@ char* DataSet::FilePosition(int32_t rowStart, int32_t col, int32_t rowCount)
 			}
 		}
 	}
-#endif
 
 	char*	filePosition = data + (startByte-mapStart);
 	return filePosition;
@@ -434,16 +334,57 @@ char* DataSet::FilePosition(int32_t rowStart, int32_t col, int32_t rowCount)
  */
 char* DataSet::LoadDataAndReturnFilePosition(int32_t rowStart, int32_t col, int32_t rowCount)
 {
-	// Delete the previous data
-	ClearStreamData();
+	int32_t rows = header.GetRowCnt();
+	if (rowCount < 1 || rowStart + rowCount > rows)
+		rowCount = rows - rowStart;
+	if (rowCount < 1)
+		rowCount = 1;
+
+	int32_t bytesPerRow = BytesPerRow();
+	u_int32_t startByte = bytesPerRow*rowStart + columnByteOffsets[col] + header.GetDataStartFilePos();
 
-	mapLen = BytesPerRow()*rowCount;
-	mapStart = BytesPerRow()*rowStart + columnByteOffsets[col] + header.GetDataStartFilePos();
+	// Serve the request from the current window if possible
+	if (windowRowCount > 0 &&
+		rowStart >= windowStartRow && rowStart + rowCount <= windowStartRow + windowRowCount &&
+		col >= windowFirstCol && col <= windowLastCol)
+	{
+		return data + (startByte-mapStart);
+	}
 
-	data = new char[mapLen];
+	// Coalesce with the columns of the current window when reading forward
+	int32_t firstCol = col;
+	int32_t lastCol = col;
+	if (windowRowCount > 0 && rowStart >= windowStartRow)
+	{
+		firstCol = (windowFirstCol < col ? windowFirstCol : col);
+		lastCol = (windowLastCol > col ? windowLastCol : col);
+	}
+	int32_t spanBytes = columnByteOffsets[lastCol+1] - columnByteOffsets[firstCol];
+
+	// Read ahead, but not past the last row
+	int32_t windowRows = rowCount;
+	if (spanBytes > 0 && (u_int32_t) windowRows * spanBytes < readAheadSize)
+		windowRows = readAheadSize / spanBytes;
+	if (windowRows > rows - rowStart)
+		windowRows = rows - rowStart;
+	if (windowRows < rowCount)
+		windowRows = rowCount;
+
+	// Read only the byte span of the window columns
+	mapStart = bytesPerRow*rowStart + columnByteOffsets[firstCol] + header.GetDataStartFilePos();
+	mapLen = bytesPerRow*(windowRows-1) + spanBytes;
+
+	data = AcquireStreamBuffer(mapLen);
+	fileStream->clear();
 	fileStream->seekg(mapStart);
 	fileStream->read(data, mapLen);
-	return data;
+
+	windowStartRow = rowStart;
+	windowRowCount = windowRows;
+	windowFirstCol = firstCol;
+	windowLastCol = lastCol;
+
+	return data + (startByte-mapStart);
 }
 
 /*
@@ -526,6 +467,13 @@ void DataSet::GetData(int32_t row, int32_t col, std::wstring& value)
 	value = FileInput::ReadString16(instr);
 }
 
+void DataSet::GetDataUTF8(int32_t row, int32_t col, std::string& value)
+{
+	// Get the data
+	char* instr = FilePosition(row, col);
+	FileInput::ReadString16AsUTF8(instr, value);
+}
+
 
 int32_t DataSet::ComputeEndRow(int32_t startRow, int32_t count)
 {
@@ -565,7 +513,7 @@ template<typename T> void DataSet::GetDataT(int32_t col, int32_t startRow, int32
 		{
 			if (row > recomputePositionRow)
 			{
-				instr = FilePosition(row, col, count-row);
+				instr = FilePosition(row, col, endRow-row);
 				recomputePositionRow = LastRowMapped();
 			}
 			AssignValue(row-startRow, values, instr);
@@ -684,7 +632,7 @@ template<typename T> int32_t DataSet::GetDataRawT(int32_t col, int32_t startRow,
 		{
 			if (row > recomputePositionRow)
 			{
-				instr = FilePosition(row, col, count-row);
+				instr = FilePosition(row, col, endRow-row);
 				recomputePositionRow = LastRowMapped();
 			}
 			AssignValue(row-startRow, values, instr);
@@ -782,6 +730,32 @@ int32_t DataSet::GetDataRaw(int32_t col, int32_t startRow, int32_t count, std::w
 	return GetDataRawT(col, startRow, count, values);
 }
 
+u_int64_t DataSet::GetColumnChecksum(int32_t col)
+{
+	u_int64_t h = 14695981039346656037ULL;
+	int32_t width = columnByteOffsets[col+1] - columnByteOffsets[col];
+	int32_t endRow = header.GetRowCnt();
+	char* instr = NULL;
+	int32_t recomputePositionRow = -1;
+	for (int32_t row = 0; row < endRow; ++row)
+	{
+		if (header.GetColumnCnt() > 1)
+			instr = FilePosition(row, col);
+		else if (row > recomputePositionRow)
+		{
+			instr = FilePosition(row, col, endRow-row);
+			recomputePositionRow = LastRowMapped();
+		}
+		for (int32_t i = 0; i < width; ++i)
+		{
+			h ^= (u_int8_t) instr[i];
+			h *= 1099511628211ULL;
+		}
+		instr += width;
+	}
+	return h;
+}
+
 int32_t DataSet::LastRowMapped()
 {
 	return (mapLen+(mapStart-header.GetDataStartFilePos()))/BytesPerRow() - 1;
@@ -29,6 +29,7 @@
 #include "calvin_files/data/src/DataSetHeader.h"
 #include "calvin_files/portability/src/AffymetrixBaseTypes.h"
 #include "calvin_files/utils/src/AffyStlCollectionTypes.h"
+#include "util/MappedFile.h"
 //
 #include <cstring>
 #include <fstream>
@@ -47,10 +48,11 @@ class DataSet
 {
 public:
 	/*! Constructor. Use this constructor do access the data using memory-mapping.
-	 *	On Windows, memory-mapping will be restricted to 200MB view of the DataSet data.
+	 *	The file mapping is shared with other readers of the same file.  Files too large to
+	 *	be mapped as a whole are restricted to 200MB views of the DataSet data.
 	 *	@param fileName The name of the generic file to access.
 	 *	@param header The DataSetHeader of the DataSet to access.
-	 *	@param handle A handle to the file mapping object
+	 *	@param handle Not used; kept for compatibility
 	 *	@param loadEntireDataSetHint Indicate if DataSet will attempt to read the entire DataSet data into a memory buffer.
 	 */
 	DataSet(const std::string& fileName, const affymetrix_calvin_io::DataSetHeader& header, void* handle, bool loadEntireDataSetHint=false);
@@ -117,6 +119,17 @@ public:
 
 	void GetData(int32_t row, int32_t col, std::wstring& value);
 
+	/*! Provides access to the text of a Unicode column as a UTF-8 string.
+	 *	The text is converted directly from the file, without building a wide
+	 *	character string. The memory of value is reused, so passing the same string
+	 *	for consecutive rows avoids allocations.
+	 *	@param row Row index.
+	 *	@param col Column index.
+	 *	@param value Reference to the string to fill with the data.
+	 *	@exception affymetrix_calvin_exceptions::DataSetNotOpenException The file is not memory-mapped.
+	 */
+	void GetDataUTF8(int32_t row, int32_t col, std::string& value);
+
 	/*! Provides access to multiple data elements in the same column.
 	 *	If count elements could not be read, it is not considered an error.  The vector
 	 *	is filled with only the data that could be read.
@@ -175,6 +188,20 @@ public:
 
 	int32_t GetDataRaw(int32_t col, int32_t startRow, int32_t count, std::wstring* values);
 
+	/*! Computes a 64 bit checksum (FNV-1a) of the raw bytes of a column over all rows,
+	 *	e.g. to detect data sets of different files that have identical columns.
+	 *	@param col Column index.
+	 *	@return The checksum.
+	 *	@exception affymetrix_calvin_exceptions::DataSetNotOpenException The file is not open.
+	 */
+	u_int64_t GetColumnChecksum(int32_t col);
+
+	/*! Sets the minimum number of bytes read from the file each time the stream window moves.
+	 *	Only used when the data is accessed using std::ifstream and the entire DataSet is not loaded.
+	 *	@param bytes The read-ahead size in bytes.
+	 */
+	void SetReadAheadSize(u_int32_t bytes) { readAheadSize = bytes; }
+
 	/*! Check that the requested data matches the type of data in the column and that row and column are in bounds.
 	 *	@param row Row index to check.
 	 *	@param col Column index to check.
@@ -227,6 +254,10 @@ protected:
 	/*! Returns the address of a data element given a row and column.  Ensures that data from rowStart
 	 *	to rowCount+rowStart are copied from the file into a memory buffer.  The memory buffer will
 	 *	remain intact until the next call to LoadDataAndReturnFilePosition.
+	 *	The buffer holds a window of rows which is reused as long as the requested rows and column
+	 *	fall within it.  Otherwise the window is moved to rowStart, reading at least readAheadSize bytes.
+	 *	Only the byte span of the columns in the window is read; the span is extended with the requested
+	 *	column when reading forward and reset to it when reading backward.
 	 *	@param rowStart Row index
 	 *	@param col Column index
 	 *	@param rowCount The number of rows to ensure are mapped starting at rowStart
@@ -235,6 +266,13 @@ protected:
 	 */
 	char* LoadDataAndReturnFilePosition(int32_t rowStart, int32_t col, int32_t rowCount);
 
+	/*! Returns a buffer of at least the given size for the stream window.
+	 *	The buffer is aligned and reused until a larger one is needed.
+	 *	@param bytes The number of bytes needed.
+	 *	@return Pointer to the buffer.
+	 */
+	char* AcquireStreamBuffer(u_int32_t bytes);
+
 	/*! Updates the columnByteOffsets member. */
 	void UpdateColumnByteOffsets();
 
@@ -276,16 +314,12 @@ protected:
 	 */
 	int32_t LastRowMapped();
 
-	/*! Platform specific memory-mapping method */
-#ifdef _MSC_VER
-
-	bool MapDataWin32(u_int32_t start, u_int32_t bytes);
-
-#else
-
-	bool MapDataPosix(u_int32_t start, u_int32_t bytes);
-
-#endif
+	/*! Maps bytes of the file starting at start, limited to MaxViewSize if the file is not mapped as a whole.
+	 *	@param start Byte offset in the file
+	 *	@param bytes Number of bytes to map
+	 *	@return True if successful.
+	 */
+	bool MapData(u_int32_t start, u_int32_t bytes);
 
 	/*! Reads from the instr pointer into the vector at the index indicated.
 	 *	@param index Index to the vector where to write the value.
@@ -335,10 +369,10 @@ protected:
 	/*! copy of the DataSetHeader */
 	affymetrix_calvin_io::DataSetHeader header;
 
-	/*! pointer to the mapped data, doesn't account for allocation granularity. */
-	void*	mappedData;
+	/*! The mapped file, shared with other readers of the same file. */
+	MappedFileView mappedFile;
 
-	/*! pointer to the data.  In memory-mapping mode, the pointer has been adjusted for the allocation granularity. */
+	/*! pointer to the data. */
 	char*	data;
 
 	/*! Array of column byte offsets.  Updated when the file is opened.
@@ -346,19 +380,9 @@ protected:
 	 */
 	Int32Vector columnByteOffsets;
 
-#ifdef _MSC_VER
-
-	/*! Handle returned by CreateFileMapping */
-	HANDLE fileMapHandle;
-	/*! Maximum size of the view to map */
+	/*! Maximum size of the view to map when the file is not mapped as a whole */
 	static const u_int32_t MaxViewSize = 200*1024*1024;	// 200MB
 
-#else
-
-	FILE *fp;
-
-#endif
-
 	/*! Indicates if the DataSet is open*/
 	bool isOpen;
 	/*! Byte offset to the start of the view */
@@ -371,6 +395,24 @@ protected:
 	std::ifstream* fileStream;
 	/*! Indicates whether to attempt to read all data into a memory buffer. */
 	bool loadEntireDataSetHint;
+	/*! The allocated stream buffer, data points into it when not memory-mapping. */
+	char* streamBuffer;
+	/*! The usable size of the stream buffer in bytes. */
+	u_int32_t streamBufferSize;
+	/*! First row in the stream window. */
+	int32_t windowStartRow;
+	/*! Number of rows in the stream window, 0 if the window is empty. */
+	int32_t windowRowCount;
+	/*! First column in the stream window. */
+	int32_t windowFirstCol;
+	/*! Last column in the stream window. */
+	int32_t windowLastCol;
+	/*! Minimum number of bytes to read when the stream window is moved. */
+	u_int32_t readAheadSize;
+	/*! Default read-ahead size of the stream window. */
+	static const u_int32_t DefaultReadAheadSize = 1024*1024;	// 1MB
+	/*! Alignment of the stream buffer. */
+	static const u_int32_t StreamBufferAlignment = 64;
 
 };
 
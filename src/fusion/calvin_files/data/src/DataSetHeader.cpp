@@ -51,6 +51,7 @@ void DataSetHeader::Clear()
 void DataSetHeader::ClearNameValueParameters()
 {
 	nameValParams.clear();
+	paramNameIdx.Clear();
 }
 
 int32_t DataSetHeader::GetDataSize() const
@@ -87,6 +88,7 @@ int32_t DataSetHeader::GetNameValParamCnt() const
 void DataSetHeader::AddNameValParam(const ParameterNameValueType &p)
 {
 	nameValParams.push_back(p);
+	paramNameIdx.Added(nameValParams);
 }
 
 void DataSetHeader::GetNameValIterators(ParameterNameValueTypeConstIt &begin, ParameterNameValueTypeConstIt &end) const
@@ -173,13 +175,10 @@ int32_t DataSetHeader::GetColumnCnt() const
 
 bool DataSetHeader::FindNameValParam(const std::wstring& name, ParameterNameValueType& result) const
 {
-	ParameterNameValueType t;
-	t.SetName(name);
-	t.SetValueText(L"");
-	ParameterNameValueTypeConstIt found = FindNameValParam(t);
-	if (found != nameValParams.end())
+	int32_t index = paramNameIdx.Find(nameValParams, name);
+	if (index >= 0)
 	{
-		result = *found;
+		result = nameValParams[index];
 		return true;
 	}
 	return false;
@@ -187,14 +186,8 @@ bool DataSetHeader::FindNameValParam(const std::wstring& name, ParameterNameValu
 
 ParameterNameValueTypeConstIt DataSetHeader::FindNameValParam(const ParameterNameValueType& p) const
 {
-	ParameterNameValueTypeConstIt begin, end;
-	begin = nameValParams.begin();
-	end = nameValParams.end();
-	ParameterNameValueTypeConstIt ii = std::find(begin, end, p);
-	if (ii != end)
-	{
-		return ii;
-	}
-	else
-		return end;
+	int32_t index = paramNameIdx.Find(nameValParams, p.GetName());
+	if (index < 0)
+		return nameValParams.end();
+	return nameValParams.begin() + index;
 }
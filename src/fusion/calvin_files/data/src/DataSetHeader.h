@@ -26,6 +26,7 @@
 
 #include "calvin_files/data/src/ColumnInfo.h"
 #include "calvin_files/data/src/GenericDataHeader.h"
+#include "calvin_files/data/src/ParameterNameIndex.h"
 #include "calvin_files/parameter/src/ParameterNameValueType.h"
 #include "calvin_files/utils/src/AffyStlCollectionTypes.h"
 //
@@ -59,6 +60,8 @@ private:
 	std::wstring name;
 	/*! name/value pairs */
 	ParameterNameValueTypeVector nameValParams;
+	/*! The position of each parameter in nameValParams. */
+	ParameterNameIndex paramNameIdx;
 	/*! column information */
 	ColInfoVector columnTypes;
 	/*! file position of the start of the dataSet header */
@@ -131,7 +131,10 @@ u_int32_t GenericData::DataSetCnt(u_int32_t dataGroupIdx)
 {
 	DataGroupHeader* dch = FindDataGroupHeader(dataGroupIdx);
 	if (dch)
+	{
+		IndexDataSetHeaders(dch);
 		return dch->GetDataSetCnt();
+	}
 	else
 	{
 		affymetrix_calvin_exceptions::DataGroupNotFoundException e(L"Calvin",L"Default Description, Please Update!",affymetrix_calvin_utilities::DateTime::GetCurrentDateTime().ToString(),std::string(__FILE__),(u_int16_t)__LINE__,0);
@@ -146,7 +149,10 @@ u_int32_t GenericData::DataSetCnt(const std::wstring& dataGroupName)
 {
 	DataGroupHeader* dch = FindDataGroupHeader(dataGroupName);
 	if (dch)
+	{
+		IndexDataSetHeaders(dch);
 		return dch->GetDataSetCnt();
+	}
 	else
 	{
 		affymetrix_calvin_exceptions::DataGroupNotFoundException e(L"Calvin",L"Default Description, Please Update!",affymetrix_calvin_utilities::DateTime::GetCurrentDateTime().ToString(),std::string(__FILE__),(u_int16_t)__LINE__,0);
@@ -165,6 +171,7 @@ void GenericData::DataSetNames(u_int32_t dataGroupIdx, std::vector<std::wstring>
 		affymetrix_calvin_exceptions::DataGroupNotFoundException e(L"Calvin",L"Default Description, Please Update!",affymetrix_calvin_utilities::DateTime::GetCurrentDateTime().ToString(),std::string(__FILE__),(u_int16_t)__LINE__,0);
 		throw e;
 	}
+	IndexDataSetHeaders(dch);
 
 	names.clear();
 	DataSetHdrIt begin;
@@ -187,6 +194,7 @@ void GenericData::DataSetNames(const std::wstring& dataGroupName, std::vector<st
 		affymetrix_calvin_exceptions::DataGroupNotFoundException e(L"Calvin",L"Default Description, Please Update!",affymetrix_calvin_utilities::DateTime::GetCurrentDateTime().ToString(),std::string(__FILE__),(u_int16_t)__LINE__,0);
 		throw e;
 	}
+	IndexDataSetHeaders(dch);
 
 	names.clear();
 	DataSetHdrIt begin;
@@ -244,6 +252,8 @@ DataSet* GenericData::DataSet(const std::wstring& dataGroupName, const std::wstr
 	DataGroupHeader* dch = FindDataGroupHeader(dataGroupName);
 	if (dch)
 	{
+		if (FindDataSetHeader(dch, dataSetName) == 0)
+			IndexDataSetHeaders(dch, dataSetName);
 		DataSetHeader* dph = FindDataSetHeader(dch, dataSetName);
 		if (dph)
 		{
@@ -385,6 +395,7 @@ DataSetHeader* GenericData::FindDataSetHeader(DataGroupHeader* dch, u_int32_t da
 	DataSetHeader* dph = 0;
 	if (dch != 0)
 	{
+		IndexDataSetHeaders(dch);
                 // WAS if (dataSetIdx >= 0 && ...) BUT 'dataSetIdx >= 0'
                 // is always true because 'dataSetIdx' is unsigned.
 		if ((int32_t)dataSetIdx < dch->GetDataSetCnt())
@@ -424,6 +435,30 @@ void GenericData::ReadFullDataSetHeader(DataSetHeader* dph)
 	}
 }
 
+/*
+ * Index the DataSetHeaders of a lazily read DataGroup.
+ */
+void GenericData::IndexDataSetHeaders(DataGroupHeader* dch, const std::wstring& dataSetName)
+{
+	if (dch == 0 || dch->GetUnindexedDataSetCnt() == 0)
+		return;
+
+	// Open a file stream
+	std::ifstream fs;
+	std::ifstream* pfs = &fileStream;	// initialize to use GenericData::ifs
+	if (useMemoryMapping || fileStream.is_open() == false)
+	{
+		OpenFStream(fs);
+		pfs = &fs;
+	}
+
+	DataSetHeaderReader reader;
+	reader.ReadUnindexedMinimumInfo(*pfs, *dch, dataSetName);
+
+	if (pfs == &fs)
+		fs.close();
+}
+
 /*
  * Determine if the DataSetHeader has been partially read.
  */
@@ -171,6 +171,14 @@ public:
 	 */
 	void ReadFullDataSetHeader(DataSetHeader* dph);
 
+	/*! Read the minimum DataSetHeader information for a DataGroup that was read lazily
+	 *	(see GenericFileReader::ReadLazyDataGroupHeader).  Has no effect if all the
+	 *	DataSetHeaders of the DataGroup have already been indexed.
+	 *	@param dch Pointer to the DataGroupHeader.
+	 *	@param dataSetName If not empty, indexing stops once the DataSet with this name has been found.
+	 */
+	void IndexDataSetHeaders(DataGroupHeader* dch, const std::wstring& dataSetName = std::wstring());
+
 	/*! Determine if the DataSetHeader has been partially read.
 	 *	@param dph Pointer to the DataSetHeader to check
 	 *	@return true if the dph has only been partially read or is 0, otherwise false.
@@ -194,12 +202,13 @@ public:
 	 */
 	affymetrix_calvin_io::DataGroupHeader* FindDataGroupHeader(int32_t index);
 
-	/*! Finds a DataSetHeader by index.
+	/*! Finds a DataSetHeader by index.  The DataSetHeaders of a lazily read
+	 *	DataGroup are indexed first.
 	 *	@param dch The DataGroupHeader of the DataGroup to which the DataSet belongs.
 	 *	@param dataSetIdx The DataSet index of the DataSetHeader to find.
 	 *	@return A pointer to the DataSetHeader if it is found, otherwise 0.
 	 */
-	static affymetrix_calvin_io::DataSetHeader* FindDataSetHeader(affymetrix_calvin_io::DataGroupHeader* dch, u_int32_t dataSetIdx);
+	affymetrix_calvin_io::DataSetHeader* FindDataSetHeader(affymetrix_calvin_io::DataGroupHeader* dch, u_int32_t dataSetIdx);
 
 	/*!	Finds a DataSetHeader by name.
 	 *	@param dch The DataGroupHeader of the DataGroup to which the DataSet belongs.
@@ -28,7 +28,7 @@
 using namespace affymetrix_calvin_io;
 using namespace affymetrix_calvin_parameter;
 
-GenericDataHeader::GenericDataHeader() 
+GenericDataHeader::GenericDataHeader() : paramNameIdx(false)
 {
 	locale = US_ENGLISH_LOCALE;
 }
@@ -39,7 +39,9 @@ void GenericDataHeader::Clear()
 	fileId.clear();
 	fileCreationTime.clear();
 	nameValParams.clear();
+	paramNameIdx.Clear();
 	GenericDataHdrs.clear();
+	parentTypeIdxMap.clear();
 }
 
 void GenericDataHeader::SetFileTypeId(const std::string &p)
@@ -109,14 +111,14 @@ void GenericDataHeader::AddNameValParam(const ParameterNameValueType &entry, boo
 		}
 		else
 		{
-			paramNameIdxMap[entry.GetName()] =  nameValParams.size();
 			nameValParams.push_back(entry);
+			paramNameIdx.Added(nameValParams);
 		}
 	}
 	else
 	{
-		paramNameIdxMap[entry.GetName()] =  nameValParams.size();
 		nameValParams.push_back(entry);
+		paramNameIdx.Added(nameValParams);
 	}
 }
 
@@ -138,6 +140,7 @@ void GenericDataHeader::GetNameValIterators(ParameterNameValueTypeIt &begin, Par
 
 void GenericDataHeader::AddParent(const GenericDataHeader &hdr)
 {
+	parentTypeIdxMap.insert(std::make_pair(hdr.fileTypeId, (int32_t)GenericDataHdrs.size()));
 	GenericDataHdrs.push_back(hdr);
 }
 
@@ -162,29 +165,18 @@ GenericDataHeader GenericDataHeader::GetParent(int32_t index) const
  */
 GenericDataHeader* GenericDataHeader::FindParent(const std::string& fileTypeId)
 {
-	GenericDataHeader* parentGDH = 0;
-	GenDataHdrVectorIt begin, end;
-	GetParentIterators(begin, end);
-	for (GenDataHdrVectorIt ii = begin; ii != end; ++ii)
-	{
-		if (ii->GetFileTypeId() == fileTypeId)
-		{
-			parentGDH = &(*ii);
-			break;
-		}
-	}
-	return parentGDH;
+	std::unordered_map<std::string, int32_t>::const_iterator found = parentTypeIdxMap.find(fileTypeId);
+	if (found == parentTypeIdxMap.end())
+		return 0;
+	return &GenericDataHdrs[found->second];
 }
 
 bool GenericDataHeader::FindNameValParam(const std::wstring& name, ParameterNameValueType& result)
 {
-	ParameterNameValueType t;
-	t.SetName(name);
-	t.SetValueText(L"");
-	ParameterNameValueTypeIt found = FindNameValParam(t);
-	if (found != nameValParams.end())
+	int32_t index = paramNameIdx.Find(nameValParams, name);
+	if (index >= 0)
 	{
-		result = *found;
+		result = nameValParams[index];
 		return true;
 	}
 	return false;
@@ -192,12 +184,10 @@ bool GenericDataHeader::FindNameValParam(const std::wstring& name, ParameterName
 
 ParameterNameValueTypeIt GenericDataHeader::FindNameValParam(const ParameterNameValueType& p)
 {
-  std::map<std::wstring, int>::const_iterator idx = paramNameIdxMap.find(p.GetName());
-  if (idx == paramNameIdxMap.end()) {
-    return nameValParams.end();
-  }
-  return nameValParams.begin() + idx->second;
-
+	int32_t index = paramNameIdx.Find(nameValParams, p.GetName());
+	if (index < 0)
+		return nameValParams.end();
+	return nameValParams.begin() + index;
 }
 
 bool GenericDataHeader::GetNameValParamsBeginsWith(const std::wstring& beginsWith, ParameterNameValueTypeVector& p)
@@ -21,6 +21,7 @@
 #ifndef _GenericDataHeader_HEADER_
 #define _GenericDataHeader_HEADER_
 
+#include "calvin_files/data/src/ParameterNameIndex.h"
 #include "calvin_files/parameter/src/AffymetrixParameterConsts.h"
 #include "calvin_files/parameter/src/ParameterNameValueType.h"
 #include "calvin_files/portability/src/AffymetrixBaseTypes.h"
@@ -28,8 +29,8 @@
 //
 #include <cstring>
 #include <string>
+#include <unordered_map>
 #include <vector>
-#include <map>
 //
 
 #ifdef _MSC_VER
@@ -62,8 +63,10 @@ private:
 	ParameterNameValueTypeVector nameValParams;
 	/*!  */
 	std::vector<GenericDataHeader> GenericDataHdrs;
-        /*!  */
-        std::map<std::wstring, int> paramNameIdxMap;
+	/*! The position of each parameter in nameValParams; the last of duplicate names is found. */
+	ParameterNameIndex paramNameIdx;
+	/*! The position of the first parent header of each file type id. */
+	std::unordered_map<std::string, int32_t> parentTypeIdxMap;
 
 public:
 
@@ -0,0 +1,108 @@
+////////////////////////////////////////////////////////////////
+//
+// This library is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License
+// (version 2.1) as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+////////////////////////////////////////////////////////////////
+#ifndef _ParameterNameIndex_HEADER_
+#define _ParameterNameIndex_HEADER_
+
+#include "calvin_files/parameter/src/ParameterNameValueType.h"
+#include "calvin_files/portability/src/AffymetrixBaseTypes.h"
+//
+#include <string>
+#include <unordered_map>
+//
+
+namespace affymetrix_calvin_io
+{
+
+/*! A hash index from parameter names to their position in a vector of parameters.
+ *
+ * The index is maintained as parameters are appended, and is only built once
+ * the vector holds more than MinIndexedCount parameters; a linear scan is faster
+ * for the handful of parameters of e.g. a CDF unit. Find() does not modify the
+ * index, so an index may be searched by several threads at once.
+ */
+class ParameterNameIndex
+{
+public:
+	/*! Vectors with at most this many parameters are not indexed. */
+	static const int32_t MinIndexedCount = 8;
+
+	/*! Constructor.
+	 * @param firstWins If a name occurs more than once, find the first (true) or the last (false) occurrence.
+	 */
+	ParameterNameIndex(bool firstWins = true) : firstWins(firstWins) {}
+
+	/*! Removes all entries. */
+	void Clear() { index.clear(); }
+
+	/*! Updates the index after a parameter was appended to the vector.
+	 * @param params The parameters, including the appended one.
+	 */
+	void Added(const affymetrix_calvin_parameter::ParameterNameValueTypeVector &params)
+	{
+		int32_t n = (int32_t)params.size();
+		if (n <= MinIndexedCount)
+			return;
+		if (index.empty())
+		{
+			for (int32_t i=0; i<n; i++)
+				Insert(params[i].GetName(), i);
+		}
+		else
+			Insert(params[n-1].GetName(), n-1);
+	}
+
+	/*! Finds a parameter by name.
+	 * @param params The indexed parameters.
+	 * @param name The name of the parameter.
+	 * @return The position of the parameter, or -1 if not found.
+	 */
+	int32_t Find(const affymetrix_calvin_parameter::ParameterNameValueTypeVector &params, const std::wstring &name) const
+	{
+		if (index.empty())
+		{
+			int32_t n = (int32_t)params.size();
+			for (int32_t i=0; i<n; i++)
+			{
+				int32_t j = (firstWins ? i : n-1-i);
+				if (params[j] == name)
+					return j;
+			}
+			return -1;
+		}
+		std::unordered_map<std::wstring, int32_t>::const_iterator found = index.find(name);
+		return (found == index.end() ? -1 : found->second);
+	}
+
+private:
+	/*! Adds a name to the index. */
+	void Insert(const std::wstring &name, int32_t i)
+	{
+		if (firstWins)
+			index.insert(std::make_pair(name, i));
+		else
+			index[name] = i;
+	}
+
+	/*! Find the first occurrence of duplicate names. */
+	bool firstWins;
+	/*! The position of each parameter name. */
+	std::unordered_map<std::wstring, int32_t> index;
+};
+
+}
+
+#endif // _ParameterNameIndex_HEADER_
@@ -0,0 +1,294 @@
+////////////////////////////////////////////////////////////////
+//
+// This library is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License
+// (version 2.1) as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+////////////////////////////////////////////////////////////////
+
+#include "calvin_files/data/src/ProbeSetNameIndex.h"
+//
+#include "util/MappedFile.h"
+//
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+//
+
+using namespace affymetrix_calvin_io;
+
+/*! The number of indexes kept while not in use. */
+#define PROBE_SET_NAME_INDEX_MAX_UNUSED 4
+
+/*! The number of names read at a time while building an index. */
+#define PROBE_SET_NAME_INDEX_CHUNK 4096
+
+/*! The first word of the key of an index of a data set column. */
+#define PROBE_SET_NAME_INDEX_KEY_DATA_SET 1
+
+/*! The first word of the key of an index of the names of a file. */
+#define PROBE_SET_NAME_INDEX_KEY_FILE 2
+
+namespace affymetrix_calvin_io
+{
+
+/*! The indexes in use or kept for later, keyed on data set layout. */
+class ProbeSetNameIndexRegistry
+{
+public:
+	static std::mutex& lock()
+	{
+		static std::mutex mtx;
+		return mtx;
+	}
+	/*! The indexes; those not in use are deleted at exit. */
+	class Indexes : public std::vector<ProbeSetNameIndex*>
+	{
+	public:
+		~Indexes()
+		{
+			for (size_t i=0; i<size(); i++)
+			{
+				if ((*this)[i]->refCount == 0)
+					delete (*this)[i];
+			}
+		}
+	};
+	static std::vector<ProbeSetNameIndex*>& indexes()
+	{
+		static Indexes vec;
+		return vec;
+	}
+	static u_int64_t& releases()
+	{
+		static u_int64_t n = 0;
+		return n;
+	}
+	/*! Finds an index by key and takes a reference to it. Call with the lock held. */
+	static ProbeSetNameIndex* find(const u_int64_t key[5])
+	{
+		std::vector<ProbeSetNameIndex*>& vec = indexes();
+		for (size_t i=0; i<vec.size(); i++)
+		{
+			if (memcmp(vec[i]->key, key, sizeof(vec[i]->key)) == 0)
+			{
+				vec[i]->refCount++;
+				return vec[i];
+			}
+		}
+		return NULL;
+	}
+};
+
+/*! Reads the names from a column of a data set. */
+class DataSetNameSource : public ProbeSetNameSource
+{
+public:
+	DataSetNameSource(DataSet* ds, int32_t col) : ds(ds), col(col) {}
+
+	int32_t GetCount() { return ds->Rows(); }
+
+	void GetNames(int32_t first, int32_t count, std::vector<std::string> &names)
+	{
+		names.resize(count);
+		names.resize(ds->GetDataRaw(col, first, count, &names[0]));
+	}
+
+private:
+	DataSet* ds;
+	int32_t col;
+};
+
+}
+
+/*
+ * Get the shared index of a name column, building it if needed.
+ */
+ProbeSetNameIndex* ProbeSetNameIndex::acquire(DataSet* ds, int32_t col)
+{
+	u_int64_t key[5];
+	key[0] = PROBE_SET_NAME_INDEX_KEY_DATA_SET;
+	key[1] = (u_int64_t) ds->Rows();
+	key[2] = (u_int64_t) ds->Header().GetColumnInfo(col).GetSize();
+	key[3] = ds->GetColumnChecksum(col);
+	key[4] = 0;
+	DataSetNameSource source(ds, col);
+	return acquire(key, source);
+}
+
+/*
+ * Get the shared index of the names of a file, building it if needed.
+ */
+ProbeSetNameIndex* ProbeSetNameIndex::acquire(const std::string &fileName, ProbeSetNameSource &source)
+{
+	uint64_t identity[4];
+	if (MappedFile::identify(fileName, identity) == false)
+		return NULL;
+	u_int64_t key[5];
+	key[0] = PROBE_SET_NAME_INDEX_KEY_FILE;
+	for (int i=0; i<4; i++)
+		key[i+1] = identity[i];
+	return acquire(key, source);
+}
+
+/*
+ * Get a shared index by key, building it from the source if needed.
+ */
+ProbeSetNameIndex* ProbeSetNameIndex::acquire(const u_int64_t key[5], ProbeSetNameSource &source)
+{
+	{
+		std::lock_guard<std::mutex> guard(ProbeSetNameIndexRegistry::lock());
+		ProbeSetNameIndex* index = ProbeSetNameIndexRegistry::find(key);
+		if (index != NULL)
+			return index;
+	}
+
+	// Build outside of the lock; another thread may build the same index meanwhile.
+	int32_t count = source.GetCount();
+	if (count < 0)
+		return NULL;
+	// The names of a file map to their first unit, as match() does in R.
+	bool firstWins = (key[0] == PROBE_SET_NAME_INDEX_KEY_FILE);
+	ProbeSetNameIndex* index = new ProbeSetNameIndex(count, source, firstWins);
+	memcpy(index->key, key, sizeof(index->key));
+
+	std::lock_guard<std::mutex> guard(ProbeSetNameIndexRegistry::lock());
+	ProbeSetNameIndex* other = ProbeSetNameIndexRegistry::find(key);
+	if (other != NULL)
+	{
+		delete index;
+		return other;
+	}
+	index->refCount = 1;
+	ProbeSetNameIndexRegistry::indexes().push_back(index);
+	return index;
+}
+
+/*
+ * Take another reference.
+ */
+ProbeSetNameIndex* ProbeSetNameIndex::retain(ProbeSetNameIndex* index)
+{
+	if (index == NULL)
+		return NULL;
+	std::lock_guard<std::mutex> guard(ProbeSetNameIndexRegistry::lock());
+	index->refCount++;
+	return index;
+}
+
+/*
+ * Drop a reference, and delete the least recently used indexes not in use
+ * when there are too many.
+ */
+void ProbeSetNameIndex::release(ProbeSetNameIndex* index)
+{
+	if (index == NULL)
+		return;
+	std::lock_guard<std::mutex> guard(ProbeSetNameIndexRegistry::lock());
+	index->refCount--;
+	index->lastUsed = ++ProbeSetNameIndexRegistry::releases();
+
+	std::vector<ProbeSetNameIndex*>& vec = ProbeSetNameIndexRegistry::indexes();
+	while (true)
+	{
+		int unused = 0;
+		int oldest = -1;
+		for (int i=0; i<(int)vec.size(); i++)
+		{
+			if (vec[i]->refCount > 0)
+				continue;
+			unused++;
+			if (oldest < 0 || vec[i]->lastUsed < vec[oldest]->lastUsed)
+				oldest = i;
+		}
+		if (unused <= PROBE_SET_NAME_INDEX_MAX_UNUSED)
+			break;
+		delete vec[oldest];
+		vec.erase(vec.begin() + oldest);
+	}
+}
+
+/*
+ * Read the names and hash them into the table.
+ */
+ProbeSetNameIndex::ProbeSetNameIndex(int32_t count, ProbeSetNameSource &source, bool firstWins) : count(count), refCount(0), lastUsed(0)
+{
+	memset(key, 0, sizeof(key));
+	offsets.assign(count+1, 0);
+
+	std::vector<std::string> chunk;
+	for (int32_t row=0; row<count; row+=PROBE_SET_NAME_INDEX_CHUNK)
+	{
+		int32_t n = std::min(count-row, PROBE_SET_NAME_INDEX_CHUNK);
+		source.GetNames(row, n, chunk);
+		for (int32_t i=0; i<n; i++)
+		{
+			// rows the source could not read are left empty.
+			if (i < (int32_t) chunk.size())
+				names.insert(names.end(), chunk[i].begin(), chunk[i].end());
+			offsets[row+i+1] = (u_int32_t) names.size();
+		}
+	}
+
+	size_t size = 16;
+	while (size < 2*(size_t)count)
+		size *= 2;
+	slots.assign(size, -1);
+	size_t mask = size-1;
+	const char* base = names.data();
+	for (int32_t row=0; row<count; row++)
+	{
+		const char* name = base + offsets[row];
+		size_t len = offsets[row+1] - offsets[row];
+		size_t slot = (size_t) Hash(name, len) & mask;
+		while (slots[slot] >= 0)
+		{
+			int32_t other = slots[slot];
+			if (offsets[other+1] - offsets[other] == len && memcmp(base + offsets[other], name, len) == 0)
+				break;
+			slot = (slot+1) & mask;
+		}
+		if (slots[slot] < 0 || firstWins == false)
+			slots[slot] = row;
+	}
+}
+
+/*
+ * Look up a name by probing from its hash.
+ */
+int32_t ProbeSetNameIndex::Find(const char* name, size_t len) const
+{
+	size_t mask = slots.size()-1;
+	size_t slot = (size_t) Hash(name, len) & mask;
+	while (slots[slot] >= 0)
+	{
+		int32_t row = slots[slot];
+		if (offsets[row+1] - offsets[row] == len && memcmp(names.data() + offsets[row], name, len) == 0)
+			return row;
+		slot = (slot+1) & mask;
+	}
+	return -1;
+}
+
+/*
+ * FNV-1a.
+ */
+u_int64_t ProbeSetNameIndex::Hash(const char* name, size_t len)
+{
+	u_int64_t h = 14695981039346656037ULL;
+	for (size_t i=0; i<len; i++)
+	{
+		h ^= (unsigned char) name[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
@@ -0,0 +1,152 @@
+////////////////////////////////////////////////////////////////
+//
+// This library is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License
+// (version 2.1) as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+////////////////////////////////////////////////////////////////
+#ifndef _ProbeSetNameIndex_HEADER_
+#define _ProbeSetNameIndex_HEADER_
+
+#include "calvin_files/data/src/DataSet.h"
+#include "calvin_files/portability/src/AffymetrixBaseTypes.h"
+//
+#include <string>
+#include <vector>
+//
+
+namespace affymetrix_calvin_io
+{
+
+/*! Supplies the names of a ProbeSetNameIndex while it is built. */
+class ProbeSetNameSource
+{
+public:
+	/*! Destructor. */
+	virtual ~ProbeSetNameSource() {}
+
+	/*! Gets the number of names.
+	 * @return The number of names, or -1 if they can not be read.
+	 */
+	virtual int32_t GetCount() = 0;
+
+	/*! Gets a range of names.
+	 * @param first The first row.
+	 * @param count The number of rows.
+	 * @param names Receives the names.
+	 */
+	virtual void GetNames(int32_t first, int32_t count, std::vector<std::string> &names) = 0;
+};
+
+/*! An open addressing hash index from probe set names to their row, e.g. the
+ * names in an ASCII column of a data set or the unit names of a CDF file.
+ *
+ * Indexes are shared: acquire() first computes a checksum of the raw bytes of
+ * the name column, and returns the existing index of any data set with the same
+ * checksum, row count and column width. CHP files of the same layout, e.g. the
+ * genotype calls of many samples of one array type, therefore only have their
+ * names parsed and hashed once. Indexes of the names of a file are instead keyed
+ * on the identity of the file, so the names are not read again until the file is
+ * modified. A few indexes no longer in use are kept for files read later in the
+ * session.
+ *
+ * A name that occurs more than once maps to its first row in the index of a
+ * file, as match() does in R, and to its last row in the index of a data set.
+ */
+class ProbeSetNameIndex
+{
+public:
+	/*! Gets the index of a name column.
+	 * @param ds The data set.
+	 * @param col The index of an ASCII column holding the names.
+	 * @return The index, to be returned with release().
+	 */
+	static ProbeSetNameIndex* acquire(DataSet* ds, int32_t col);
+
+	/*! Gets the index of the names of a file.
+	 * @param fileName The file.
+	 * @param source Reads the names if the file has not been indexed before.
+	 * @return The index, to be returned with release(), or NULL if the file
+	 * can not be opened or the source fails.
+	 */
+	static ProbeSetNameIndex* acquire(const std::string &fileName, ProbeSetNameSource &source);
+
+	/*! Takes another reference to an index, e.g. to keep using it after the
+	 * data set it was acquired for was closed.
+	 * @param index The index; NULL is ignored.
+	 * @return The index, to be returned with release().
+	 */
+	static ProbeSetNameIndex* retain(ProbeSetNameIndex* index);
+
+	/*! Drops an index obtained with acquire() or retain().
+	 * @param index The index; NULL is ignored.
+	 */
+	static void release(ProbeSetNameIndex* index);
+
+	/*! Finds a name.
+	 * @param name The probe set name.
+	 * @return The row of the name, or -1 if not found.
+	 */
+	int32_t Find(const std::string& name) const { return Find(name.c_str(), name.size()); }
+
+	/*! Finds a name.
+	 * @param name The probe set name, not necessarily null terminated.
+	 * @param len The length of the name.
+	 * @return The row of the name, or -1 if not found.
+	 */
+	int32_t Find(const char* name, size_t len) const;
+
+	/*! The number of indexed rows. */
+	int32_t GetCount() const { return count; }
+
+private:
+	/*! Builds the index.
+	 * @param count The number of names.
+	 * @param source Supplies the names.
+	 * @param firstWins If a name occurs more than once, find the first (true) or the last (false) row.
+	 */
+	ProbeSetNameIndex(int32_t count, ProbeSetNameSource &source, bool firstWins);
+
+	/*! Gets a shared index by key, building it from the source if there is none.
+	 * @param key The kind of key, followed by the key.
+	 * @param source Supplies the names.
+	 * @return The index, or NULL if the source fails.
+	 */
+	static ProbeSetNameIndex* acquire(const u_int64_t key[5], ProbeSetNameSource &source);
+
+	/*! Hashes a name. */
+	static u_int64_t Hash(const char* name, size_t len);
+
+	/*! Data set layout: row count, column width and checksum of the column;
+	 * or file identity: device, inode, size and modification time.
+	 * The first word tells which.
+	 */
+	u_int64_t key[5];
+	/*! The number of rows. */
+	int32_t count;
+	/*! The names, one after the other. */
+	std::vector<char> names;
+	/*! The start of each name in names, and the end of the last one. */
+	std::vector<u_int32_t> offsets;
+	/*! The hash table of rows, -1 for an empty slot. Its size is a power of two. */
+	std::vector<int32_t> slots;
+	/*! References held by readers (guarded by the registry lock). */
+	int refCount;
+	/*! The release() at which the index was last dropped. */
+	u_int64_t lastUsed;
+
+	friend class ProbeSetNameIndexRegistry;
+};
+
+}
+
+#endif // _ProbeSetNameIndex_HEADER_
@@ -469,6 +469,14 @@ float CalvinCELDataAdapter::GetStdv(int x, int y)
 	return v.at(0);
 }
 
+/*
+ */
+int CalvinCELDataAdapter::GetStdvs(int index,std::vector<float>& stdvs)
+{
+	// Pass the vector along to get filled.
+	return calvinCel.GetStdev(index, stdvs.size(), stdvs) ? 0 : 1;
+}
+
 /*
  */
 short CalvinCELDataAdapter::GetPixels(int index)
@@ -488,6 +496,14 @@ short CalvinCELDataAdapter::GetPixels(int x, int y)
 	return v.at(0);
 }
 
+/*
+ */
+int CalvinCELDataAdapter::GetPixels(int index,std::vector<short>& pixels)
+{
+	// Pass the vector along to get filled.
+	return calvinCel.GetNumPixels(index, pixels.size(), pixels) ? 0 : 1;
+}
+
 // Accessors for the mask/outlier flags
 /*
  */
@@ -219,6 +219,12 @@ public:
 	 *	\return The standard deviation value.
 	 */
 	virtual float GetStdv(int x, int y);
+	/*! @brief   Get a vector of standard deviations.
+	 *	@param   index        Index of first value
+	 *  @param   stdvs        vector of values to fill
+	 *	@return  non-zero on error.
+	 */
+	virtual int GetStdvs(int index,std::vector<float>& stdvs);
 	/*! \brief Get pixel by index position.
 	 *	\param index Location of pixel.
 	 *	\return The pixel value.
@@ -230,6 +236,12 @@ public:
 	 *	\return The pixel value.
 	 */
 	virtual short GetPixels(int x, int y);
+	/*! @brief   Get a vector of pixel counts.
+	 *	@param   index        Index of first value
+	 *  @param   pixels       vector of values to fill
+	 *	@return  non-zero on error.
+	 */
+	virtual int GetPixels(int index,std::vector<short>& pixels);
 
 	// Accessors for the mask/outlier flags
 	/*! \brief Get masked x, y position.
@@ -387,6 +387,54 @@ bool CalvinCHPDataAdapter::GetUniversalResults(int index, FusionUniversalProbeSe
 	return false;
 }
 
+/*! Copies a block of expression probe set results
+* @param first The index of the first result to copy.
+* @param count The number of results to copy.
+* @param results The array to copy to, holding at least count elements.
+* @return True if all results were copied.
+*/
+bool CalvinCHPDataAdapter::GetExpressionResults(int first, int count, FusionExpressionProbeSetResults* results)
+{
+	if (calvinChp.GetAssayType() != CHP_EXPRESSION_ASSAY_TYPE ||
+		first < 0 || count < 0 || first > calvinChp.GetEntryCount() - count)
+		return false;
+	for (int i=0; i<count; i++)
+		GetExpressionResults(first+i, results[i]);
+	return true;
+}
+
+/*! Copies a block of genotyping probe set results
+* @param first The index of the first result to copy.
+* @param count The number of results to copy.
+* @param results The array to copy to, holding at least count elements.
+* @return True if all results were copied.
+*/
+bool CalvinCHPDataAdapter::GetGenotypingResults(int first, int count, FusionGenotypeProbeSetResults* results)
+{
+	if (calvinChp.GetAssayType() != CHP_GENOTYPING_ASSAY_TYPE ||
+		first < 0 || count < 0 || first > calvinChp.GetEntryCount() - count)
+		return false;
+	for (int i=0; i<count; i++)
+		GetGenotypingResults(first+i, results[i]);
+	return true;
+}
+
+/*! Copies a block of universal (tag array) probe set results
+* @param first The index of the first result to copy.
+* @param count The number of results to copy.
+* @param results The array to copy to, holding at least count elements.
+* @return True if all results were copied.
+*/
+bool CalvinCHPDataAdapter::GetUniversalResults(int first, int count, FusionUniversalProbeSetResults* results)
+{
+	if (calvinChp.GetAssayType() != CHP_UNIVERSAL_ASSAY_TYPE ||
+		first < 0 || count < 0 || first > calvinChp.GetEntryCount() - count)
+		return false;
+	for (int i=0; i<count; i++)
+		GetUniversalResults(first+i, results[i]);
+	return true;
+}
+
 bool CalvinCHPDataAdapter::GetResequencingResults(FusionResequencingResults& results)
 {
 	if(calvinChp.GetAssayType() == CHP_RESEQUENCING_ASSAY_TYPE)
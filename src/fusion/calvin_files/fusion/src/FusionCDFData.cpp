@@ -1057,6 +1057,8 @@ FusionCDFData::FusionCDFData()
 {
 	gcosData = NULL;
 	calvinData = NULL;
+	numThreads = 1;
+	nameIndex = NULL;
 }
 
 /*
@@ -1065,6 +1067,7 @@ FusionCDFData::FusionCDFData()
 FusionCDFData::~FusionCDFData()
 {
 	Close();
+	ProbeSetNameIndex::release(nameIndex);
 }
 
 /*
@@ -1156,6 +1159,85 @@ std::string FusionCDFData::GetProbeSetName(int index) const
 		return std::string("");
 }
 
+/*
+ * Get the names of a range of probe sets.
+ */
+void FusionCDFData::GetProbeSetNames(int first, int count, std::vector<std::string> &names) const
+{
+	if (gcosData)
+		gcosData->GetProbeSetNames(first, count, names);
+	else if (calvinData)
+	{
+		names.resize(count);
+		for (int i=0; i<count; i++)
+			names[i] = StringUtils::ConvertWCSToMBS(calvinData->GetProbeSetName(first+i));
+	}
+	else
+		names.clear();
+}
+
+namespace affymetrix_fusion_io
+{
+
+/*! Reads the probe set names of a CDF file for its name index. The file is read
+ * with its own object, so the state of the reader asking for the index is kept.
+ */
+class FusionCDFNameSource : public ProbeSetNameSource
+{
+public:
+	FusionCDFNameSource(const std::string &fileName, int numThreads)
+	{
+		cdf.SetFileName(fileName.c_str());
+		cdf.SetNumThreads(numThreads);
+	}
+
+	int32_t GetCount()
+	{
+		if (cdf.Read() == false)
+			return -1;
+		return cdf.GetHeader().GetNumProbeSets();
+	}
+
+	void GetNames(int32_t first, int32_t count, std::vector<std::string> &names)
+	{
+		cdf.GetProbeSetNames(first, count, names);
+	}
+
+private:
+	FusionCDFData cdf;
+};
+
+}
+
+/*
+ * Get the shared probe set name index, acquiring it on first use.
+ */
+ProbeSetNameIndex *FusionCDFData::GetProbeSetNameIndex()
+{
+	if (nameIndex == NULL)
+	{
+		FusionCDFNameSource source(fileName, numThreads);
+		try
+		{
+			nameIndex = ProbeSetNameIndex::acquire(fileName, source);
+		}
+		catch(...)
+		{
+			nameIndex = NULL;
+		}
+	}
+	return nameIndex;
+}
+
+/*
+ * Find a probe set by name.
+ */
+int FusionCDFData::FindProbeSet(const std::string &name)
+{
+	ProbeSetNameIndex *index = GetProbeSetNameIndex();
+	return (index == NULL ? -1 : index->Find(name));
+}
+
 /*
  * Get the chip type (probe array type) of the CDF file.
  * This is the name of the file without extension for CDF XDA format version < 4.
@@ -1236,6 +1318,7 @@ bool FusionCDFData::Read()
 	if (gcosData)
 	{
 		gcosData->SetFileName(fileName.c_str());
+		gcosData->SetNumThreads(numThreads);
 		return gcosData->Read();
 	}
 	else
@@ -29,6 +29,7 @@
 #include "calvin_files/data/src/CDFProbeInformation.h"
 #include "calvin_files/data/src/CDFQCProbeInformation.h"
 #include "calvin_files/data/src/CDFQCProbeSetInformation.h"
+#include "calvin_files/data/src/ProbeSetNameIndex.h"
 //
 #include "file/CDFFileData.h"
 //
@@ -498,6 +499,12 @@ protected:
 	/*! The name of the file to read. */
 	std::string fileName;
 
+	/*! The number of threads used to parse text format files. */
+	int numThreads;
+
+	/*! The probe set name index, NULL until used. */
+	affymetrix_calvin_io::ProbeSetNameIndex *nameIndex;
+
 	/*! Creates either the GCOS or Calvin parser object. */
 	void CreateObject();
 
@@ -518,6 +525,11 @@ public:
 	 */
 	std::string GetFileName() const;
 
+	/*! Sets the number of threads used to parse the units of GCOS text format files.
+	 * @param n The number of threads, at least 1.
+	 */
+	void SetNumThreads(int n) { numThreads = (n < 1 ? 1 : n); }
+
 	/*! Gets the header object.
 	 * @return The CDF file header object.
 	 */
@@ -544,6 +556,29 @@ public:
 	 */
 	std::string GetProbeSetName(int index) const;
 
+	/*! Gets the names of a range of probe sets.
+	 * @param first The index of the first probe set.
+	 * @param count The number of probe sets.
+	 * @param names Receives the probe set names.
+	 */
+	void GetProbeSetNames(int first, int count, std::vector<std::string> &names) const;
+
+	/*! Finds a probe set by name. The names are hashed on first use.
+	 * @param name The probe set name.
+	 * @return The index of the (first) probe set of that name, or -1 if not found or the
+	 * file can not be read.
+	 */
+	int FindProbeSet(const std::string &name);
+
+	/*! Gets the probe set name index used by FindProbeSet. The index is keyed on the
+	 * identity of the file and shared with other readers of it; it is kept for a while
+	 * after it is released, so the names of a file indexed before are not read again.
+	 * The file does not need to be read first.
+	 * @return The index, or NULL if the file can not be read. It is released with this
+	 * object; use ProbeSetNameIndex::retain to keep it longer.
+	 */
+	affymetrix_calvin_io::ProbeSetNameIndex *GetProbeSetNameIndex();
+
 	/*! Gets the chip type (probe array type) of the CDF file.
 	 * @return The chip type. This is just the name (without extension) of the CDF file.
 	 */
@@ -418,6 +418,15 @@ float FusionCELData::GetStdv(int x, int y)
 	return adapter->GetStdv(x, y);
 }
 
+/*
+ * Retrieve a vector of CEL file stdv values.
+ */
+int FusionCELData::GetStdvs(int index,std::vector<float>& stdvs)
+{
+	CheckAdapter();
+	return adapter->GetStdvs(index,stdvs);
+}
+
 /*
  * Retrieve a CEL file pixel count.
  */
@@ -436,6 +445,15 @@ short FusionCELData::GetPixels(int x, int y)
 	return adapter->GetPixels(x, y);
 }
 
+/*
+ * Retrieve a vector of CEL file pixel counts.
+ */
+int FusionCELData::GetPixels(int index,std::vector<short>& pixels)
+{
+	CheckAdapter();
+	return adapter->GetPixels(index,pixels);
+}
+
 // Accessors for the mask/outlier flags
 /*
  * Retrieve a CEL file mask flag.
@@ -259,6 +259,11 @@ public:
 	 */
 	float GetStdv(int x, int y);
 
+  /// @brief     Get a vector of stdv values.
+  /// @param     index         The index of where to start.
+  /// @param     stdvs         The vector to fill, its size is the number of values.
+	int GetStdvs(int index,std::vector<float>& stdvs);
+
 	/*! Retrieve a CEL file pixel count.
 	 * @param index The index to the CEL file entries.
 	 * @return The CEL file pixel count.
@@ -272,6 +277,11 @@ public:
 	 */
 	short GetPixels(int x, int y);
 
+  /// @brief     Get a vector of pixel counts.
+  /// @param     index         The index of where to start.
+  /// @param     pixels        The vector to fill, its size is the number of values.
+	int GetPixels(int index,std::vector<short>& pixels);
+
 	// Accessors for the mask/outlier flags
 	/*! Retrieve a CEL file mask flag.
 	 * @param x The X coordinate.
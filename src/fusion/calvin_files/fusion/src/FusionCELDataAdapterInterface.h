@@ -236,6 +236,12 @@ public:
 	 *	\return The standard deviation value.
 	 */
 	virtual float GetStdv(int x, int y) = 0;
+	/*! @brief  Get a vector of standard deviations.
+	 *	@param    index       index of the first value.
+	 *	@param    stdvs       vector to fill, its size is the count.
+	 *	@return   non-zero on error.
+	 */
+	virtual int GetStdvs(int index, std::vector<float>& stdvs) = 0;
 	/*! \brief Get pixel by index position.
 	 *	\param index Location of pixel.
 	 *	\return The pixel value.
@@ -247,6 +253,12 @@ public:
 	 *	\return The pixel value.
 	 */
 	virtual short GetPixels(int x, int y) = 0;
+	/*! @brief  Get a vector of pixel counts.
+	 *	@param    index       index of the first value.
+	 *	@param    pixels      vector to fill, its size is the count.
+	 *	@return   non-zero on error.
+	 */
+	virtual int GetPixels(int index, std::vector<short>& pixels) = 0;
 
 	// Accessors for the mask/outlier flags
 	/*! \brief Get masked x, y position.
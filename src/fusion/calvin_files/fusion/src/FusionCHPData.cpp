@@ -104,7 +104,8 @@ bool ReadGuidFromFile(const std::string &fileName, AffymetrixGuidType &guid)
 	try
 	{
 		reader.SetFilename(fileName);
-		reader.ReadHeader(data);
+		// Only the file type identifier is needed; skip the data group and data set headers.
+		reader.ReadHeader(data, GenericFileReader::ReadNoDataGroupHeader);
 		guid = data.Header().GetGenericDataHdr()->GetFileTypeId();
 		return true;
 	}
@@ -218,6 +218,30 @@ public:
 	 */
 	virtual bool GetUniversalResults(int index, affymetrix_fusion_io::FusionUniversalProbeSetResults& results) = 0;
 
+	/*! \brief Copies a block of expression probe set results
+	 *	\param first Index of the first result to copy.
+	 *	\param count Number of results to copy.
+	 *	\param results Array to copy to, holding at least count elements.
+	 *	\return True if all results were copied.
+	 */
+	virtual bool GetExpressionResults(int first, int count, affymetrix_fusion_io::FusionExpressionProbeSetResults* results) = 0;
+
+	/*! \brief Copies a block of genotyping probe set results
+	 *	\param first Index of the first result to copy.
+	 *	\param count Number of results to copy.
+	 *	\param results Array to copy to, holding at least count elements.
+	 *	\return True if all results were copied.
+	 */
+	virtual bool GetGenotypingResults(int first, int count, affymetrix_fusion_io::FusionGenotypeProbeSetResults* results) = 0;
+
+	/*! \brief Copies a block of universal (tag array) probe set results
+	 *	\param first Index of the first result to copy.
+	 *	\param count Number of results to copy.
+	 *	\param results Array to copy to, holding at least count elements.
+	 *	\return True if all results were copied.
+	 */
+	virtual bool GetUniversalResults(int first, int count, affymetrix_fusion_io::FusionUniversalProbeSetResults* results) = 0;
+
 	/*! \brief Gets resequencing results.
 	 *	\param results Hold the resequencing results.
 	 *	\return True if resequencing results were retrieved.
@@ -294,6 +294,24 @@ bool FusionCHPLegacyData::GetUniversalResults(int index, FusionUniversalProbeSet
 	return adapter->GetUniversalResults(index, result);
 }
 
+bool FusionCHPLegacyData::GetExpressionResults(int first, int count, FusionExpressionProbeSetResults* results)
+{
+	CheckAdapter();
+	return adapter->GetExpressionResults(first, count, results);
+}
+
+bool FusionCHPLegacyData::GetGenotypingResults(int first, int count, FusionGenotypeProbeSetResults* results)
+{
+	CheckAdapter();
+	return adapter->GetGenotypingResults(first, count, results);
+}
+
+bool FusionCHPLegacyData::GetUniversalResults(int first, int count, FusionUniversalProbeSetResults* results)
+{
+	CheckAdapter();
+	return adapter->GetUniversalResults(first, count, results);
+}
+
 bool FusionCHPLegacyData::GetReseqResults(FusionResequencingResults &results)
 {
 	CheckAdapter();
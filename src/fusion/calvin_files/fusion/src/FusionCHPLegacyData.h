@@ -224,6 +224,30 @@ public:
 	 */
 	bool GetUniversalResults(int index, FusionUniversalProbeSetResults& result);
 
+	/*! Copies a block of expression probe set results
+	 * @param first The index of the first result to copy.
+	 * @param count The number of results to copy.
+	 * @param results The array to copy to, holding at least count elements.
+	 * @return True if all results were copied.
+	 */
+	bool GetExpressionResults(int first, int count, FusionExpressionProbeSetResults* results);
+
+	/*! Copies a block of genotyping probe set results
+	 * @param first The index of the first result to copy.
+	 * @param count The number of results to copy.
+	 * @param results The array to copy to, holding at least count elements.
+	 * @return True if all results were copied.
+	 */
+	bool GetGenotypingResults(int first, int count, FusionGenotypeProbeSetResults* results);
+
+	/*! Copies a block of universal (tag array) probe set results
+	 * @param first The index of the first result to copy.
+	 * @param count The number of results to copy.
+	 * @param results The array to copy to, holding at least count elements.
+	 * @return True if all results were copied.
+	 */
+	bool GetUniversalResults(int first, int count, FusionUniversalProbeSetResults* results);
+
 	/*! Returns the resequencing results.
 	 * @param results The results.
 	 * @return True if the reseq result was found.
@@ -29,16 +29,30 @@ using namespace std;
 
 FusionCHPMultiDataAccessor::FusionCHPMultiDataAccessor()
 {
+    snpNameIndex = NULL;
 }
 
 FusionCHPMultiDataAccessor::~FusionCHPMultiDataAccessor()
 {
+    ProbeSetNameIndex::release(snpNameIndex);
+}
+
+/*
+ * Look up the rows of the SNPs in a name index.
+ */
+static void FindSnps(const ProbeSetNameIndex *index, const vector<string> &snps, vector<int> &snpIndicies)
+{
+    int nsnps = (int)snps.size();
+    snpIndicies.resize(nsnps);
+    for (int isnp=0; isnp<nsnps; isnp++)
+        snpIndicies[isnp] = (index == NULL ? -1 : index->Find(snps[isnp]));
 }
 
 bool FusionCHPMultiDataAccessor::Initialize(const vector<string> &chps)
 {
-    // Clear the map
-    snpNameIndexMap.clear();
+    // Clear the index
+    ProbeSetNameIndex::release(snpNameIndex);
+    snpNameIndex = NULL;
 
     // Store the chp file names.
     chpFileNames = chps;
@@ -56,10 +70,9 @@ bool FusionCHPMultiDataAccessor::Initialize(const vector<string> &chps)
         return false;
     }
 
-    // Extract the probe set names
-    int n = mchp->GetEntryCount(GenotypeMultiDataType);
-    for (int i=0; i<n; i++)
-        snpNameIndexMap[mchp->GetProbeSetName(GenotypeMultiDataType, i)] = i;
+    // Index the probe set names. The index is shared with the other CHP
+    // files if they have the same probe sets in the same order.
+    snpNameIndex = ProbeSetNameIndex::retain(mchp->GetProbeSetNameIndex(GenotypeMultiDataType));
 
     // Close the file and return
     delete mchp;
@@ -72,14 +85,13 @@ void FusionCHPMultiDataAccessor::ExtractData(const vector<string> &snps, vector<
     calls.resize(nchps);
     confidences.resize(nchps);
 
-    // Create a vector of CHP file indicies given the SNP names. This is
-    // done to reduce the number of lookups in the map object.
+    // Create a vector of CHP file indicies given the SNP names. The rows
+    // are only looked up again for files with other probe sets than the
+    // first file.
     int nsnps = (int)snps.size();
-    vector<int> snpIndicies(nsnps);
-    for (int isnp=0; isnp<nsnps; isnp++)
-    {
-        snpIndicies[isnp] = snpNameIndexMap[snps[isnp]];
-    }
+    vector<int> snpIndicies;
+    FindSnps(snpNameIndex, snps, snpIndicies);
+    vector<int> fileIndicies;
 
     // Loop over the chp files and extract the snp data
     FusionCHPData *chp = NULL;
@@ -99,13 +111,29 @@ void FusionCHPMultiDataAccessor::ExtractData(const vector<string> &snps, vector<
             continue;
         }
 
+        // Find the rows of the SNPs
+        const vector<int> *rows = &snpIndicies;
+        ProbeSetNameIndex *index = mchp->GetProbeSetNameIndex(GenotypeMultiDataType);
+        if (index != snpNameIndex)
+        {
+            FindSnps(index, snps, fileIndicies);
+            rows = &fileIndicies;
+        }
+
         // Extract the data
         calls[ichp].resize(nsnps);
         confidences[ichp].resize(nsnps);
         for (int isnp=0; isnp<nsnps; isnp++)
         {
-            calls[ichp][isnp] = mchp->GetGenoCall(GenotypeMultiDataType, snpIndicies[isnp]);
-            confidences[ichp][isnp] = mchp->GetGenoConfidence(GenotypeMultiDataType, snpIndicies[isnp]);
+            int row = (*rows)[isnp];
+            if (row < 0)
+            {
+                calls[ichp][isnp] = SNP_NO_CALL;
+                confidences[ichp][isnp] = 0.0f;
+                continue;
+            }
+            calls[ichp][isnp] = mchp->GetGenoCall(GenotypeMultiDataType, row);
+            confidences[ichp][isnp] = mchp->GetGenoConfidence(GenotypeMultiDataType, row);
         }
 
         // Close the file
@@ -20,10 +20,10 @@
 #ifndef _FusionCHPMultiDataAccessor_HEADER_
 #define _FusionCHPMultiDataAccessor_HEADER_
 
+#include <calvin_files/data/src/ProbeSetNameIndex.h>
 #include <calvin_files/portability/src/AffymetrixBaseTypes.h>
 //
 #include <cstring>
-#include <map>
 #include <string>
 #include <vector>
 //
@@ -38,8 +38,8 @@ private:
     /*! The list of CHP file names to extract the data from. */
     std::vector<std::string> chpFileNames;
 
-    /*! A map of SNP name to CHP file index. */
-    std::map<std::string, int> snpNameIndexMap;
+    /*! The probe set name index of the first CHP file. */
+    affymetrix_calvin_io::ProbeSetNameIndex *snpNameIndex;
 
 public:
     /*! Constructor
@@ -54,7 +54,8 @@ public:
      */
     bool Initialize(const std::vector<std::string> &chps);
 
-    /*! Extract the calls and confidences for each input SNP.
+    /*! Extract the calls and confidences for each input SNP. SNPs that are
+     * not in a CHP file get a no call with zero confidence.
      * @param snps The list of snps to extract data for.
      * @param calls A matrix to hold the calls.
      * @param confidences A matrix to hold the confidence values.
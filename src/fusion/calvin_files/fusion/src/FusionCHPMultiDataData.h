@@ -266,6 +266,19 @@ public:
 	 */
     std::string GetProbeSetName(affymetrix_calvin_io::MultiDataType dataType, int index) { return chpData.GetProbeSetName(dataType, index); }
 
+	/*! Finds a probe set by name.
+     * @param dataType The data type
+	 * @param name The probe set name.
+	 * @return The row index, or -1 if not found.
+	 */
+    int FindProbeSet(affymetrix_calvin_io::MultiDataType dataType, const std::string &name) { return chpData.FindProbeSet(dataType, name); }
+
+	/*! Get the probe set name index, shared by files with identical probe set names.
+     * @param dataType The data type
+	 * @return The index, or NULL if there is no such data set.
+	 */
+    affymetrix_calvin_io::ProbeSetNameIndex *GetProbeSetNameIndex(affymetrix_calvin_io::MultiDataType dataType) { return chpData.GetProbeSetNameIndex(dataType); }
+
     /*! Get the length of the metric columns.
      * @param dataType The data type
      * @param col The column index (of the metric columns)
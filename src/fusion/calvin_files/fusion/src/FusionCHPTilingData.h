@@ -99,6 +99,21 @@ public:
 	 */
 	void GetTilingSequenceEntry(int row, affymetrix_calvin_io::CHPTilingEntry& e) { chpData.GetTilingSequenceEntry(row, e); }
 
+	/*! Reads a block of entries of the open sequence, one column at a time.
+	 * @param row The index of the first row to read.
+	 * @param count The number of rows to read.
+	 * @param positions The array to hold the genomic positions.
+	 * @param values The array to hold the values.
+	 * @return The number of rows read.
+	 */
+	int32_t GetTilingSequenceEntries(int row, int count, u_int32_t *positions, float *values) { return chpData.GetTilingSequenceEntries(row, count, positions, values); }
+
+	/*! Finds the first entry of the open sequence with a genomic position not less than the given one.
+	 * @param position The genomic position.
+	 * @return The row index, or the number of entries if all positions are less than the given one.
+	 */
+	int32_t FindTilingSequenceEntry(u_int32_t position) { return chpData.FindTilingSequenceEntry(position); }
+
 
 private:
 
@@ -263,6 +263,13 @@ float GCOSCELDataAdapter::GetStdv(int x, int y)
 	return gcosCel.GetStdv(x, y);
 }
 
+/*
+ */
+int GCOSCELDataAdapter::GetStdvs(int index,std::vector<float>& stdvs)
+{
+	return gcosCel.GetStdvs(index,stdvs);
+}
+
 /*
  */
 short GCOSCELDataAdapter::GetPixels(int index)
@@ -277,6 +284,13 @@ short GCOSCELDataAdapter::GetPixels(int x, int y)
 	return gcosCel.GetPixels(x, y);
 }
 
+/*
+ */
+int GCOSCELDataAdapter::GetPixels(int index,std::vector<short>& pixels)
+{
+	return gcosCel.GetPixels(index,pixels);
+}
+
 // Accessors for the mask/outlier flags
 
 /*
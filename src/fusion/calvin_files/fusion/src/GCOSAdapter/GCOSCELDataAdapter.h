@@ -223,6 +223,11 @@ public:
 	 *	\return The standard deviation value.
 	 */
 	float GetStdv(int x, int y);
+  /// @brief     a vector of standard deviations
+  /// @param     index        index of first value
+  /// @param     stdvs        vector to fill
+  /// @return    non-zero on error.
+	int GetStdvs(int index,std::vector<float>& stdvs);
 	/*! \brief Get pixel by index position.
 	 *	\param index Location of pixel.
 	 *	\return The pixel value.
@@ -234,6 +239,11 @@ public:
 	 *	\return The pixel value.
 	 */
 	short GetPixels(int x, int y);
+  /// @brief     a vector of pixel counts
+  /// @param     index        index of first value
+  /// @param     pixels       vector to fill
+  /// @return    non-zero on error.
+	int GetPixels(int index,std::vector<short>& pixels);
 
 	// Accessors for the mask/outlier flags
 	/*! \brief Get masked x, y position.
@@ -24,6 +24,8 @@
 //
 #include "file/TagValuePair.h"
 //
+#include <vector>
+//
 
 using namespace affxchp;
 using namespace affymetrix_fusion_io;
@@ -215,6 +217,36 @@ IFusionCHPHeaderAdapter& GCOSCHPDataAdapter::GetHeader()
 	return *header;
 }
 
+/*! Copies a GCOS expression result to a fusion expression result. */
+static void CopyExpressionResults(CExpressionProbeSetResults* ps, FusionExpressionProbeSetResults& result)
+{
+	result.SetDetectionPValue(ps->DetectionPValue);
+	result.SetSignal(ps->Signal);
+	result.SetNumPairs(ps->NumPairs);
+	result.SetNumUsedPairs(ps->NumUsedPairs);
+	result.SetDetection(ps->Detection);
+	result.SetHasCompResults(ps->m_HasCompResults);
+	result.SetChangePValue(ps->ChangePValue);
+	result.SetSignalLogRatio(ps->SignalLogRatio);
+	result.SetSignalLogRatioLow(ps->SignalLogRatioLow);
+	result.SetSignalLogRatioHigh(ps->SignalLogRatioHigh);
+	result.SetNumCommonPairs(ps->NumCommonPairs);
+	result.SetChange(ps->Change);
+}
+
+/*! Copies a GCOS genotyping result to a fusion genotyping result. */
+static void CopyGenotypingResults(CGenotypeProbeSetResults* ps, FusionGenotypeProbeSetResults& result)
+{
+	result.SetAlleleCall(ps->AlleleCall);
+	result.SetConfidence(ps->Confidence);
+	result.SetRAS1(ps->RAS1);
+	result.SetRAS2(ps->RAS2);
+	result.SetPValueAA(ps->pvalue_AA);
+	result.SetPValueAB(ps->pvalue_AB);
+	result.SetPValueBB(ps->pvalue_BB);
+	result.SetPValueNoCall(ps->pvalue_NoCall);
+}
+
 /*! Returns the expression probe set result
 	* @param index The index to the result object of interest.
   * @param result The expression result.
@@ -226,24 +258,29 @@ bool GCOSCHPDataAdapter::GetExpressionResults(int index, FusionExpressionProbeSe
 	ps = gcosChp.GetExpressionResults(index);
 	if (ps)
 	{
-		result.SetDetectionPValue(ps->DetectionPValue);
-		result.SetSignal(ps->Signal);
-		result.SetNumPairs(ps->NumPairs);
-		result.SetNumUsedPairs(ps->NumUsedPairs);
-		result.SetDetection(ps->Detection);
-		result.SetHasCompResults(ps->m_HasCompResults);
-		result.SetChangePValue(ps->ChangePValue);
-		result.SetSignalLogRatio(ps->SignalLogRatio);
-		result.SetSignalLogRatioLow(ps->SignalLogRatioLow);
-		result.SetSignalLogRatioHigh(ps->SignalLogRatioHigh);
-		result.SetNumCommonPairs(ps->NumCommonPairs);
-		result.SetChange(ps->Change);
+		CopyExpressionResults(ps, result);
 		return true;
 	}
 
 	return false;
 }
 
+/*! Copies a block of expression probe set results
+	* @param first The index of the first result to copy.
+	* @param count The number of results to copy.
+	* @param results The array to copy to, holding at least count elements.
+	* @return True if all results were copied.
+	*/
+bool GCOSCHPDataAdapter::GetExpressionResults(int first, int count, FusionExpressionProbeSetResults* results)
+{
+	std::vector<CExpressionProbeSetResults> ps(count > 0 ? count : 0);
+	if (gcosChp.GetExpressionResults(first, count, count > 0 ? &ps[0] : NULL) == false)
+		return false;
+	for (int i=0; i<count; i++)
+		CopyExpressionResults(&ps[i], results[i]);
+	return true;
+}
+
 
 /*! Returns the genotyping probe set result
 	* @param index The index to the result object of interest.
@@ -256,20 +293,29 @@ bool GCOSCHPDataAdapter::GetGenotypingResults(int index, FusionGenotypeProbeSetR
 	ps = gcosChp.GetGenotypingResults(index);
 	if (ps)
 	{
-		result.SetAlleleCall(ps->AlleleCall);
-		result.SetConfidence(ps->Confidence);
-		result.SetRAS1(ps->RAS1);
-		result.SetRAS2(ps->RAS2);
-		result.SetPValueAA(ps->pvalue_AA);
-		result.SetPValueAB(ps->pvalue_AB);
-		result.SetPValueBB(ps->pvalue_BB);
-		result.SetPValueNoCall(ps->pvalue_NoCall);
+		CopyGenotypingResults(ps, result);
 		return true;
 	}
 
 	return false;
 }
 
+/*! Copies a block of genotyping probe set results
+	* @param first The index of the first result to copy.
+	* @param count The number of results to copy.
+	* @param results The array to copy to, holding at least count elements.
+	* @return True if all results were copied.
+	*/
+bool GCOSCHPDataAdapter::GetGenotypingResults(int first, int count, FusionGenotypeProbeSetResults* results)
+{
+	std::vector<CGenotypeProbeSetResults> ps(count > 0 ? count : 0);
+	if (gcosChp.GetGenotypingResults(first, count, count > 0 ? &ps[0] : NULL) == false)
+		return false;
+	for (int i=0; i<count; i++)
+		CopyGenotypingResults(&ps[i], results[i]);
+	return true;
+}
+
 /*! Returns the universal (tag array) probe set result
 	* @param index The index to the result object of interest.
 	* @param The universal result.
@@ -287,6 +333,22 @@ bool GCOSCHPDataAdapter::GetUniversalResults(int index, FusionUniversalProbeSetR
 	return false;
 }
 
+/*! Copies a block of universal (tag array) probe set results
+	* @param first The index of the first result to copy.
+	* @param count The number of results to copy.
+	* @param results The array to copy to, holding at least count elements.
+	* @return True if all results were copied.
+	*/
+bool GCOSCHPDataAdapter::GetUniversalResults(int first, int count, FusionUniversalProbeSetResults* results)
+{
+	std::vector<CUniversalProbeSetResults> ps(count > 0 ? count : 0);
+	if (gcosChp.GetUniversalResults(first, count, count > 0 ? &ps[0] : NULL) == false)
+		return false;
+	for (int i=0; i<count; i++)
+		results[i].SetBackground(ps[i].GetBackground());
+	return true;
+}
+
 bool GCOSCHPDataAdapter::GetResequencingResults(FusionResequencingResults& result)
 {
 	CResequencingResults* ps = 0;
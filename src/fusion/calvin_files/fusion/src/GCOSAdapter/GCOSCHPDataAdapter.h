@@ -200,6 +200,30 @@ public:
 	 */
 	virtual bool GetUniversalResults(int index, FusionUniversalProbeSetResults& result);
 
+	/*! \brief Copies a block of expression probe set results
+	 *	\param first Index of the first result to copy.
+	 *	\param count Number of results to copy.
+	 *	\param results Array to copy to, holding at least count elements.
+	 *	\return True if all results were copied.
+	 */
+	virtual bool GetExpressionResults(int first, int count, FusionExpressionProbeSetResults* results);
+
+	/*! \brief Copies a block of genotyping probe set results
+	 *	\param first Index of the first result to copy.
+	 *	\param count Number of results to copy.
+	 *	\param results Array to copy to, holding at least count elements.
+	 *	\return True if all results were copied.
+	 */
+	virtual bool GetGenotypingResults(int first, int count, FusionGenotypeProbeSetResults* results);
+
+	/*! \brief Copies a block of universal (tag array) probe set results
+	 *	\param first Index of the first result to copy.
+	 *	\param count Number of results to copy.
+	 *	\param results Array to copy to, holding at least count elements.
+	 *	\return True if all results were copied.
+	 */
+	virtual bool GetUniversalResults(int first, int count, FusionUniversalProbeSetResults* results);
+
 	/*! \brief Gets resequencing results.
 	 *	\param results Hold the resequencing results.
 	 *	\return True if resequencing results were retrieved.
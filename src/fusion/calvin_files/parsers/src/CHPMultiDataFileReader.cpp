@@ -50,6 +50,7 @@ void CHPMultiDataFileReader::Read(CHPMultiDataData& data)
 		fileName = data.GetFilename();
 	}
 	reader.SetFilename(fileName);
-	reader.ReadHeader(data.GetGenericData());
+	// The DataSetHeaders are read on demand; see CHPMultiDataData::GetDataSetHeader.
+	reader.ReadHeader(data.GetGenericData(), GenericFileReader::ReadLazyDataGroupHeader);
 }
 
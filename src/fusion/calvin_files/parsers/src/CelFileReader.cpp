@@ -48,5 +48,7 @@ void CelFileReader::Read(CelFileData& data)
 	if (fileName.empty())
 		fileName = data.GetFilename();
 	reader.SetFilename(fileName);
-	reader.ReadHeader(data.GetGenericData());
+	// The DataSetHeaders of each channel are read on demand; only the
+	// planes that are accessed have their headers parsed.
+	reader.ReadHeader(data.GetGenericData(), GenericFileReader::ReadLazyDataGroupHeader);
 }
@@ -78,6 +78,38 @@ void DataGroupHeaderReader::ReadAll(std::ifstream& fileStream, FileHeader& fh, u
 	}
 }
 
+/*
+ * Reads all the DataGroupHeaders in a file but none of the DataSetHeaders.
+ */
+void DataGroupHeaderReader::ReadAllLazy(std::ifstream& fileStream, FileHeader& fh, u_int32_t dataGroupCnt)
+{
+	// Get the first data group offset
+	u_int32_t nextDataGroupFilePos = fh.GetFirstDataGroupFilePos();
+
+	for (u_int32_t i = 0; i < dataGroupCnt; ++i)
+	{
+		// Read the DataGroupHeader
+		DataGroupHeader dch;
+
+		// Move to the indicated position in the file
+		fileStream.seekg(nextDataGroupFilePos, std::ios_base::beg);
+
+		nextDataGroupFilePos = ReadLazy(fileStream, dch);
+		fh.AddDataGroupHdr(dch);
+	}
+}
+
+/*
+ * Reads the DataGroupHeader and records where its DataSetHeaders are, without reading them.
+ */
+u_int32_t DataGroupHeaderReader::ReadLazy(std::ifstream& fileStream, DataGroupHeader& grpHdr)
+{
+	ReadDataGroupStartFilePos(fileStream, grpHdr);
+	u_int32_t dataSetCnt = ReadHeader(fileStream, grpHdr);
+	grpHdr.SetUnindexedDataSets(dataSetCnt, grpHdr.GetDataSetPos());
+	return grpHdr.GetNextGroupPos();
+}
+
 /*
  * Reads the DataGroupHeader and the minimum information for all DataSetHeaders associated with this DataGroupHeader from the file.
  */
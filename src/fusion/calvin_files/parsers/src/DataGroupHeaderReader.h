@@ -63,6 +63,21 @@ public:
 	 */
 	void ReadAll(std::ifstream& fileStream, FileHeader& fh, u_int32_t dataGroupCnt);
 
+	/*! Reads all the DataGroupHeaders in a file without reading any DataSetHeader.
+	 *	The DataSetHeaders are left to be indexed on first access (see GenericData::IndexDataSetHeaders).
+	 *	@param fileStream Open fstream positioned at the start of the first DataGroupHeader in the file.
+	 *	@param fh FileHeader object to fill.
+	 *	@param dataGroupCnt Number of DataGroup in the file.
+	 */
+	void ReadAllLazy(std::ifstream& fileStream, FileHeader& fh, u_int32_t dataGroupCnt);
+
+	/*! Reads the DataGroupHeader without reading any DataSetHeader associated with it.
+	 *	@param fileStream Open fstream positioned at the start of the DataGroupHeader.
+	 *	@param dch DataGroupHeader object to fill.
+	 *	@return The file position of the next data group
+	 */
+	u_int32_t ReadLazy(std::ifstream& fileStream, DataGroupHeader& dch);
+
 	/*! Reads the DataGroupHeader and the minimum information for all DataSetHeaders associated with this DataGroupHeader
 	 *	from the file.
 	 *	@param fileStream Open fstream positioned at the start of the first DataGroupHeader in the file.
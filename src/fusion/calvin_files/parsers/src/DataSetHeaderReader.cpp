@@ -81,6 +81,33 @@ void DataSetHeaderReader::ReadAll(std::ifstream& fileStream, DataGroupHeader& dc
 	}
 }
 
+/*
+ * Read the names and file offsets for the DataSets of a lazily read DataGroup that have not been indexed yet.
+ */
+void DataSetHeaderReader::ReadUnindexedMinimumInfo(std::ifstream& fileStream, DataGroupHeader& dch, const std::wstring& dataSetName)
+{
+	u_int32_t dataSetCnt = dch.GetUnindexedDataSetCnt();
+	u_int32_t nextDataSetFilePos = dch.GetUnindexedDataSetPos();
+
+	while (dataSetCnt > 0)
+	{
+		DataSetHeader dph;
+
+		// Move to the indicated position in the file
+		fileStream.seekg(nextDataSetFilePos, std::ios_base::beg);
+
+		nextDataSetFilePos = ReadMinimumInfo(fileStream, dph);
+		--dataSetCnt;
+
+		// Add the DataSetHeader to the file header
+		dch.AddDataSetHdr(dph);
+		dch.SetUnindexedDataSets(dataSetCnt, nextDataSetFilePos);
+
+		if (dataSetName.empty() == false && dph.GetName() == dataSetName)
+			break;
+	}
+}
+
 /*
 	* Reads the minimum DataSetHeader information.
 	*/
@@ -62,6 +62,15 @@ public:
 	 */
 	void ReadAll(std::ifstream& fileStream, DataGroupHeader& dch, u_int32_t dataSetCnt);
 
+	/*! Reads the minimum DataSetHeader information for the DataSets of a lazily read DataGroup
+	 *	that have not been indexed yet.  Reading stops as soon as a DataSet with the given name
+	 *	has been indexed, so that only the DataSetHeaders preceeding it are touched.
+	 *	@param fileStream Open fstream.
+	 *	@param dch DataGroupHeader object to which to add the DataSetHeader information.
+	 *	@param dataSetName The name of the DataSet to stop at.  If empty all remaining DataSets are indexed.
+	 */
+	void ReadUnindexedMinimumInfo(std::ifstream& fileStream, DataGroupHeader& dch, const std::wstring& dataSetName);
+
 	/*! Reads the minimum DataSetHeader information.
 	 *	@param fileStream Open fstream positioned at the start of the DataSetHeader.
 	 *	@param dsh Reference to the DataSetHeader object to fill.
@@ -23,6 +23,8 @@
 
 #include "calvin_files/parsers/src/FileInput.h"
 //
+#include "calvin_files/utils/src/StringUtils.h"
+//
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -164,15 +166,17 @@ std::wstring FileInput::ReadString16(std::ifstream &instr)
  */
 std::wstring FileInput::ReadString16(std::ifstream &instr, int32_t len)
 {
-	u_int16_t cvalue;
+	// Read all code units at once rather than one at a time.
+	u_int16_t* cvalue = new u_int16_t[len];
+	memset(cvalue, 0, sizeof(u_int16_t)*len);
+	instr.read((char *)cvalue, sizeof(u_int16_t)*len);
 	wchar_t* s = new wchar_t[len+1];
 	s[len] = 0;
 	for (int i=0; i<len; i++)
 	{
-		instr.read((char *)&cvalue, sizeof(int16_t));
-		cvalue = ntohs(cvalue);
-		s[i] = cvalue;
+		s[i] = ntohs(cvalue[i]);
 	}
+	delete [] cvalue;
 	std::wstring result = s;	// assign wchar_t array to wstring because it will trunc string len to first 0 which may not be the same as len.
 	delete [] s;
 	return result;
@@ -396,3 +400,13 @@ std::wstring FileInput::ReadString16(char * &instr)
 	int32_t len = FileInput::ReadInt32(instr);
 	return FileInput::ReadString16(instr, len);
 }
+
+/*
+ * Read the length (integer) then the string, converting it to UTF-8.
+ */
+void FileInput::ReadString16AsUTF8(char * &instr, std::string &value)
+{
+	int32_t len = FileInput::ReadInt32(instr);
+	affymetrix_calvin_utilities::StringUtils::ConvertUTF16BEToUTF8(instr, len, value);
+	instr += (sizeof(u_int16_t)*len);
+}
@@ -180,6 +180,14 @@ public:
 	*/
 	static std::wstring ReadString16(char * &instr);
 
+	/*! Reads a 16 bit unicode string from a big endian file stream (memory map pointer)
+	* and converts it to UTF-8, without building a wide character string.
+	*
+	* @param instr The input file stream.
+	* @param value The string read from the file stream, UTF-8 encoded.
+	*/
+	static void ReadString16AsUTF8(char * &instr, std::string &value);
+
 	/*! Reads an 8 bit string of fixed size from a big endian file stream (memory map pointer).
 	*
 	* @param instr The input file stream.
@@ -64,6 +64,9 @@ void GenericFileReader::ReadHeader(affymetrix_calvin_io::GenericData& data, Read
 	case ReadMinDataGroupHeader:
 		ReadFileHeaderMinDP(data);
 		break;
+	case ReadLazyDataGroupHeader:
+		ReadFileHeaderLazy(data);
+		break;
 	case ReadAllHeaders:	// fall through
 	default:
 		ReadFileHeader(data);
@@ -137,6 +140,21 @@ void GenericFileReader::ReadFileHeaderNoDataGroupHeader(GenericData& data)
 	fhReader.Read();
 }
 
+/*
+ * Reads the file header and the DataGroupHeaders but defers reading the DataSetHeaders.
+ */
+void GenericFileReader::ReadFileHeaderLazy(GenericData& data)
+{
+	// Set the file name
+	data.Header().SetFilename(fileName);
+
+	FileHeaderReader fhReader(fileStream, data.Header());
+	fhReader.Read();
+
+	DataGroupHeaderReader dchReader;
+	dchReader.ReadAllLazy(fileStream, data.Header(), fhReader.GetDataGroupCnt());
+}
+
 /*
  * Open the file for reading
  */
@@ -54,8 +54,11 @@ public:
 	/*! Hint used when opening a file */
 	enum OpenHint { All, Sequential, None };
 
-	/*! Indicates how much header information to read */
-	enum ReadHeaderOption { ReadAllHeaders, ReadMinDataGroupHeader, ReadNoDataGroupHeader };
+	/*! Indicates how much header information to read.
+	 *	ReadLazyDataGroupHeader reads the DataGroupHeaders only; the DataSetHeaders are
+	 *	read on first access through the GenericData object.
+	 */
+	enum ReadHeaderOption { ReadAllHeaders, ReadMinDataGroupHeader, ReadNoDataGroupHeader, ReadLazyDataGroupHeader };
 
 public:
 	/*! Gets the name of the input file.
@@ -139,6 +142,12 @@ protected:
 	 */
 	void ReadFileHeaderNoDataGroupHeader(GenericData& data);
 
+	/*! Reads the file header and the DataGroupHeaders of the generic file but does not read any DataSetHeaders.
+	 *  The DataSetHeaders are indexed on first access.
+	 *  @param data Reference to the GenericData object to fill.
+	 */
+	void ReadFileHeaderLazy(GenericData& data);
+
 	/*! Closes the file */
 	void CloseFile();
 
@@ -19,6 +19,8 @@
 
 #include "calvin_files/utils/src/StringUtils.h"
 //
+#include "calvin_files/portability/src/AffymetrixBaseTypes.h"
+//
 #include <cstdlib>
 #include <iomanip>
 #include <sstream>
@@ -133,6 +135,124 @@ std::wstring StringUtils::ConvertMBSToWCS(const std::string& source)
 	return result;
 }
 
+/*
+ * Append a code point to a UTF-8 buffer. Returns the position after it.
+ */
+static char* AppendUTF8(char* out, unsigned long cp)
+{
+	if (cp < 0x80)
+	{
+		*out++ = (char) cp;
+	}
+	else if (cp < 0x800)
+	{
+		*out++ = (char) (0xC0 | (cp >> 6));
+		*out++ = (char) (0x80 | (cp & 0x3F));
+	}
+	else if (cp < 0x10000)
+	{
+		*out++ = (char) (0xE0 | (cp >> 12));
+		*out++ = (char) (0x80 | ((cp >> 6) & 0x3F));
+		*out++ = (char) (0x80 | (cp & 0x3F));
+	}
+	else
+	{
+		*out++ = (char) (0xF0 | (cp >> 18));
+		*out++ = (char) (0x80 | ((cp >> 12) & 0x3F));
+		*out++ = (char) (0x80 | ((cp >> 6) & 0x3F));
+		*out++ = (char) (0x80 | (cp & 0x3F));
+	}
+	return out;
+}
+
+/*
+ * Convert wide character string to a UTF-8 string.
+ */
+std::string StringUtils::ConvertWCSToUTF8(const std::wstring& source)
+{
+	// At most three bytes per UTF-16 code unit and four per UCS-4 character.
+	size_t n = source.size();
+	std::string result(4*n, '\0');
+	if (n == 0)
+		return result;
+	char* begin = &result[0];
+	char* out = begin;
+	for (size_t i = 0; i < n; i++)
+	{
+		unsigned long cp = (unsigned long) source[i];
+		if (cp == 0)
+			continue;
+		if (cp >= 0xD800 && cp <= 0xDBFF && i+1 < n)
+		{
+			unsigned long lo = (unsigned long) source[i+1];
+			if (lo >= 0xDC00 && lo <= 0xDFFF)
+			{
+				cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+				i++;
+			}
+		}
+		out = AppendUTF8(out, cp);
+	}
+	result.resize(out - begin);
+	return result;
+}
+
+/*
+ * Convert a big endian UTF-16 string to a UTF-8 string.
+ */
+void StringUtils::ConvertUTF16BEToUTF8(const char* source, int len, std::string& result)
+{
+	// Four code units are ASCII if all high bytes are zero and all low bytes are below 0x80.
+	static const unsigned char asciiBytes[8] = { 0xFF, 0x80, 0xFF, 0x80, 0xFF, 0x80, 0xFF, 0x80 };
+	u_int64_t asciiMask;
+	memcpy(&asciiMask, asciiBytes, sizeof(asciiMask));
+
+	// At most three bytes per code unit.
+	result.resize(3*(len > 0 ? len : 0));
+	if (result.empty())
+		return;
+	char* begin = &result[0];
+	char* out = begin;
+	const unsigned char* in = (const unsigned char*) source;
+	int i = 0;
+	while (i < len)
+	{
+		if (i+4 <= len)
+		{
+			u_int64_t word;
+			memcpy(&word, in + 2*i, sizeof(word));
+			if ((word & asciiMask) == 0)
+			{
+				out[0] = (char) in[2*i+1];
+				out[1] = (char) in[2*i+3];
+				out[2] = (char) in[2*i+5];
+				out[3] = (char) in[2*i+7];
+				if (out[0] != 0 && out[1] != 0 && out[2] != 0 && out[3] != 0)
+				{
+					out += 4;
+					i += 4;
+					continue;
+				}
+			}
+		}
+		unsigned long cp = ((unsigned long) in[2*i] << 8) | in[2*i+1];
+		if (cp == 0)
+			break;
+		i++;
+		if (cp >= 0xD800 && cp <= 0xDBFF && i < len)
+		{
+			unsigned long lo = ((unsigned long) in[2*i] << 8) | in[2*i+1];
+			if (lo >= 0xDC00 && lo <= 0xDFFF)
+			{
+				cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+				i++;
+			}
+		}
+		out = AppendUTF8(out, cp);
+	}
+	result.resize(out - begin);
+}
+
 /*
  * Convert an integer to a string.
  */
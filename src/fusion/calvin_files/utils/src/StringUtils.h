@@ -96,6 +96,22 @@ public:
      */
     static std::wstring ConvertMBSToWCS(const std::string& source);
 
+    /*! Convert wide character string to a UTF-8 string, independent of the locale.
+     *  UTF-16 surrogate pairs are combined and null characters are dropped.
+     *  @param source Wide character string to convert.
+     *  @return Converted UTF-8 string.
+     */
+    static std::string ConvertWCSToUTF8(const std::wstring& source);
+
+    /*! Convert a big endian UTF-16 string, as stored in Calvin files, to a UTF-8 string
+     *  without building a wide character string. Runs of ASCII characters are converted
+     *  four at a time. The string ends at the first null character.
+     *  @param source The UTF-16 code units.
+     *  @param len The number of code units.
+     *  @param result The converted UTF-8 string. Its memory is reused.
+     */
+    static void ConvertUTF16BEToUTF8(const char* source, int len, std::string& result);
+
     /*! Convert an integer to a string.
      * @param value The integer
      * @param digits The number of digits for the resulting string
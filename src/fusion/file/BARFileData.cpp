@@ -20,6 +20,7 @@
 #include "file/BARFileData.h"
 #include "file/FileIO.h"
 //
+#include <algorithm>
 #include <cassert>
 #include <fstream>
 #include <istream>
@@ -27,14 +28,6 @@
 #include <sys/types.h>
 //
 
-#ifndef _MSC_VER
-#include <sys/mman.h>
-#endif
-
-#ifdef _INCLUDE_UNISTD_HEADER_
-#include <unistd.h>
-#endif
-
 //////////////////////////////////////////////////////////////////////
 
 using namespace affxbar;
@@ -46,10 +39,9 @@ CGDACSequenceResultItem::CGDACSequenceResultItem() :
 	m_NumberColumns(0),
 	m_NumberParameters(0),
 	m_pColumnTypes(NULL),
-	m_ppData(NULL),
-	m_pppData(NULL),
-	m_bMapped(false),
-	m_lpData(NULL),
+	m_bDataLoaded(false),
+	m_pDataItem(NULL),
+	m_pView(NULL),
 	m_DataStartPosition(0)
 {
 }
@@ -58,13 +50,6 @@ CGDACSequenceResultItem::CGDACSequenceResultItem() :
 
 CGDACSequenceResultItem::~CGDACSequenceResultItem()
 {
-	for (int i=0; i<m_NumberDataPoints && m_ppData; i++)
-	{
-		delete[] m_ppData[i];
-		m_ppData[i] = NULL;
-	}
-	delete[] m_ppData;
-	m_ppData = NULL;
 	m_pColumnTypes = NULL;
 	m_NumberDataPoints = 0;
 	m_Parameters.erase(m_Parameters.begin(), m_Parameters.end());
@@ -72,24 +57,218 @@ CGDACSequenceResultItem::~CGDACSequenceResultItem()
 
 //////////////////////////////////////////////////////////////////////
 
-void CGDACSequenceResultItem::GetData(int iData, int iCol, BarSequenceResultData &data )
+void CGDACSequenceResultItem::AllocateColumns()
 {
-	if (m_bMapped == false)
+	int nInt = 0;
+	int nFloat = 0;
+	m_ColumnOffsets.resize(m_NumberColumns);
+	for (int iCol=0; iCol<m_NumberColumns; iCol++)
 	{
-		data = (*m_pppData)[iData][iCol];
+		if (GetColumnType(iCol) == BAR_DATA_INTEGER)
+			m_ColumnOffsets[iCol] = (nInt++) * m_NumberDataPoints;
+		else
+			m_ColumnOffsets[iCol] = (nFloat++) * m_NumberDataPoints;
 	}
-	else
+	m_IntData.assign((size_t) nInt * m_NumberDataPoints, 0);
+	m_FloatData.assign((size_t) nFloat * m_NumberDataPoints, 0.0f);
+}
+
+//////////////////////////////////////////////////////////////////////
+
+bool CGDACSequenceResultItem::LoadData()
+{
+	if (m_pDataItem != NULL)
+		return m_pDataItem->LoadData();
+	if (m_bDataLoaded == true)
+		return true;
+	if (m_pView == NULL)
+		return false;
+
+	// Each value takes 4 bytes and the values are stored row by row.
+	int64_t rowSize = (int64_t) m_NumberColumns * INT_SIZE;
+	const char *lpData = MapRows(0, m_NumberDataPoints);
+	if (lpData == NULL && m_NumberDataPoints > 0)
+		return false;
+
+	AllocateColumns();
+	for (int iCol=0; iCol<m_NumberColumns; iCol++)
 	{
-		int offset = ((iData * GetNumberColumns()) + iCol) * INT_SIZE;
-		if (this->GetColumnType(iCol) == BAR_DATA_INTEGER)
+		const char *ptr = lpData + iCol * INT_SIZE;
+		if (GetColumnType(iCol) == BAR_DATA_INTEGER)
 		{
-			data.iValue = MmGetUInt32_N((uint32_t*)(m_lpData + offset));
+			int32_t *col = &m_IntData[m_ColumnOffsets[iCol]];
+			for (int iData=0; iData<m_NumberDataPoints; iData++, ptr += rowSize)
+				col[iData] = MmGetInt32_N((int32_t*)ptr);
 		}
 		else
 		{
-			data.fValue = MmGetFloat_N((float*)(m_lpData + offset));
+			float *col = &m_FloatData[m_ColumnOffsets[iCol]];
+			for (int iData=0; iData<m_NumberDataPoints; iData++, ptr += rowSize)
+				col[iData] = MmGetFloat_N((float*)ptr);
 		}
 	}
+	m_bDataLoaded = true;
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+void CGDACSequenceResultItem::UnloadData()
+{
+	if (m_pDataItem != NULL || m_pView == NULL)
+		return;
+	std::vector<int32_t>().swap(m_IntData);
+	std::vector<float>().swap(m_FloatData);
+	m_bDataLoaded = false;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+CGDACSequenceResultItem *CGDACSequenceResultItem::GetDataItem()
+{
+	CGDACSequenceResultItem *item = (m_pDataItem != NULL ? m_pDataItem : this);
+	if (item->LoadData() == false)
+		return NULL;
+	return item;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+void CGDACSequenceResultItem::GetData(int iData, int iCol, BarSequenceResultData &data )
+{
+	CGDACSequenceResultItem *item = GetDataItem();
+	if (item == NULL)
+	{
+		data.dValue = 0;
+	}
+	else if (GetColumnType(iCol) == BAR_DATA_INTEGER)
+	{
+		data.iValue = item->m_IntData[item->m_ColumnOffsets[iCol] + iData];
+	}
+	else
+	{
+		data.fValue = item->m_FloatData[item->m_ColumnOffsets[iCol] + iData];
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+
+const int32_t *CGDACSequenceResultItem::GetIntColumn(int iCol)
+{
+	if (GetColumnType(iCol) != BAR_DATA_INTEGER)
+		return NULL;
+	CGDACSequenceResultItem *item = GetDataItem();
+	if (item == NULL || item->m_IntData.empty())
+		return NULL;
+	return &item->m_IntData[item->m_ColumnOffsets[iCol]];
+}
+
+//////////////////////////////////////////////////////////////////////
+
+const float *CGDACSequenceResultItem::GetFloatColumn(int iCol)
+{
+	if (GetColumnType(iCol) == BAR_DATA_INTEGER)
+		return NULL;
+	CGDACSequenceResultItem *item = GetDataItem();
+	if (item == NULL || item->m_FloatData.empty())
+		return NULL;
+	return &item->m_FloatData[item->m_ColumnOffsets[iCol]];
+}
+
+//////////////////////////////////////////////////////////////////////
+
+const char *CGDACSequenceResultItem::MapRows(int first, int count)
+{
+	if (m_pView == NULL || first < 0 || count < 0 || first + count > m_NumberDataPoints)
+		return NULL;
+	int64_t rowSize = (int64_t) m_NumberColumns * INT_SIZE;
+	return m_pView->map(m_DataStartPosition + first * rowSize, count * rowSize);
+}
+
+//////////////////////////////////////////////////////////////////////
+
+int CGDACSequenceResultItem::LowerBound(int iCol, int32_t value)
+{
+	if (m_pDataItem != NULL)
+		return m_pDataItem->LowerBound(iCol, value);
+	if (GetColumnType(iCol) != BAR_DATA_INTEGER)
+		return -1;
+
+	int lo = 0;
+	int hi = m_NumberDataPoints;
+	if (m_bDataLoaded == true && hi > 0)
+	{
+		const int32_t *col = &m_IntData[m_ColumnOffsets[iCol]];
+		return (int) (std::lower_bound(col, col + hi, value) - col);
+	}
+	while (lo < hi)
+	{
+		int mid = lo + (hi - lo) / 2;
+		const char *ptr = MapRows(mid, 1);
+		if (ptr == NULL)
+			return -1;
+		if (MmGetInt32_N((int32_t*)(ptr + iCol * INT_SIZE)) < value)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+bool CGDACSequenceResultItem::GetIntColumnRange(int iCol, int first, int count, int32_t *values)
+{
+	if (m_pDataItem != NULL)
+		return m_pDataItem->GetIntColumnRange(iCol, first, count, values);
+	if (GetColumnType(iCol) != BAR_DATA_INTEGER ||
+	    first < 0 || count < 0 || first + count > m_NumberDataPoints)
+		return false;
+
+	if (m_bDataLoaded == true || m_pView == NULL)
+	{
+		const int32_t *col = GetIntColumn(iCol);
+		if (col == NULL && count > 0)
+			return false;
+		std::copy(col + first, col + first + count, values);
+		return true;
+	}
+	const char *ptr = MapRows(first, count);
+	if (ptr == NULL && count > 0)
+		return false;
+	int rowSize = m_NumberColumns * INT_SIZE;
+	ptr += iCol * INT_SIZE;
+	for (int i=0; i<count; i++, ptr += rowSize)
+		values[i] = MmGetInt32_N((int32_t*)ptr);
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+bool CGDACSequenceResultItem::GetFloatColumnRange(int iCol, int first, int count, float *values)
+{
+	if (m_pDataItem != NULL)
+		return m_pDataItem->GetFloatColumnRange(iCol, first, count, values);
+	if (GetColumnType(iCol) == BAR_DATA_INTEGER ||
+	    first < 0 || count < 0 || first + count > m_NumberDataPoints)
+		return false;
+
+	if (m_bDataLoaded == true || m_pView == NULL)
+	{
+		const float *col = GetFloatColumn(iCol);
+		if (col == NULL && count > 0)
+			return false;
+		std::copy(col + first, col + first + count, values);
+		return true;
+	}
+	const char *ptr = MapRows(first, count);
+	if (ptr == NULL && count > 0)
+		return false;
+	int rowSize = m_NumberColumns * INT_SIZE;
+	ptr += iCol * INT_SIZE;
+	for (int i=0; i<count; i++, ptr += rowSize)
+		values[i] = MmGetFloat_N((float*)ptr);
+	return true;
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -104,10 +283,12 @@ void CGDACSequenceResultItem::MakeShallowCopy(CGDACSequenceResultItem &orig)
 	m_NumberParameters = orig.m_NumberParameters;
 	m_pColumnTypes = orig.m_pColumnTypes;
 	m_Parameters = orig.m_Parameters;
-	m_pppData = &orig.m_ppData;
-	m_ppData = NULL;
-	m_bMapped = orig.m_bMapped;
-	m_lpData = orig.m_lpData;
+	std::vector<int32_t>().swap(m_IntData);
+	std::vector<float>().swap(m_FloatData);
+	m_ColumnOffsets.clear();
+	m_bDataLoaded = false;
+	m_pDataItem = (orig.m_pDataItem != NULL ? orig.m_pDataItem : &orig);
+	m_pView = NULL;
 	m_DataStartPosition = orig.m_DataStartPosition;
 }
 
@@ -116,19 +297,20 @@ void CGDACSequenceResultItem::MakeShallowCopy(CGDACSequenceResultItem &orig)
 void CGDACSequenceResultItem::SetNumberDataPoints(int n)
 {
 	m_NumberDataPoints = n;
-	m_ppData = new BarSequenceResultData *[m_NumberDataPoints];
-	m_pppData = &m_ppData;
-	for (int j=0; j<m_NumberDataPoints; j++)
-	{
-		m_ppData[j] = new BarSequenceResultData[m_NumberColumns];
-	}
+	m_pDataItem = NULL;
+	m_pView = NULL;
+	AllocateColumns();
+	m_bDataLoaded = true;
 }
 
 //////////////////////////////////////////////////////////////////////
 
 void CGDACSequenceResultItem::SetDataPoint(int nIndex, int colIndex, BarSequenceResultData &data)
 {
-	m_ppData[nIndex][colIndex] = data;
+	if (GetColumnType(colIndex) == BAR_DATA_INTEGER)
+		m_IntData[m_ColumnOffsets[colIndex] + nIndex] = data.iValue;
+	else
+		m_FloatData[m_ColumnOffsets[colIndex] + nIndex] = data.fValue;
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -158,18 +340,8 @@ std::string CGDACSequenceResultItem::GetFullName() const
 CBARFileData::CBARFileData() :
 	m_Version(0), m_NumberSequences(0), m_NumberColumns(0),
 	m_NumberParameters(0),
-	m_lpFileMap(NULL),
-	m_lpData(NULL),
-	m_bFileOpen(false),
-	m_bFileMapped(false)
+	m_DataStartPosition(0)
 {
-#ifdef _MSC_VER
-	m_hFileMap = INVALID_HANDLE_VALUE;
-	m_hFile = INVALID_HANDLE_VALUE;
-#else
-	m_MapLen = 0;
-	m_fp = NULL;
-#endif
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -252,7 +424,7 @@ bool CBARFileData::ReadFile(bool bReadHeaderOnly)
 bool CBARFileData::ReadHeaderSection()
 {
 	// Open the file.
-	std::ifstream instr;
+	MappedFileStream instr;
 	instr.open(m_FileName.c_str(), std::ios::in | std::ios::binary);
 
 	// Check if open
@@ -313,41 +485,23 @@ bool CBARFileData::ReadHeaderSection()
 
 int CBARFileData::GetDataRowSize()
 {
-	int size=0;
-	m_ColumnTypes.resize(m_NumberColumns);
-	for (int i=0; i<m_NumberColumns; i++)
-	{
-		switch (m_ColumnTypes[i])
-		{
-		case BAR_DATA_FLOAT:
-		case BAR_DATA_INTEGER:
-		case BAR_DATA_UINTEGER:
-			size += INT_SIZE;
-			break;
-
-		case BAR_DATA_SHORT:
-		case BAR_DATA_USHORT:
-			size += SHORT_SIZE;
-			break;
-
-		case BAR_DATA_CHAR:
-		case BAR_DATA_UCHAR:
-			size += CHAR_SIZE;
-			break;
-		// BAR_DATA_DOUBLE is not handled.
-		default:
-			assert(0); // case not handled
-		}
-	}
-	return size;
+	// Every value is stored using 4 bytes, as an integer if the column
+	// is of type BAR_DATA_INTEGER and as a float otherwise.
+	return m_NumberColumns * INT_SIZE;
 }
 
 //////////////////////////////////////////////////////////////////////
 
 bool CBARFileData::ReadDataSection()
 {
-	// Open the file.
-	std::ifstream instr;
+	// Open the file; the data of the sequences is loaded through
+	// the same view when first accessed.
+	if (m_View.open(m_FileName, MappedFile::ADVICE_RANDOM) == false)
+	{
+		m_strError = "Unable to open the file.";
+		return false;
+	}
+	MappedFileStream instr;
 	instr.open(m_FileName.c_str(), std::ios::in | std::ios::binary);
 
 	// Check if open
@@ -360,8 +514,10 @@ bool CBARFileData::ReadDataSection()
 	// Skip to the data section
 	instr.seekg(m_DataStartPosition);
 
-	// Read the results
+	// Read the sequence headers and skip their data
 	bool bVersion2 = ((int)(m_Version + 0.1) == 2);
+	int64_t rowSize = GetDataRowSize();
+	int64_t fileSize = m_View.size();
 	m_Results.resize(m_NumberSequences);
 	std::string tag;
 	std::string val;
@@ -390,139 +546,21 @@ bool CBARFileData::ReadDataSection()
 		m_Results[i].m_NumberColumns = m_NumberColumns;
 		m_Results[i].m_pColumnTypes = &m_ColumnTypes;
 		m_Results[i].m_DataStartPosition = instr.tellg();
+		m_Results[i].m_pView = &m_View;
 
-#ifndef _USE_MEM_MAPPING_
-
-		m_Results[i].m_ppData = new BarSequenceResultData *[m_Results[i].m_NumberDataPoints];
-		m_Results[i].m_pppData = &m_Results[i].m_ppData;
-		for (int j=0; j<m_Results[i].m_NumberDataPoints; j++)
+		int64_t dataSize = rowSize * m_Results[i].m_NumberDataPoints;
+		if (!instr || cType < 0 ||
+		    m_Results[i].m_DataStartPosition + dataSize > fileSize)
 		{
-			m_Results[i].m_ppData[j] = new BarSequenceResultData[m_NumberColumns];
-			for (int k=0; k<m_NumberColumns; k++)
-			{
-				if (m_ColumnTypes[k] == BAR_DATA_INTEGER) {
-					ReadInt32_N(instr, cType);
-					m_Results[i].m_ppData[j][k].iValue = cType;
-				} else {
-					
-					ReadFloat_N(instr, m_Results[i].m_ppData[j][k].fValue);
-				}
-			}
+			m_strError = "The file is truncated or corrupt.";
+			return false;
 		}
-
-#else
-
-    // Determine the size of each row
-    int rowSize = GetDataRowSize();
-
-		m_Results[i].m_ppData = NULL;
-		m_Results[i].m_pppData = NULL;
-		int offset = m_Results[i].m_NumberDataPoints * rowSize;
-		instr.seekg(offset, std::ios_base::cur);
-
-#endif
-
+		instr.seekg(m_Results[i].m_DataStartPosition + dataSize);
 	}
 
 	// Close the file
 	instr.close();
 
-
-
-#ifdef _USE_MEM_MAPPING_
-	
-	// Initialize the bool flags.
-	m_bFileOpen = false;
-	m_bFileMapped = false;
-
-#ifdef _MSC_VER
-
-	// Create the file.
-	m_hFile = CreateFile(m_FileName.c_str(), GENERIC_READ, FILE_SHARE_READ,
-			NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
-	if (m_hFile == INVALID_HANDLE_VALUE)
-	{
-		m_strError = "Unable to open the file.";
-		return false;
-	}
-	m_bFileOpen = true;
-
-
-	// Map the file.
-	m_hFileMap = CreateFileMapping(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
-	if (m_hFileMap != NULL)
-	{
-		m_lpFileMap = MapViewOfFile(m_hFileMap, FILE_MAP_READ, 0, 0, 0);
-		if (m_lpFileMap == NULL)
-		{
-			CloseHandle (m_hFileMap);
-			m_hFileMap = NULL;
-			CloseHandle (m_hFile);
-			m_hFile = INVALID_HANDLE_VALUE;
-			m_strError = "Unable to map view for the memory map file.";
-			Close();
-			return false;
-		}
-		else
-		{
-			m_lpData = (char *)m_lpFileMap;
-			m_bFileMapped = true;
-		}
-	}
-	else
-	{
-		m_strError = "Unable to create memory map file.";
-		CloseHandle (m_hFile);
-		m_hFile = INVALID_HANDLE_VALUE;
-		Close();
-		return false;
-	}
-
-#else
-
-	// Open the file
-	m_fp = fopen(m_FileName.c_str(), "r");
-	if (m_fp == NULL)
-	{
-		m_strError = "Failed to open the file for memory mapping.";
-		Close();
-		return false;
-	}
-	m_bFileOpen = true;
-	
-	// Get the file size
-	struct stat st;
-	m_MapLen = 0;
-	if (stat(m_FileName.c_str(), &st) == 0)
-	{
-		m_MapLen = st.st_size;
-	}
-
-	// Map the file.
-	m_lpFileMap = mmap(NULL, m_MapLen, PROT_READ, MAP_SHARED, fileno(m_fp), 0);
-    if (m_lpFileMap == MAP_FAILED)
-	{
-		m_strError = "Unable to map view for the memory map file.";
-		Close();
-		return false;
-	}
-	else
-	{
-		m_lpData = (char *)m_lpFileMap;
-		m_bFileMapped = true;
-	}
-
-#endif
-
-	// Set the data pointer for each sequence item.
-	for (int iSeq=0; iSeq<m_NumberSequences; iSeq++)
-	{
-		m_Results[iSeq].m_bMapped = true;
-		m_Results[iSeq].m_lpData = m_lpData + m_Results[iSeq].m_DataStartPosition;
-	}
-
-#endif
-
 	return true;
 }
 
@@ -538,35 +576,7 @@ void CBARFileData::Close()
 	m_Parameters.erase(m_Parameters.begin(), m_Parameters.end());
 	m_ColumnTypes.erase(m_ColumnTypes.begin(), m_ColumnTypes.end());
 	m_Results.erase(m_Results.begin(), m_Results.end());
-
-#ifdef _MSC_VER
-	if (m_bFileOpen)
-	{
-		if (m_bFileMapped)
-		{
-			UnmapViewOfFile(m_lpFileMap);
-			m_lpFileMap = NULL;
-			CloseHandle(m_hFileMap);
-			m_hFileMap = NULL;
-			m_lpData = NULL;
-		}
-		CloseHandle(m_hFile);
-		m_hFile = INVALID_HANDLE_VALUE;
-		m_bFileOpen = false;
-	}
-#else
-	if (m_fp == NULL)
-	{
-		if (m_bFileMapped == true)
-		{
-			munmap(m_lpFileMap, m_MapLen);
-			m_MapLen = 0;
-		}
-		if (m_fp)
-			fclose(m_fp);
-		m_fp = NULL;
-	}
-#endif
+	m_View.close();
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -33,6 +33,8 @@
 //////////////////////////////////////////////////////////////////////
 
 #include "file/TagValuePair.h"
+#include "portability/affy-base-types.h"
+#include "util/MappedFile.h"
 //
 #include <cstring>
 #include <fstream>
@@ -112,7 +114,14 @@ typedef union _BarSequenceResultData
 
 //////////////////////////////////////////////////////////////////////
 
-/*! This class provides storage for results associated with a sequence. */
+/*! This class provides storage for results associated with a sequence.
+ *
+ * The results are stored by column, with one contiguous array per column.
+ * Integer columns are held in one array of 32 bit integers and all other
+ * columns in one array of floats, the way they are stored in the file.
+ * When the sequence is read from a file, its data is not loaded until
+ * it is first accessed.
+ */
 class CGDACSequenceResultItem
 {
 public:
@@ -147,22 +156,28 @@ protected:
 	/*! The parameter name/value array. */
 	TagValuePairTypeVector m_Parameters;
 
-	/*! A pointer to the data. */
-	BarSequenceResultData **m_ppData;
+	/*! The values of the integer columns, one column after the other. */
+	std::vector<int32_t> m_IntData;
 
-	/*! A pointer to the data pointer.
-	 * This is used when making copies of the object. The data pointer is not duplicated,
-	 * just a pointer to the data object is made. */
-	BarSequenceResultData ***m_pppData;
+	/*! The values of the other columns, one column after the other. */
+	std::vector<float> m_FloatData;
+
+	/*! The offset of each column into m_IntData or m_FloatData. */
+	std::vector<int> m_ColumnOffsets;
 
-	/*! Flag indicating if the file is memory mapped. */
-	bool m_bMapped;
+	/*! Flag indicating if the data is loaded. */
+	bool m_bDataLoaded;
 
-	/*! Pointer to the memory mapped file. */
-	char *m_lpData;
+	/*! The object holding the data, or NULL if it is this object.
+	 * This is used when making copies of the object. The data is not duplicated,
+	 * just a pointer to the data object is made. */
+	CGDACSequenceResultItem *m_pDataItem;
+
+	/*! The view of the file to load the data from, or NULL. */
+	MappedFileView *m_pView;
 
 	/*! The file position of the start of the data. */
-	int m_DataStartPosition;
+	int64_t m_DataStartPosition;
 
 	/*! Makes a copy of the object. The results are not copied to the new object, just
 	 * the pointer back to the originating object.
@@ -170,6 +185,21 @@ protected:
 	 */
 	void MakeShallowCopy(CGDACSequenceResultItem &orig);
 
+	/*! Allocates the columns for the data points. */
+	void AllocateColumns();
+
+	/*! Gets the object holding the data, with the data loaded.
+	 * @return The object or NULL if the data could not be loaded.
+	 */
+	CGDACSequenceResultItem *GetDataItem();
+
+	/*! Gets a pointer to the rows of a range of data points in the file.
+	 * @param first The first row.
+	 * @param count The number of rows.
+	 * @return The pointer, valid until the next call, or NULL on failure.
+	 */
+	const char *MapRows(int first, int count);
+
 public:
 	/*! Gets the sequence name.
 	 * @return The sequence name.
@@ -214,6 +244,62 @@ public:
 	 */
 	void GetData(int iData, int iCol, BarSequenceResultData &data );
 
+	/*! Gets all values of an integer column.
+	 * @param iCol The column index.
+	 * @return A pointer to GetNumberDataPoints() values, or NULL if the column
+	 * is not of type BAR_DATA_INTEGER or the data could not be loaded.
+	 */
+	const int32_t *GetIntColumn(int iCol);
+
+	/*! Gets all values of a column that is not an integer column.
+	 * @param iCol The column index.
+	 * @return A pointer to GetNumberDataPoints() values, or NULL if the column
+	 * is of type BAR_DATA_INTEGER or the data could not be loaded.
+	 */
+	const float *GetFloatColumn(int iCol);
+
+	/*! Finds the first data point whose value in a sorted integer column is
+	 * not less than the given value. If the data is not loaded, only the
+	 * values visited by the binary search are read from the file.
+	 * @param iCol The column index.
+	 * @param value The value to search for.
+	 * @return The row index, GetNumberDataPoints() if all values are less,
+	 * or -1 if the column is not of type BAR_DATA_INTEGER or reading failed.
+	 */
+	int LowerBound(int iCol, int32_t value);
+
+	/*! Gets the values of a range of data points of an integer column.
+	 * If the data is not loaded, only the range is read from the file.
+	 * @param iCol The column index.
+	 * @param first The first row.
+	 * @param count The number of rows.
+	 * @param values The array to copy the values to.
+	 * @return True if successful.
+	 */
+	bool GetIntColumnRange(int iCol, int first, int count, int32_t *values);
+
+	/*! Gets the values of a range of data points of a column that is not
+	 * an integer column. If the data is not loaded, only the range is read
+	 * from the file.
+	 * @param iCol The column index.
+	 * @param first The first row.
+	 * @param count The number of rows.
+	 * @param values The array to copy the values to.
+	 * @return True if successful.
+	 */
+	bool GetFloatColumnRange(int iCol, int first, int count, float *values);
+
+	/*! Loads the data, unless already loaded. This is done automatically
+	 * the first time the data is accessed.
+	 * @return True if successful.
+	 */
+	bool LoadData();
+
+	/*! Frees the memory of the data. Data read from a file is loaded again
+	 * when next accessed.
+	 */
+	void UnloadData();
+
 	/*! Gets the number of parameters.
 	 * @return The number of parameters.
 	 */
@@ -302,6 +388,9 @@ protected:
 	/*! The sequence results. */
 	std::vector<CGDACSequenceResultItem> m_Results;
 
+	/*! The view of the file that the sequence data is loaded from. */
+	MappedFileView m_View;
+
 	/*! A string to hold error messages. */
 	std::string m_strError;
 
@@ -326,32 +415,6 @@ protected:
 	 */
 	int GetDataRowSize();
 
-	/*! Pointer to a memory mapped file. */
-	void  *m_lpFileMap;
-
-	/*! Pointer to the data in the memory mapped file. */
-	char  *m_lpData;
-#ifdef _MSC_VER
-
-	/*! Windows handle to the file. */
-	HANDLE m_hFileMap;
-
-	/*! Windows handle to the file. */
-	HANDLE m_hFile;
-#else
-	/*! File pointer for memory mapping. */
-	FILE *m_fp;
-
-	/*! The size of the file. */
-	int m_MapLen;
-#endif
-
-	/*! Flag indicating if the file is open. */
-	bool m_bFileOpen;
-
-	/*! Flag indicating if the file is memory mapped. */
-	bool m_bFileMapped;
-
 public:
 	/*! Sets the full path to the BAR file.
 	 * @param name The file name.
@@ -24,6 +24,9 @@
 //
 #include "portability/affy-base-types.h"
 //
+#include "R_affx_thread_pool.h"
+//
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <cstdlib>
@@ -70,7 +73,8 @@ CCDFFileHeader::CCDFFileHeader() :
 
 //////////////////////////////////////////////////////////////////////
 
-CCDFFileData::CCDFFileData()
+CCDFFileData::CCDFFileData() :
+    m_NumThreads(1)
 {
 }
 
@@ -293,6 +297,30 @@ std::string CCDFFileData::GetProbeSetName(int index)
 
 //////////////////////////////////////////////////////////////////////
 
+void CCDFFileData::GetProbeSetNames(int first, int count, std::vector<std::string> &names)
+{
+  names.resize(count);
+  if (iteratorReader.is_open() == false) {
+    for (int i=0; i<count; i++)
+      names[i] = m_ProbeSetNames.GetName(first+i);
+    return;
+  }
+  if (count <= 0)
+    return;
+
+  // The fixed length names are stored one after the other.
+  std::vector<char> buffer(count*MAX_PROBE_SET_NAME_LENGTH);
+  int loc = (int)probeSetNamePos + (first*MAX_PROBE_SET_NAME_LENGTH);
+  seekg(loc, std::ios::beg);
+  ReadFixedCString(iteratorReader, &buffer[0], (uint32_t)buffer.size());
+  for (int i=0; i<count; i++) {
+    const char *name = &buffer[i*MAX_PROBE_SET_NAME_LENGTH];
+    names[i].assign(name, std::find(name, name+MAX_PROBE_SET_NAME_LENGTH, '\0'));
+  }
+}
+
+//////////////////////////////////////////////////////////////////////
+
 void CCDFFileData::Close()
 {
     if (iteratorReader.is_open() == true)
@@ -810,14 +838,299 @@ bool CCDFFileData::ReadXDAFormat()
 
 //////////////////////////////////////////////////////////////////////
 
+/*! The number of bytes of a text CDF file parsed at a time. */
+#define CDF_TEXT_BLOCK_SIZE (64*1024*1024)
+
+/*! The initial number of bytes read for the header of a text CDF file. */
+#define CDF_TEXT_HEADER_BLOCK_SIZE (1024*1024)
+
+/*! The number of units a thread parses at a time. */
+#define CDF_TEXT_UNITS_PER_TASK 256
+
+/*! Is the character white space, as for sscanf()? */
+static inline bool CDFTextIsSpace(char c)
+{
+    return (c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r');
+}
+
+/*! Parses an integer in [p, end) the way atoi() does.
+ * @return The integer, or 0 if there is none.
+ */
+static int CDFTextAtoi(const char *p, const char *end)
+{
+    while (p < end && CDFTextIsSpace(*p))
+        ++p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = (*p++ == '-');
+    unsigned int value = 0;
+    while (p < end && (unsigned char)(*p - '0') < 10)
+        value = value*10 + (unsigned int)(*p++ - '0');
+    return (int)(negative ? 0u - value : value);
+}
+
+/*! Scans an integer in [p, end) the way sscanf()'s "%d" does, and moves p past it.
+ * @return True if there was an integer; value is left as is otherwise.
+ */
+static bool CDFTextScanInt(const char *&p, const char *end, int &value)
+{
+    while (p < end && CDFTextIsSpace(*p))
+        ++p;
+    const char *q = p;
+    bool negative = false;
+    if (q < end && (*q == '-' || *q == '+'))
+        negative = (*q++ == '-');
+    if (q == end || (unsigned char)(*q - '0') >= 10)
+        return false;
+    unsigned int v = 0;
+    while (q < end && (unsigned char)(*q - '0') < 10)
+        v = v*10 + (unsigned int)(*q++ - '0');
+    value = (int)(negative ? 0u - v : v);
+    p = q;
+    return true;
+}
+
+/*! Skips a word in [p, end) the way sscanf()'s "%s" does.
+ * @return True if there was a word.
+ */
+static bool CDFTextSkipWord(const char *&p, const char *end)
+{
+    while (p < end && CDFTextIsSpace(*p))
+        ++p;
+    if (p == end)
+        return false;
+    while (p < end && !CDFTextIsSpace(*p))
+        ++p;
+    return true;
+}
+
+/*! Scans a character in [p, end) the way sscanf()'s " %c" does.
+ * @return True if there was a character; c is left as is otherwise.
+ */
+static bool CDFTextScanChar(const char *&p, const char *end, char &c)
+{
+    while (p < end && CDFTextIsSpace(*p))
+        ++p;
+    if (p == end)
+        return false;
+    c = *p++;
+    return true;
+}
+
+/*! The lines of a piece of text CDF file. */
+class CDFTextLines
+{
+public:
+    /*! Constructor.
+     * @param begin The start of the text.
+     * @param end The end of the text.
+     */
+    CDFTextLines(const char *begin, const char *end) : m_Pos(begin), m_End(end) {}
+
+    /*! Gets the next non-empty line, without its line ending, as ReadNextLine() does.
+     * @param line Set to the start of the line.
+     * @param lineEnd Set to the end of the line.
+     * @return False if there are no more lines.
+     */
+    bool Next(const char *&line, const char *&lineEnd)
+    {
+        while (m_Pos < m_End)
+        {
+            const char *nl = (const char *)memchr(m_Pos, '\n', m_End - m_Pos);
+            const char *e = (nl == NULL ? m_End : nl);
+            line = m_Pos;
+            m_Pos = (nl == NULL ? m_End : nl + 1);
+            if (e > line && e[-1] == '\r')
+                --e;
+            if (e > line)
+            {
+                lineEnd = e;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*! Gets the value of the next "key=value" line.
+     * @param value Set to the first character after the '='.
+     * @param valueEnd Set to the end of the line.
+     * @return False if there are no more lines or the line has no '='.
+     */
+    bool NextValue(const char *&value, const char *&valueEnd)
+    {
+        const char *line;
+        if (Next(line, valueEnd) == false)
+            return false;
+        const char *eq = (const char *)memchr(line, '=', valueEnd - line);
+        if (eq == NULL)
+            return false;
+        value = eq + 1;
+        return true;
+    }
+
+    /*! Skips the next line.
+     * @return False if there are no more lines.
+     */
+    bool Skip()
+    {
+        const char *line, *lineEnd;
+        return Next(line, lineEnd);
+    }
+
+private:
+    /*! The start of the next line. */
+    const char *m_Pos;
+    /*! The end of the text. */
+    const char *m_End;
+};
+
+/*! Block buffered reading of a text CDF file. The blocks are served by a
+ * MappedFileView, so they point straight into the shared mapping of the
+ * file when it is mapped as a whole.
+ */
+class CDFTextFile
+{
+public:
+    /*! Constructor */
+    CDFTextFile() : m_Offset(0), m_Begin(""), m_End(m_Begin), m_Pos(m_Begin), m_AtEnd(true) {}
+
+    /*! Opens the file.
+     * @return True if successful.
+     */
+    bool Open(const std::string &fileName)
+    {
+        return m_View.open(fileName, MappedFile::ADVICE_SEQUENTIAL);
+    }
+
+    /*! Makes the bytes [offset, offset+len) of the file, or those up to its
+     * end, the current block. Previous blocks become invalid.
+     * @return True if successful.
+     */
+    bool Load(int64_t offset, int64_t len)
+    {
+        int64_t size = m_View.size();
+        m_AtEnd = (offset + len >= size);
+        if (m_AtEnd)
+            len = size - offset;
+        const char *p = "";
+        if (len > 0)
+        {
+            p = m_View.map(offset, len);
+            if (p == NULL)
+                return false;
+        }
+        m_Offset = offset;
+        m_Begin = m_Pos = p;
+        m_End = p + len;
+        return true;
+    }
+
+    /*! The start of the current block. */
+    const char *Begin() const { return m_Begin; }
+
+    /*! The end of the current block. */
+    const char *End() const { return m_End; }
+
+    /*! Does the current block reach the end of the file? */
+    bool AtEnd() const { return m_AtEnd; }
+
+    /*! The file offset of the next line. */
+    int64_t Tell() const { return m_Offset + (m_Pos - m_Begin); }
+
+    /*! Reads the next non-empty line into a buffer, like ReadNextLine().
+     * Lines are truncated to len-1 characters, and str is set to an empty
+     * string at the end of the file.
+     */
+    void ReadNextLine(char *str, int len)
+    {
+        str[0] = '\0';
+        while (true)
+        {
+            const char *nl = (const char *)memchr(m_Pos, '\n', m_End - m_Pos);
+            if (nl == NULL && m_AtEnd == false)
+            {
+                // The line continues past the block; load more from its start.
+                if (Load(Tell(), 2*(m_End - m_Begin) + CDF_TEXT_HEADER_BLOCK_SIZE) == false)
+                    return;
+                continue;
+            }
+            if (m_Pos == m_End)
+                return;
+            const char *line = m_Pos;
+            const char *e = (nl == NULL ? m_End : nl);
+            m_Pos = (nl == NULL ? m_End : nl + 1);
+            if (e > line && e[-1] == '\r')
+                --e;
+            if (e > line)
+            {
+                int n = (int)(e - line);
+                if (n > len - 1)
+                    n = len - 1;
+                memcpy(str, line, n);
+                str[n] = '\0';
+                return;
+            }
+        }
+    }
+
+private:
+    /*! The file. */
+    MappedFileView m_View;
+    /*! The file offset of the current block. */
+    int64_t m_Offset;
+    /*! The start of the current block. */
+    const char *m_Begin;
+    /*! The end of the current block. */
+    const char *m_End;
+    /*! The start of the next line. */
+    const char *m_Pos;
+    /*! Does the current block reach the end of the file? */
+    bool m_AtEnd;
+};
+
+/*! Finds the "[UnitN]" lines of the units in a block of a text CDF file,
+ * skipping the "[UnitN_BlockM]" lines of their groups.
+ * @param begin The start of the block, which is the start of a line.
+ * @param end The end of the block.
+ * @param atEnd Does the block reach the end of the file? If not, a line
+ * cut off by the end of the block is ignored.
+ * @param starts Set to the start of each unit line.
+ */
+static void FindTextCDFUnits(const char *begin, const char *end, bool atEnd, std::vector<const char *> &starts)
+{
+    starts.clear();
+    const char *p = begin;
+    while (p < end)
+    {
+        p = (const char *)memchr(p, '[', end - p);
+        if (p == NULL)
+            break;
+        if (p != begin && p[-1] != '\n')
+        {
+            ++p;
+            continue;
+        }
+        const char *nl = (const char *)memchr(p, '\n', end - p);
+        if (nl == NULL && atEnd == false)
+            break;
+        const char *e = (nl == NULL ? end : nl);
+        if (e > p && e[-1] == '\r')
+            --e;
+        if (e - p > 5 && strncmp(p, "[Unit", 5) == 0 && memchr(p, '_', e - p) == NULL)
+            starts.push_back(p);
+        p = e;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+
 bool CCDFFileData::ReadTextFormat()
 {
     // Open the file.
-    std::ifstream instr;
-    instr.open(m_FileName.c_str(), std::ios::in);
+    CDFTextFile instr;
 
     // Check if open
-    if (!instr)
+    if (instr.Open(m_FileName) == false || instr.Load(0, CDF_TEXT_HEADER_BLOCK_SIZE) == false)
     {
         m_strError = "Unable to open the file.";
         return false;
@@ -826,7 +1139,6 @@ bool CCDFFileData::ReadTextFormat()
     const int MAXLINELENGTH = 4096;
     char str[MAXLINELENGTH];
     char *subStr;
-    char *buffer = NULL;
     const char *CDFVERSION1 = "GC1.0";
     const char *CDFVERSION2 = "GC2.0";
     const char *CDFVERSION3 = "GC3.0";
@@ -835,7 +1147,7 @@ bool CCDFFileData::ReadTextFormat()
     const char *CDFVERSION6 = "GC6.0";
 
     // Get the CDF section.
-    ReadNextLine(instr, str, MAXLINELENGTH);
+    instr.ReadNextLine(str, MAXLINELENGTH);
     if (strncmp( str, "[CDF]", 5) != 0)
     {
         m_strError = "Unknown file format.";
@@ -843,7 +1155,7 @@ bool CCDFFileData::ReadTextFormat()
     }
 
     // Get the version number.
-    ReadNextLine(instr, str, MAXLINELENGTH);
+    instr.ReadNextLine(str, MAXLINELENGTH);
     subStr=strchr(str,'=')+1;
     if ( strncmp( subStr, CDFVERSION1, strlen(CDFVERSION1)) == 0)
         m_Header.m_Version = 1;
@@ -861,25 +1173,25 @@ bool CCDFFileData::ReadTextFormat()
 	if (m_Header.m_Version >= 6)
 	{
 		// Get the guid.
-		ReadNextLine(instr, str, MAXLINELENGTH);
+		instr.ReadNextLine(str, MAXLINELENGTH);
 		subStr=strchr(str,'=')+1;
 		m_Header.m_GUID = subStr;
 
 		// Get the integrity md5.
-		ReadNextLine(instr, str, MAXLINELENGTH);
+		instr.ReadNextLine(str, MAXLINELENGTH);
 		subStr=strchr(str,'=')+1;
 		m_Header.m_IntegrityMd5 = subStr;
 	}
 
 	// Get the next section.
-    ReadNextLine(instr, str, MAXLINELENGTH); // [Chip]
-    ReadNextLine(instr, str, MAXLINELENGTH); // name
+    instr.ReadNextLine(str, MAXLINELENGTH); // [Chip]
+    instr.ReadNextLine(str, MAXLINELENGTH); // name
 	if (m_Header.m_Version >= 6)
 	{
 		std::string chiptype;
 		m_Header.m_ChipType = "";
 		m_Header.m_ChipTypes.clear();
-		ReadNextLine(instr, str, MAXLINELENGTH); // chiptype
+		instr.ReadNextLine(str, MAXLINELENGTH); // chiptype
 		while (strncmp(str, "ChipType=", 9) == 0)
 		{
 			chiptype = strchr(str, '=')+1;
@@ -888,7 +1200,7 @@ bool CCDFFileData::ReadTextFormat()
 			{
 				m_Header.m_ChipType = chiptype;
 			}
-			ReadNextLine(instr, str, MAXLINELENGTH); 
+			instr.ReadNextLine(str, MAXLINELENGTH);
 		}
 		if (m_Header.m_ChipType.empty() == true)
 		{
@@ -903,25 +1215,25 @@ bool CCDFFileData::ReadTextFormat()
 		}
 	}
 	else
-		ReadNextLine(instr, str, MAXLINELENGTH); // rows
+		instr.ReadNextLine(str, MAXLINELENGTH); // rows
     subStr = strchr(str, '=')+1;
     m_Header.m_Rows = atoi(subStr);
-    ReadNextLine(instr, str, MAXLINELENGTH); // cols
+    instr.ReadNextLine(str, MAXLINELENGTH); // cols
     subStr=strchr(str,'=')+1;
     m_Header.m_Cols = atoi(subStr);
-    ReadNextLine(instr, str, MAXLINELENGTH); // #ProbeSets
+    instr.ReadNextLine(str, MAXLINELENGTH); // #ProbeSets
     subStr=strchr(str,'=')+1;
     m_Header.m_NumProbeSets = atoi(subStr);
-    ReadNextLine(instr, str, MAXLINELENGTH); // max ProbeSet number
+    instr.ReadNextLine(str, MAXLINELENGTH); // max ProbeSet number
     m_Header.m_NumQCProbeSets = 0;
     if (m_Header.m_Version > 1)
     {
-        ReadNextLine(instr, str, MAXLINELENGTH); // #qc ProbeSets
+        instr.ReadNextLine(str, MAXLINELENGTH); // #qc ProbeSets
         subStr=strchr(str,'=')+1;
         m_Header.m_NumQCProbeSets = atoi(subStr);
-        char strref[400000];
-        ReadNextLine(instr, strref, 400000);    // The reference string.
-        subStr=strchr(strref,'=')+1;
+        std::vector<char> strref(400000);
+        instr.ReadNextLine(&strref[0], 400000);    // The reference string.
+        subStr=strchr(&strref[0],'=')+1;
         m_Header.m_Reference = subStr;
     }
 
@@ -944,14 +1256,14 @@ bool CCDFFileData::ReadTextFormat()
     {
         pQCProbeSet = &m_QCProbeSets[iQCProbeSet];
 
-        ReadNextLine(instr, str, MAXLINELENGTH);    // label [QCUnit...]
-        ReadNextLine(instr, str, MAXLINELENGTH);    // type
+        instr.ReadNextLine(str, MAXLINELENGTH);    // label [QCUnit...]
+        instr.ReadNextLine(str, MAXLINELENGTH);    // type
         subStr=strchr(str,'=')+1;
         pQCProbeSet->m_QCProbeSetType = atoi( subStr);
-        ReadNextLine(instr, str, MAXLINELENGTH);    // #cells
+        instr.ReadNextLine(str, MAXLINELENGTH);    // #cells
         subStr=strchr(str,'=')+1;
         pQCProbeSet->m_NumCells = atoi( subStr);
-        ReadNextLine(instr, str, MAXLINELENGTH);    // cell header
+        instr.ReadNextLine(str, MAXLINELENGTH);    // cell header
 
         // Read the QC cells.
         int xqc;
@@ -963,7 +1275,7 @@ bool CCDFFileData::ReadTextFormat()
         {
             pQCCell = &pQCProbeSet->m_Cells[iqccell];
 
-            ReadNextLine(instr, str, MAXLINELENGTH);
+            instr.ReadNextLine(str, MAXLINELENGTH);
             subStr = strchr(str, '=')+1;
 
             sscanf(subStr, "%d %d %*s %d",
@@ -981,47 +1293,158 @@ bool CCDFFileData::ReadTextFormat()
 
 
     // Allocate for the ProbeSets.
-    int iProbeSet=0;
-    CCDFProbeSetInformation *pProbeSet;
     m_ProbeSets.resize(m_Header.m_NumProbeSets);
 
-
-    // Skip until the ProbeSet section is found
-NextProbeSet:
-    while (1)
+    // Parse the units block by block. A block ends before the last unit
+    // starting in it, unless it reaches the end of the file, so that the
+    // units found in it are complete.
+    int iProbeSet = 0;
+    int64_t offset = instr.Tell();
+    int64_t blockSize = CDF_TEXT_BLOCK_SIZE;
+    std::vector<const char *> starts;
+    while (true)
     {
-        ReadNextLine(instr, str, MAXLINELENGTH);
-        if (strlen(str) > 5 && strncmp(str, "[Unit", 5) == 0 && !strchr(str, '_'))
+        if (instr.Load(offset, blockSize) == false)
+        {
+            m_strError = "Unable to read the file.";
+            return false;
+        }
+        FindTextCDFUnits(instr.Begin(), instr.End(), instr.AtEnd(), starts);
+        const char *end = instr.End();
+        if (instr.AtEnd() == false)
+        {
+            if (starts.size() < 2)
+            {
+                // A unit larger than the block.
+                blockSize *= 2;
+                continue;
+            }
+            end = starts.back();
+            starts.pop_back();
+        }
+
+        if (iProbeSet + (int64_t)starts.size() > m_Header.m_NumProbeSets)
+        {
+            m_strError = "The file has more units than given in its header.";
+            return false;
+        }
+        if (ReadTextUnits(starts, end, iProbeSet) == false)
+            return false;
+        iProbeSet += (int)starts.size();
+
+        if (instr.AtEnd())
             break;
+        offset += end - instr.Begin();
+        blockSize = CDF_TEXT_BLOCK_SIZE;
+    }
+
+    if (iProbeSet < m_Header.m_NumProbeSets)
+    {
+        m_strError = "The file has fewer units than given in its header.";
+        return false;
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+bool CCDFFileData::ReadTextUnits(const std::vector<const char *> &starts, const char *end, int iProbeSet)
+{
+    int nunits = (int)starts.size();
+    R_affx_work_queue queue(nunits, CDF_TEXT_UNITS_PER_TASK);
+    int ntasks = queue.nbrOfChunks();
+    std::vector<std::string> errors(ntasks);
+
+    // Each task parses a run of units into their preallocated probe sets.
+    // The errors are kept per task, such that the first one in the file
+    // is reported.
+    try
+    {
+        R_affx_run_workers(queue, m_NumThreads, [&](int) {
+            int first, last;
+            while (queue.next(first, last))
+            {
+                std::string &error = errors[first / CDF_TEXT_UNITS_PER_TASK];
+                try
+                {
+                    for (int i=first; i<last; i++)
+                    {
+                        const char *unitEnd = (i+1 < nunits ? starts[i+1] : end);
+                        if (ReadTextUnit(starts[i], unitEnd, iProbeSet + i, error) == false)
+                        {
+                            queue.stop();
+                            break;
+                        }
+                    }
+                }
+                catch (const std::exception &e)
+                {
+                    error = e.what();
+                    queue.stop();
+                }
+            }
+        });
+    }
+    catch (const std::exception &e)
+    {
+        m_strError = e.what();
+        return false;
+    }
 
-        if (instr.eof())
-            return true;
+    if (queue.stopped())
+    {
+        for (int task=0; task<ntasks; task++)
+        {
+            if (errors[task].empty() == false)
+            {
+                m_strError = errors[task];
+                break;
+            }
+        }
+        return false;
     }
-        bool expectMisMatch = false;
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+bool CCDFFileData::ReadTextUnit(const char *text, const char *end, int iProbeSet, std::string &error)
+{
+    CDFTextLines lines(text, end);
+    const char *value, *valueEnd;
+    bool expectMisMatch = false;
+
+    // The [UnitN] line.
+    lines.Skip();
+
     // ProbeSet info.
-    pProbeSet = &m_ProbeSets[iProbeSet];
+    CCDFProbeSetInformation *pProbeSet = &m_ProbeSets[iProbeSet];
     pProbeSet->m_Index = iProbeSet;
-    ReadNextLine(instr, str, MAXLINELENGTH); // name (ignore)
-    subStr=strchr(str,'=')+1;
-    m_ProbeSetNames.SetName(iProbeSet, subStr);
-    ReadNextLine(instr, str, MAXLINELENGTH); // direction
-    subStr=strchr(str,'=')+1;
-    pProbeSet->m_Direction = atoi(subStr);
-    ReadNextLine(instr, str, MAXLINELENGTH); // # Lists
-    subStr=strchr(str,'=')+1;
-    int NumCellsPerList=0;
-    if (sscanf(subStr, "%d %d", &pProbeSet->m_NumLists, &NumCellsPerList) != 2)
-        NumCellsPerList = 0;
-    pProbeSet->m_NumCellsPerList = NumCellsPerList;
-    ReadNextLine(instr, str, MAXLINELENGTH); // # cells
-    subStr=strchr(str,'=')+1;
-    pProbeSet->m_NumCells = atoi(subStr);
-    ReadNextLine(instr, str, MAXLINELENGTH); // ProbeSet number
-    subStr=strchr(str,'=')+1;
-    pProbeSet->m_ProbeSetNumber = atoi(subStr);
-    ReadNextLine(instr, str, MAXLINELENGTH); // type
-    subStr=strchr(str,'=')+1;
-    int ival = atoi(subStr);
+    if (lines.NextValue(value, valueEnd) == false) // name (ignore)
+        goto BadUnit;
+    m_ProbeSetNames.SetName(iProbeSet, std::string(value, valueEnd));
+    if (lines.NextValue(value, valueEnd) == false) // direction
+        goto BadUnit;
+    pProbeSet->m_Direction = CDFTextAtoi(value, valueEnd);
+    if (lines.NextValue(value, valueEnd) == false) // # Lists
+        goto BadUnit;
+    {
+        int NumCellsPerList=0;
+        if (CDFTextScanInt(value, valueEnd, pProbeSet->m_NumLists) == false ||
+            CDFTextScanInt(value, valueEnd, NumCellsPerList) == false)
+            NumCellsPerList = 0;
+        pProbeSet->m_NumCellsPerList = NumCellsPerList;
+    }
+    if (lines.NextValue(value, valueEnd) == false) // # cells
+        goto BadUnit;
+    pProbeSet->m_NumCells = CDFTextAtoi(value, valueEnd);
+    if (lines.NextValue(value, valueEnd) == false) // ProbeSet number
+        goto BadUnit;
+    pProbeSet->m_ProbeSetNumber = CDFTextAtoi(value, valueEnd);
+    if (lines.NextValue(value, valueEnd) == false) // type
+        goto BadUnit;
+    {
+    int ival = CDFTextAtoi(value, valueEnd);
 
     typedef enum {
         UNKNOWN_TILE,
@@ -1083,10 +1506,11 @@ NextProbeSet:
         pProbeSet->m_ProbeSetType = UnknownProbeSetType;
         break;
     }
+    }
 
-    ReadNextLine(instr, str, MAXLINELENGTH); // # blocks
-    subStr=strchr(str,'=')+1;
-    pProbeSet->m_NumGroups = atoi(subStr);
+    if (lines.NextValue(value, valueEnd) == false) // # blocks
+        goto BadUnit;
+    pProbeSet->m_NumGroups = CDFTextAtoi(value, valueEnd);
 
     // Determine the number of cells per List if not specified
     // in the CDF file.
@@ -1131,7 +1555,7 @@ NextProbeSet:
 
     // Get the mutation type if block tile. ignore.
     if (pProbeSet->m_ProbeSetType == GenotypingProbeSetType && m_Header.m_Version > 1)
-        ReadNextLine(instr, str, MAXLINELENGTH);
+        lines.Skip();
 
 
     // Read the blocks.
@@ -1143,112 +1567,118 @@ NextProbeSet:
         pBlk->m_GroupIndex = iGroup;
         pBlk->m_ProbeSetIndex = iProbeSet;
 
-        ReadNextLine(instr, str, MAXLINELENGTH); // section name - ignore
-        ReadNextLine(instr, str, MAXLINELENGTH); // name
-        subStr=strchr(str,'=')+1;
-        pBlk->m_Name = subStr;
+        lines.Skip(); // section name - ignore
+        if (lines.NextValue(value, valueEnd) == false) // name
+            goto BadUnit;
+        pBlk->m_Name.assign(value, valueEnd);
 
         if (pProbeSet->m_ProbeSetType == ExpressionProbeSetType)
-            m_ProbeSetNames.SetName(iProbeSet, subStr);
+            m_ProbeSetNames.SetName(iProbeSet, pBlk->m_Name);
 
-        ReadNextLine(instr, str, MAXLINELENGTH); // block number - ignore.
+        lines.Skip(); // block number - ignore.
         if (pProbeSet->m_ProbeSetType == MarkerProbeSetType && m_Header.m_Version > 3)
         {
-            ReadNextLine(instr, str, MAXLINELENGTH);
-            subStr=strchr(str,'=')+1;
-            pBlk->m_WobbleSituation = (uint16_t) strtoul(subStr, &buffer, 10);
-            ReadNextLine(instr, str, MAXLINELENGTH);
-            subStr=strchr(str,'=')+1;
-            pBlk->m_AlleleCode = (uint16_t) strtoul(subStr, &buffer, 10);
+            if (lines.NextValue(value, valueEnd) == false)
+                goto BadUnit;
+            pBlk->m_WobbleSituation = (uint16_t) CDFTextAtoi(value, valueEnd);
+            if (lines.NextValue(value, valueEnd) == false)
+                goto BadUnit;
+            pBlk->m_AlleleCode = (uint16_t) CDFTextAtoi(value, valueEnd);
         }
         if (pProbeSet->m_ProbeSetType == MultichannelMarkerProbeSetType && m_Header.m_Version > 4)
         {
-            ReadNextLine(instr, str, MAXLINELENGTH);
-            subStr=strchr(str,'=')+1;
-            pBlk->m_WobbleSituation = (uint16_t) strtoul(subStr, &buffer, 10);
-            ReadNextLine(instr, str, MAXLINELENGTH);
-            subStr=strchr(str,'=')+1;
-            pBlk->m_AlleleCode = (uint16_t) strtoul(subStr, &buffer, 10);
-            ReadNextLine(instr, str, MAXLINELENGTH);
-            subStr=strchr(str,'=')+1;
-            pBlk->m_Channel = (uint8_t) strtoul(subStr, &buffer, 10);
-            ReadNextLine(instr, str, MAXLINELENGTH);
-            subStr=strchr(str,'=')+1;
-            pBlk->m_RepType = (uint8_t) strtoul(subStr, &buffer, 10);
+            if (lines.NextValue(value, valueEnd) == false)
+                goto BadUnit;
+            pBlk->m_WobbleSituation = (uint16_t) CDFTextAtoi(value, valueEnd);
+            if (lines.NextValue(value, valueEnd) == false)
+                goto BadUnit;
+            pBlk->m_AlleleCode = (uint16_t) CDFTextAtoi(value, valueEnd);
+            if (lines.NextValue(value, valueEnd) == false)
+                goto BadUnit;
+            pBlk->m_Channel = (uint8_t) CDFTextAtoi(value, valueEnd);
+            if (lines.NextValue(value, valueEnd) == false)
+                goto BadUnit;
+            pBlk->m_RepType = (uint8_t) CDFTextAtoi(value, valueEnd);
         }
-        ReadNextLine(instr, str, MAXLINELENGTH); // number of Lists.
-        subStr=strchr(str,'=')+1;
-        pBlk->m_NumLists = atoi(subStr);
-        ReadNextLine(instr, str, MAXLINELENGTH); // number of cells
-        subStr=strchr(str,'=')+1;
-        pBlk->m_NumCells = atoi(subStr);
-        ReadNextLine(instr, str, MAXLINELENGTH); // start position.
-        subStr=strchr(str,'=')+1;
-        pBlk->m_Start = atoi(subStr);
-        ReadNextLine(instr, str, MAXLINELENGTH); // stop position
-        subStr=strchr(str,'=')+1;
-        pBlk->m_Stop = atoi(subStr);
+        if (lines.NextValue(value, valueEnd) == false) // number of Lists.
+            goto BadUnit;
+        pBlk->m_NumLists = CDFTextAtoi(value, valueEnd);
+        if (lines.NextValue(value, valueEnd) == false) // number of cells
+            goto BadUnit;
+        pBlk->m_NumCells = CDFTextAtoi(value, valueEnd);
+        if (lines.NextValue(value, valueEnd) == false) // start position.
+            goto BadUnit;
+        pBlk->m_Start = CDFTextAtoi(value, valueEnd);
+        if (lines.NextValue(value, valueEnd) == false) // stop position
+            goto BadUnit;
+        pBlk->m_Stop = CDFTextAtoi(value, valueEnd);
         pBlk->m_NumCellsPerList = pProbeSet->m_NumCellsPerList;
         if ((pProbeSet->m_ProbeSetType == GenotypingProbeSetType && m_Header.m_Version > 2) ||
             ((pProbeSet->m_ProbeSetType == MarkerProbeSetType || pProbeSet->m_ProbeSetType == CopyNumberProbeSetType) && m_Header.m_Version > 3) ||
             (pProbeSet->m_ProbeSetType == MultichannelMarkerProbeSetType && m_Header.m_Version > 4))
         {
-            ReadNextLine(instr, str, MAXLINELENGTH);
-            subStr=strchr(str,'=')+1;
-            pBlk->m_Direction = atoi(subStr);
+            if (lines.NextValue(value, valueEnd) == false)
+                goto BadUnit;
+            pBlk->m_Direction = CDFTextAtoi(value, valueEnd);
         }
         else
             pBlk->m_Direction = pProbeSet->m_Direction;
 
         // Read the cells.
-        ReadNextLine(instr, str, MAXLINELENGTH); // header
+        lines.Skip(); // header
         CCDFProbeInformation cell;
         pBlk->m_Cells.resize(pBlk->m_NumCells);
-        char unusedstr[64];
         int unusedint;
         unsigned int cellIndex;
         int x,y;
         for (int iCell=0; iCell<pBlk->m_NumCells; iCell++)
         {
-            ReadNextLine(instr, str, MAXLINELENGTH);
-            subStr = strchr(str, '=')+1;
-            int scanCount = 0;
+            if (lines.NextValue(value, valueEnd) == false)
+                goto BadUnit;
+            const char *p = value;
             if (m_Header.m_Version > 3)
             {
-                scanCount = sscanf(subStr, "%d %d %s %s %s %d %hu %d %*c %c %c %d %d %hu",
-                                               &x,
-                                               &y,
-                                               unusedstr,
-                                               unusedstr,
-                                               unusedstr,
-                                               &cell.m_Expos,
-                                               &cell.m_ProbeLength,
-                                               &unusedint,
-                                               &cell.m_PBase,
-                                               &cell.m_TBase,
-                                               &cell.m_ListIndex,
-                                               &unusedint,
-                                               &cell.m_ProbeGrouping);
-                if(scanCount != 13) {
-                  m_strError = "Didn't get 13 entries in scan.";
+                // %d %d %s %s %s %d %hu %d %*c %c %c %d %d %hu
+                int probeLength = 0, probeGrouping = 0;
+                char unusedchar;
+                bool ok = CDFTextScanInt(p, valueEnd, x) &&
+                    CDFTextScanInt(p, valueEnd, y) &&
+                    CDFTextSkipWord(p, valueEnd) &&
+                    CDFTextSkipWord(p, valueEnd) &&
+                    CDFTextSkipWord(p, valueEnd) &&
+                    CDFTextScanInt(p, valueEnd, cell.m_Expos) &&
+                    CDFTextScanInt(p, valueEnd, probeLength) &&
+                    CDFTextScanInt(p, valueEnd, unusedint) &&
+                    CDFTextScanChar(p, valueEnd, unusedchar) &&
+                    CDFTextScanChar(p, valueEnd, cell.m_PBase) &&
+                    CDFTextScanChar(p, valueEnd, cell.m_TBase) &&
+                    CDFTextScanInt(p, valueEnd, cell.m_ListIndex) &&
+                    CDFTextScanInt(p, valueEnd, unusedint) &&
+                    CDFTextScanInt(p, valueEnd, probeGrouping);
+                if(!ok) {
+                  error = "Didn't get 13 entries in scan.";
                   return false;
                 }
+                cell.m_ProbeLength = (unsigned short) probeLength;
+                cell.m_ProbeGrouping = (unsigned short) probeGrouping;
             }
             else
             {
-                scanCount = sscanf(subStr, "%d %d %s %s %s %d %d %*c %c %c %d",
-                                               &x,
-                                               &y,
-                                               unusedstr,
-                                               unusedstr,
-                                               unusedstr,
-                                               &cell.m_Expos,
-                                               &unusedint,
-                                               &cell.m_PBase,
-                                               &cell.m_TBase,
-                                               &cell.m_ListIndex);
-                if(scanCount != 10) {
-                  m_strError = "Didn't get 10 entries in scan.";
+                // %d %d %s %s %s %d %d %*c %c %c %d
+                char unusedchar;
+                bool ok = CDFTextScanInt(p, valueEnd, x) &&
+                    CDFTextScanInt(p, valueEnd, y) &&
+                    CDFTextSkipWord(p, valueEnd) &&
+                    CDFTextSkipWord(p, valueEnd) &&
+                    CDFTextSkipWord(p, valueEnd) &&
+                    CDFTextScanInt(p, valueEnd, cell.m_Expos) &&
+                    CDFTextScanInt(p, valueEnd, unusedint) &&
+                    CDFTextScanChar(p, valueEnd, unusedchar) &&
+                    CDFTextScanChar(p, valueEnd, cell.m_PBase) &&
+                    CDFTextScanChar(p, valueEnd, cell.m_TBase) &&
+                    CDFTextScanInt(p, valueEnd, cell.m_ListIndex);
+                if(!ok) {
+                  error = "Didn't get 10 entries in scan.";
                   return false;
                 }
             }
@@ -1281,9 +1711,11 @@ NextProbeSet:
                 pBlk->m_Stop = cell.m_ListIndex;
         }
     }
+    return true;
 
-    ++iProbeSet;
-    goto NextProbeSet;
+BadUnit:
+    error = "Unable to parse unit " + std::string(m_ProbeSetNames.GetName(iProbeSet)) + ".";
+    return false;
 }
 
 //////////////////////////////////////////////////////////////////////
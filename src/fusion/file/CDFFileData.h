@@ -35,6 +35,7 @@
 
 //
 #include "portability/affy-base-types.h"
+#include "util/MappedFile.h"
 //
 #include <cstring>
 #include <fstream>
@@ -852,8 +853,9 @@ protected:
         iteratorReader.seekg(pos,dir);
     }
 
-    /*! The file stream for the probe set information iterator. */
-    std::ifstream iteratorReader;
+    /*! The file stream for the probe set information iterator.
+     *  It reads through the mapping of the file shared with other readers. */
+    MappedFileStream iteratorReader;
 
     /*! Flag to indicate that only the header part of the file is to be read. */
     bool readHeaderOnly;
@@ -876,6 +878,9 @@ protected:
     /*! A string to hold an error message upon read failures. */
     std::string m_strError;
 
+    /*! The number of threads used to parse the units of a text format file. */
+    int m_NumThreads;
+
     /*! Opens the file for reading.
      * @return True if successful.
      */
@@ -886,6 +891,23 @@ protected:
      */
     bool ReadTextFormat();
 
+    /*! Reads units of a text format CDF file into their probe sets, in parallel.
+     * @param starts The start of the text of each unit.
+     * @param end The end of the text of the last unit.
+     * @param iProbeSet The index of the first unit.
+     * @return True if successful.
+     */
+    bool ReadTextUnits(const std::vector<const char *> &starts, const char *end, int iProbeSet);
+
+    /*! Reads a unit of a text format CDF file into its probe set.
+     * @param text The start of the text of the unit, its [UnitN] line.
+     * @param end The end of the text of the unit.
+     * @param iProbeSet The index of the unit.
+     * @param error Set to a message if the unit can not be read.
+     * @return True if successful.
+     */
+    bool ReadTextUnit(const char *text, const char *end, int iProbeSet, std::string &error);
+
     /*! Reads an XDA format CDF file.
      * @return True if successful.
      */
@@ -907,6 +929,16 @@ public:
      */
     std::string GetFileName() const { return m_FileName; }
 
+    /*! Sets the number of threads used to parse the units of a text format file.
+     * @param n The number of threads, at least 1.
+     */
+    void SetNumThreads(int n) { m_NumThreads = (n < 1 ? 1 : n); }
+
+    /*! Gets the number of threads used to parse the units of a text format file.
+     * @return The number of threads.
+     */
+    int GetNumThreads() const { return m_NumThreads; }
+
     /*! Gets the header object.
      * @return The CDF file header object.
      */
@@ -933,6 +965,14 @@ public:
      */
     std::string GetProbeSetName(int index);
 
+    /*! Gets the names of a range of probe sets. The names of an XDA file are read
+     *  with one read rather than one per name.
+     * @param first The zero-based index of the first probe set.
+     * @param count The number of probe sets.
+     * @param names Receives the probe set names.
+     */
+    void GetProbeSetNames(int first, int count, std::vector<std::string> &names);
+
     /*! Gets the chip type (probe array type) of the CDF file.
      * @return The chip type. This is just the name (without extension) of the CDF file.
      */
@@ -889,6 +889,9 @@ bool CCELFileData::ReadXDABCel(bool bReadHeaderOnly)
   gzclose(instr);
 #endif
 
+	// The cell data follows the header.
+	m_DataStartFilePos = iHeaderBytes;
+
 	// Read the remaining data.
 	if (bReadHeaderOnly)
 		return true;
@@ -985,55 +988,22 @@ bool CCELFileData::ReadXDABCel(bool bReadHeaderOnly)
   gzclose(instr);
 
 #else
-#ifdef _MSC_VER
-	// Memory map file on windows...
-	SYSTEM_INFO info;
-	GetSystemInfo(&info);
-	m_hFile = CreateFile(m_FileName.c_str(), GENERIC_READ, FILE_SHARE_READ,
-			NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL/*FILE_FLAG_RANDOM_ACCESS*/);
-	if (m_hFile == INVALID_HANDLE_VALUE)
-	{
-		SetError("Failed to open the file for win memory mapping.");
-		return false;
-	}
-	m_hFileMap = CreateFileMapping(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
-	if (m_hFileMap != NULL)
-	{
-		m_lpFileMap = MapViewOfFile(m_hFileMap, FILE_MAP_READ, 0, 0, 0);
-		if (m_lpFileMap == NULL)
-		{
-			Close();
-			SetError("Unable to map view for the win memory map file.");
-			return false;
-		}
-		else
-		{
-			m_lpData = (char *)(m_lpFileMap) + iHeaderBytes;
-		}
-	}
-#else
-  // printf("OPEN: non memory mapped.\n"); //
-  m_lpFileMap=NULL;
-  m_File=fopen(m_FileName.c_str(),"r");
-  if (m_File==NULL) {
-    SetError("Failed to open file for non-memap open.");
+  // Map the data through the shared mapping, so readers of the same
+  // file share one mapping and page cache.  It falls back on buffered
+  // reads if the file can not be mapped.
+  if (m_MappedView.open(m_FileName, MappedFile::ADVICE_SEQUENTIAL)==false) {
+    SetError("Failed to open file for memory mapping.");
     return false;
   }
-  // skip the header
-  fseek(m_File,iHeaderBytes,SEEK_SET);
-  // printf("fpos=%u",ftell(m_File)); // debug
-  // read the entire file into memory...
-  int32_t datasize = GetFileSize()-iHeaderBytes;
-  m_lpData = new char[datasize];
-  size_t read=fread(m_lpData,1,datasize,m_File);
-  //printf("read=%u  iHeaderBytes=%u\n",read,iHeaderBytes);
-  if (read!=datasize) {
+  int64_t datasize = m_MappedView.size()-iHeaderBytes;
+  m_lpData = (char*)m_MappedView.map(iHeaderBytes, datasize);
+  if (m_lpData==NULL) {
+    m_MappedView.close();
     SetError("Unable to read the entire file.");
     return false;
   }
-  //
-  fclose(m_File);
-#endif
+  // the data is owned by the mapping; see Munmap().
+  m_lpFileMap = m_lpData;
 #endif // CELFILE_USE_ZLIB
 
 #endif // CELFILE_USE_MEMMAP
@@ -1255,6 +1225,9 @@ bool CCELFileData::ReadTranscriptomeBCel(bool bReadHeaderOnly)
 	// Set grid coordinates
 	m_HeaderData.ParseCorners();
 
+	// The cell data follows the header.
+	m_DataStartFilePos = iHeaderBytes;
+
 	// Read the remaining data.
 	if (bReadHeaderOnly)
 		return true;
@@ -1536,6 +1509,9 @@ bool CCELFileData::ReadCompactBCel(bool bReadHeaderOnly)
   gzclose(instr);
 #endif
 
+	// The cell data follows the header.
+	m_DataStartFilePos = iHeaderBytes;
+
 	// Read the remaining data.
 	if (bReadHeaderOnly)
 		return true;
@@ -1674,7 +1650,7 @@ void CCELFileData::EnsureNotMmapped()
 
 		// duplicate the data
 		size_t bytecnt = GetCols() * GetRows() * sizeof(CELFileTranscriptomeEntryType);
-		CELFileTranscriptomeEntryType *tmpptr = (CELFileTranscriptomeEntryType *) malloc(bytecnt);
+		CELFileTranscriptomeEntryType *tmpptr = new CELFileTranscriptomeEntryType[GetCols() * GetRows()];
 		memcpy(tmpptr, m_pTransciptomeEntries, bytecnt);
 
 		// discard the old map
@@ -1689,7 +1665,8 @@ void CCELFileData::EnsureNotMmapped()
 
 		// duplicate the data
 		size_t bytecnt = GetCols() * GetRows() * sizeof(CELFileEntryType);
-		CELFileEntryType *tmpptr = (CELFileEntryType *) malloc(bytecnt);
+		// allocated with new[] as Munmap() releases it with delete[]
+		CELFileEntryType *tmpptr = new CELFileEntryType[GetCols() * GetRows()];
 		memcpy(tmpptr, m_pEntries, bytecnt);
 
 		// discard the old map
@@ -1704,7 +1681,7 @@ void CCELFileData::EnsureNotMmapped()
 
 		// duplicate the data
 		size_t bytecnt = GetCols() * GetRows() * sizeof(unsigned short);
-		unsigned short *tmpptr = (unsigned short *) malloc(bytecnt);
+		unsigned short *tmpptr = new unsigned short[GetCols() * GetRows()];
 		memcpy(tmpptr, m_pMeanIntensities, bytecnt);
 
 		// discard the old map
@@ -2044,6 +2021,7 @@ void CCELFileData::Clear()
 	m_HeaderData.Clear();
 	m_MaskedCells.clear();
 	m_Outliers.clear();
+	m_DataStartFilePos = 0;
 
   delete [] m_pEntries; 
   m_pEntries=NULL;
@@ -2061,6 +2039,17 @@ void CCELFileData::Clear()
 ///////////////////////////////////////////////////////////////////////////////
 void CCELFileData::Munmap() 
 {
+	// Data served by the shared mapping is released with it.
+	if (m_MappedView.isOpen()) {
+		m_lpData = NULL;
+		m_pTransciptomeEntries = NULL;
+		m_pEntries = NULL;
+		m_pMeanIntensities = NULL;
+		m_MappedView.close();
+		m_lpFileMap = NULL;
+		return;
+	}
+
 	// If there isnt a mapping we dont have to munmap...
 	if (m_lpFileMap == NULL) {
     // ...but we should get rid of memory which might have been alloced.
@@ -2442,25 +2431,25 @@ int CCELFileData::GetIntensities(int index,std::vector<float>& intensities)
 	if (m_FileFormat == TEXT_CEL) 
 	{
     for (int idx=idx_start;idx<idx_end;idx++) {
-      intensities[idx]=MmGetFloat_I(&m_pEntries[idx].Intensity);
+      intensities[idx-idx_start]=MmGetFloat_I(&m_pEntries[idx].Intensity);
     }
   }
 	else if (m_FileFormat == XDA_BCEL) 
 	{
     for (int idx=idx_start;idx<idx_end;idx++) {
-      intensities[idx]=MmGetFloat_I(&m_pEntries[idx].Intensity);
+      intensities[idx-idx_start]=MmGetFloat_I(&m_pEntries[idx].Intensity);
     }
 	}
 	else if (m_FileFormat == TRANSCRIPTOME_BCEL) 
 	{
     for (int idx=idx_start;idx<idx_end;idx++) {
-      intensities[idx]=MmGetUInt16_N(&m_pTransciptomeEntries[idx].Intensity);
+      intensities[idx-idx_start]=MmGetUInt16_N(&m_pTransciptomeEntries[idx].Intensity);
     }
 	}
 	else if (m_FileFormat == COMPACT_BCEL) 
 	{
     for (int idx=idx_start;idx<idx_end;idx++) {
-      intensities[idx]=MmGetUInt16_I(&m_pMeanIntensities[idx]);
+      intensities[idx-idx_start]=MmGetUInt16_I(&m_pMeanIntensities[idx]);
     }
 	}
 	else {
@@ -2518,6 +2507,32 @@ float CCELFileData::GetStdv(int index)
 	return fStdev;
 }
 
+int CCELFileData::GetStdvs(int index,std::vector<float>& stdvs)
+{
+  int idx_start=index;
+  int idx_end=idx_start+stdvs.size();
+	assert((idx_start >= 0) && (idx_end <= m_HeaderData.GetCells()));
+
+	if ((m_FileFormat == TEXT_CEL) || (m_FileFormat == XDA_BCEL))
+	{
+    for (int idx=idx_start;idx<idx_end;idx++) {
+      stdvs[idx-idx_start]=MmGetFloat_I(&m_pEntries[idx].Stdv);
+    }
+	}
+	else if (m_FileFormat == TRANSCRIPTOME_BCEL)
+	{
+    for (int idx=idx_start;idx<idx_end;idx++) {
+      stdvs[idx-idx_start]=MmGetUInt16_N(&m_pTransciptomeEntries[idx].Stdv);
+    }
+	}
+	else if (m_FileFormat == COMPACT_BCEL)
+    std::fill(stdvs.begin(), stdvs.end(), 0.0f);
+	else
+		assert(0);
+
+  return 0;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///  public  GetPixels
 ///  \brief Retrieve number of pixels of specified cell
@@ -2563,6 +2578,32 @@ short CCELFileData::GetPixels(int index)
 	return sPixels;
 }
 
+int CCELFileData::GetPixels(int index,std::vector<short>& pixels)
+{
+  int idx_start=index;
+  int idx_end=idx_start+pixels.size();
+	assert((idx_start >= 0) && (idx_end <= m_HeaderData.GetCells()));
+
+	if ((m_FileFormat == TEXT_CEL) || (m_FileFormat == XDA_BCEL))
+	{
+    for (int idx=idx_start;idx<idx_end;idx++) {
+      pixels[idx-idx_start]=MmGetInt16_I(&m_pEntries[idx].Pixels);
+    }
+	}
+	else if (m_FileFormat == TRANSCRIPTOME_BCEL)
+	{
+    for (int idx=idx_start;idx<idx_end;idx++) {
+      pixels[idx-idx_start]=MmGetUInt8(&m_pTransciptomeEntries[idx].Pixels);
+    }
+	}
+	else if (m_FileFormat == COMPACT_BCEL)
+    std::fill(pixels.begin(), pixels.end(), 0);
+	else
+		assert(0);
+
+  return 0;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///  public  IsMasked
 ///  \brief Determine if specified cell is masked
@@ -2885,6 +2926,7 @@ CCELFileData::CCELFileData()
 	m_FileFormat = XDA_BCEL;
 	m_lpFileMap = NULL;
 	m_lpData = NULL;
+	m_DataStartFilePos = 0;
 	m_bReadMaskedCells = true;
 	m_bReadOutliers = true;
 	m_nReadState = CEL_ALL;
@@ -3118,6 +3160,8 @@ void CCELFileData::SetCellEntry(int x, int y, CELFileEntryType *pEntry)
 ///////////////////////////////////////////////////////////////////////////////
 void CCELFileData::SetCellEntry(int index, CELFileEntryType *pEntry)
 {
+	// The data of a mapped file is read-only; modify a private copy.
+	EnsureNotMmapped();
 	m_pEntries[index] = *pEntry;
 }
 
@@ -3157,6 +3201,8 @@ void CCELFileData::SetTranscriptomeCellEntry(int x, int y, CELFileTranscriptomeE
 ///////////////////////////////////////////////////////////////////////////////
 void CCELFileData::SetTranscriptomeCellEntry(int index, CELFileTranscriptomeEntryType *pEntry)
 {
+	// The data of a mapped file is read-only; modify a private copy.
+	EnsureNotMmapped();
 	m_pTransciptomeEntries[index] = *pEntry;
 }
 
@@ -3188,6 +3234,8 @@ void CCELFileData::SetIntensity(int x, int y, float intensity)
 void CCELFileData::SetIntensity(int index, float intensity)
 {
 	assert((index >= 0) && (index < m_HeaderData.GetCells()));
+	// The data of a mapped file is read-only; modify a private copy.
+	EnsureNotMmapped();
 
 	if (m_FileFormat == TEXT_CEL) 
 	{
@@ -3243,6 +3291,8 @@ void CCELFileData::SetStdv(int x, int y, float stdev)
 void CCELFileData::SetStdv(int index, float stdev)
 {
 	assert((index >= 0) && (index < m_HeaderData.GetCells()));
+	// The data of a mapped file is read-only; modify a private copy.
+	EnsureNotMmapped();
 
 	if (m_FileFormat == TRANSCRIPTOME_BCEL)
 	{
@@ -3285,6 +3335,8 @@ void CCELFileData::SetPixels(int x, int y, short pixels)
 void CCELFileData::SetPixels(int index, short pixels)
 {
 	assert((index >= 0) && (index < m_HeaderData.GetCells()));
+	// The data of a mapped file is read-only; modify a private copy.
+	EnsureNotMmapped();
 
 	if (m_FileFormat == TRANSCRIPTOME_BCEL)
 		//m_pTransciptomeEntries[index].Pixels = (unsigned char) pixels;
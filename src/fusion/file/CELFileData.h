@@ -35,6 +35,7 @@
 #include "file/TagValuePair.h"
 //
 #include "portability/affy-base-types.h"
+#include "util/MappedFile.h"
 //
 #include <cstring>
 #include <map>
@@ -601,10 +602,15 @@ protected:
 	size_t m_MapLen;
 #endif
 
+	/// Byte offset of the cell data in binary CEL files
+	uint32_t m_DataStartFilePos;
+
 	/// Pointer to memory mapping data 
 	char  *m_lpData;
 	/// Pointer to memory mapping file view
 	void  *m_lpFileMap;
+	/// The shared mapping of the file, used for XDA files
+	MappedFileView m_MappedView;
 
 	/*! Opens the file.
 	 * @param bReadHeaderOnly Flag indicating if the header is only to be read.
@@ -916,12 +922,24 @@ public:
 	 */
 	float GetStdv(int x, int y);
 
+  /// @brief     Get a vector of stdv values with one call.
+  /// @param     index         starting index
+  /// @param     stdvs         vector to fill, its size is the number of values.
+  /// @return    non-zero on error
+	int GetStdvs(int index,std::vector<float>& stdvs);
+
 	/*! Retrieves a CEL file pixel count.
 	 * @param index The index to the CEL file entries.
 	 * @return The CEL file pixel count.
 	 */
 	short GetPixels(int index);
 
+  /// @brief     Get a vector of pixel counts with one call.
+  /// @param     index         starting index
+  /// @param     pixels        vector to fill, its size is the number of values.
+  /// @return    non-zero on error
+	int GetPixels(int index,std::vector<short>& pixels);
+
 	/*! Retrieves a CEL file pixel count.
 	 * @param x The X coordinate.
 	 * @param y The Y coordinate.
@@ -1036,6 +1054,11 @@ public:
 	 */
 	int  GetFileFormat() { return m_FileFormat; }
 
+	/*! Gets the byte offset of the cell data, known once the header of a binary file is read.
+	 * @return The offset or 0 for text files.
+	 */
+	uint32_t GetDataStartFilePos() { return m_DataStartFilePos; }
+
 	/*! Sets the file format type.
 	 * @param i The file format type.
 	 */
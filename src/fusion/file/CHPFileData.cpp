@@ -251,39 +251,83 @@ void CCHPFileData::Clear()
 	m_Header.Clear();
 	m_FileName = "";
 	m_strError = "";
-	int n = (int) m_ProbeSetResults.size();
-	for (int i=0; i<n; i++)
+	std::vector<CExpressionProbeSetResults>().swap(m_ExpressionResults);
+	std::vector<CGenotypeProbeSetResults>().swap(m_GenotypingResults);
+	std::vector<CUniversalProbeSetResults>().swap(m_UniversalResults);
+}
+
+//////////////////////////////////////////////////////////////////////
+
+void CCHPFileData::AllocateResults(CCHPFileHeader::GeneChipAssayType assayType, int numProbeSets)
+{
+	m_ExpressionResults.clear();
+	m_GenotypingResults.clear();
+	m_UniversalResults.clear();
+	switch (assayType)
 	{
-		delete m_ProbeSetResults[i];
-		m_ProbeSetResults[i]=NULL;
+	case CCHPFileHeader::Expression:
+		m_ExpressionResults.resize(numProbeSets);
+		break;
+
+	case CCHPFileHeader::Genotyping:
+		m_GenotypingResults.resize(numProbeSets);
+		break;
+
+	case CCHPFileHeader::Universal:
+		m_UniversalResults.resize(numProbeSets);
+		break;
+
+	default:
+		break;
 	}
-	m_ProbeSetResults.erase(m_ProbeSetResults.begin(), m_ProbeSetResults.end());
 }
 
 //////////////////////////////////////////////////////////////////////
 
 CExpressionProbeSetResults *CCHPFileData::GetExpressionResults(int index)
 {
-	if (index < m_Header.GetNumProbeSets() && m_Header.GetAssayType() == CCHPFileHeader::Expression)
+	if (index >= 0 && index < (int) m_ExpressionResults.size() && m_Header.GetAssayType() == CCHPFileHeader::Expression)
 	{
-		return (CExpressionProbeSetResults *) m_ProbeSetResults[index];
+		return &m_ExpressionResults[index];
 	}
 	return NULL;
 }
 
 //////////////////////////////////////////////////////////////////////
 
+bool CCHPFileData::GetExpressionResults(int first, int count, CExpressionProbeSetResults *results)
+{
+	if (first < 0 || count < 0 || first > (int) m_ExpressionResults.size() - count || m_Header.GetAssayType() != CCHPFileHeader::Expression)
+		return false;
+	for (int i=0; i<count; i++)
+		results[i] = m_ExpressionResults[first+i];
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+
 CGenotypeProbeSetResults *CCHPFileData::GetGenotypingResults(int index)
 {
-	if (index < m_Header.GetNumProbeSets() && m_Header.GetAssayType() == CCHPFileHeader::Genotyping)
+	if (index >= 0 && index < (int) m_GenotypingResults.size() && m_Header.GetAssayType() == CCHPFileHeader::Genotyping)
 	{
-		return (CGenotypeProbeSetResults *) m_ProbeSetResults[index];
+		return &m_GenotypingResults[index];
 	}
 	return NULL;
 }
 
 //////////////////////////////////////////////////////////////////////
 
+bool CCHPFileData::GetGenotypingResults(int first, int count, CGenotypeProbeSetResults *results)
+{
+	if (first < 0 || count < 0 || first > (int) m_GenotypingResults.size() - count || m_Header.GetAssayType() != CCHPFileHeader::Genotyping)
+		return false;
+	for (int i=0; i<count; i++)
+		results[i] = m_GenotypingResults[first+i];
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+
 CResequencingResults *CCHPFileData::GetResequencingResults()
 {
 	return (m_Header.GetAssayType() == CCHPFileHeader::Resequencing ? &m_ReseqResults : NULL);
@@ -293,15 +337,26 @@ CResequencingResults *CCHPFileData::GetResequencingResults()
 
 CUniversalProbeSetResults *CCHPFileData::GetUniversalResults(int index)
 {
-	if (index < m_Header.GetNumProbeSets() && m_Header.GetAssayType() == CCHPFileHeader::Universal)
+	if (index >= 0 && index < (int) m_UniversalResults.size() && m_Header.GetAssayType() == CCHPFileHeader::Universal)
 	{
-		return (CUniversalProbeSetResults *) m_ProbeSetResults[index];
+		return &m_UniversalResults[index];
 	}
 	return NULL;
 }
 
 //////////////////////////////////////////////////////////////////////
 
+bool CCHPFileData::GetUniversalResults(int first, int count, CUniversalProbeSetResults *results)
+{
+	if (first < 0 || count < 0 || first > (int) m_UniversalResults.size() - count || m_Header.GetAssayType() != CCHPFileHeader::Universal)
+		return false;
+	for (int i=0; i<count; i++)
+		results[i] = m_UniversalResults[first+i];
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+
 CUniversalProbeSetResults CUniversalProbeSetResults::operator = (CUniversalProbeSetResults &src)
 {
 	SetBackground(src.GetBackground());
@@ -635,7 +690,7 @@ bool CCHPFileData::Open(bool bReadHeaderOnly)
 		// Read the probe set data
 		if (m_Header.m_AssayType == CCHPFileHeader::Expression)
 		{
-			m_ProbeSetResults.resize(m_Header.m_NumProbeSets);
+			AllocateResults(m_Header.m_AssayType, m_Header.m_NumProbeSets);
 			// Get the type of analysis
 			ReadUInt8(instr, ucval); // EXPRESSION_ABSOLUTE_STAT_ANALYSIS or EXPRESSION_COMPARISON_STAT_ANALYSIS
 			ReadInt32_I(instr, ival);
@@ -650,8 +705,7 @@ bool CCHPFileData::Open(bool bReadHeaderOnly)
 			// Read each probe set result.
 			for (int iset=0; iset<m_Header.m_NumProbeSets; iset++)
 			{
-				CExpressionProbeSetResults * pResults = new CExpressionProbeSetResults;
-				m_ProbeSetResults[iset] = pResults;
+				CExpressionProbeSetResults * pResults = &m_ExpressionResults[iset];
 
 				// Read the absolute data.
 				ReadUInt8(instr, ucval);
@@ -699,14 +753,13 @@ bool CCHPFileData::Open(bool bReadHeaderOnly)
 		}
 		else if (m_Header.m_AssayType == CCHPFileHeader::Genotyping)
 		{
-			m_ProbeSetResults.resize(m_Header.m_NumProbeSets);
+			AllocateResults(m_Header.m_AssayType, m_Header.m_NumProbeSets);
 			const int DM_ALG_RESULT_SIZE = 21;
 			int32_t dataSize=0;
 			ReadInt32_I(instr, dataSize);
 			for (int iset=0; iset<m_Header.m_NumProbeSets; iset++)
 			{
-				CGenotypeProbeSetResults * pResults = new CGenotypeProbeSetResults;
-				m_ProbeSetResults[iset] = pResults;
+				CGenotypeProbeSetResults * pResults = &m_GenotypingResults[iset];
 
 				// Read probe set result.
 				ReadUInt8(instr, ucval);
@@ -735,14 +788,13 @@ bool CCHPFileData::Open(bool bReadHeaderOnly)
 		}
 		else if (m_Header.m_AssayType == CCHPFileHeader::Universal)
 		{
-			m_ProbeSetResults.resize(m_Header.m_NumProbeSets);
+			AllocateResults(m_Header.m_AssayType, m_Header.m_NumProbeSets);
 			int32_t dataSize=0;
 			float bg;
 			ReadInt32_I(instr, dataSize);
 			for (int iset=0; iset<m_Header.m_NumProbeSets; iset++)
 			{
-				CUniversalProbeSetResults * pResults = new CUniversalProbeSetResults;
-				m_ProbeSetResults[iset] = pResults;
+				CUniversalProbeSetResults * pResults = &m_UniversalResults[iset];
 
 				// Read probe set result.
 				ReadFloat_I(instr, bg);
@@ -973,11 +1025,10 @@ bool CCHPFileData::Open(bool bReadHeaderOnly)
 		if (m_Header.m_AssayType == CCHPFileHeader::Expression)
 		{
 			// Read each probe set result.
-			m_ProbeSetResults.resize(m_Header.m_NumProbeSets);
+			AllocateResults(m_Header.m_AssayType, m_Header.m_NumProbeSets);
 			for (int iset=0; iset<m_Header.m_NumProbeSets; iset++)
 			{
-				CExpressionProbeSetResults * pResults = new CExpressionProbeSetResults;
-				m_ProbeSetResults[iset] = pResults;
+				CExpressionProbeSetResults * pResults = &m_ExpressionResults[iset];
 
 				ReadInt32_I(instr, ival);
 				pResults->NumPairs = ival;
@@ -1106,11 +1157,10 @@ bool CCHPFileData::Open(bool bReadHeaderOnly)
 		}
 		else if (m_Header.m_AssayType == CCHPFileHeader::Genotyping)
 		{
-			m_ProbeSetResults.resize(m_Header.m_NumProbeSets);
+			AllocateResults(m_Header.m_AssayType, m_Header.m_NumProbeSets);
 			for (int iset=0; iset<m_Header.m_NumProbeSets; iset++)
 			{
-				CGenotypeProbeSetResults * pResults = new CGenotypeProbeSetResults;
-				m_ProbeSetResults[iset] = pResults;
+				CGenotypeProbeSetResults * pResults = &m_GenotypingResults[iset];
 
 				// Unused data
 				int ngroups=0;
@@ -1228,7 +1278,7 @@ bool CCHPFileData::Open(bool bReadHeaderOnly)
 		}
 		else if (m_Header.m_AssayType == CCHPFileHeader::Universal)
 		{
-			m_ProbeSetResults.resize(m_Header.m_NumProbeSets);
+			AllocateResults(m_Header.m_AssayType, m_Header.m_NumProbeSets);
 			int32_t unused_32;
 			uint16_t unused_u16;
 			int8_t unused_8;
@@ -1239,8 +1289,7 @@ bool CCHPFileData::Open(bool bReadHeaderOnly)
 			// Read each probe set result.
 			for (int iset=0; iset<m_Header.m_NumProbeSets; iset++)
 			{
-				CUniversalProbeSetResults * pResults = new CUniversalProbeSetResults;
-				m_ProbeSetResults[iset] = pResults;
+				CUniversalProbeSetResults * pResults = &m_UniversalResults[iset];
 
 				// unused (wildtype) length(int), string(len)
 				int ibase;
@@ -715,8 +715,20 @@ protected:
 	/*! A string to hold an error message associated with a read operation */
 	std::string m_strError;
 
-	/*! The vector of probe set results */
-	std::vector<CProbeSetResults *> m_ProbeSetResults;
+	/*! The expression probe set results, stored contiguously. */
+	std::vector<CExpressionProbeSetResults> m_ExpressionResults;
+
+	/*! The genotyping probe set results, stored contiguously. */
+	std::vector<CGenotypeProbeSetResults> m_GenotypingResults;
+
+	/*! The universal (tag array) probe set results, stored contiguously. */
+	std::vector<CUniversalProbeSetResults> m_UniversalResults;
+
+	/*! Allocates the results of the given assay type.
+	 * @param assayType The assay type of the results.
+	 * @param numProbeSets The number of probe sets.
+	 */
+	void AllocateResults(CCHPFileHeader::GeneChipAssayType assayType, int numProbeSets);
 
 	/*! The resequencing results. */
 	CResequencingResults m_ReseqResults;
@@ -751,6 +763,30 @@ public:
 	 */
 	CUniversalProbeSetResults *GetUniversalResults(int index);
 
+	/*! Copies a block of expression probe set results.
+	 * @param first The index of the first result to copy.
+	 * @param count The number of results to copy.
+	 * @param results The array to copy to, holding at least count elements.
+	 * @return True if successful.
+	 */
+	bool GetExpressionResults(int first, int count, CExpressionProbeSetResults *results);
+
+	/*! Copies a block of genotyping probe set results.
+	 * @param first The index of the first result to copy.
+	 * @param count The number of results to copy.
+	 * @param results The array to copy to, holding at least count elements.
+	 * @return True if successful.
+	 */
+	bool GetGenotypingResults(int first, int count, CGenotypeProbeSetResults *results);
+
+	/*! Copies a block of universal (tag array) probe set results.
+	 * @param first The index of the first result to copy.
+	 * @param count The number of results to copy.
+	 * @param results The array to copy to, holding at least count elements.
+	 * @return True if successful.
+	 */
+	bool GetUniversalResults(int first, int count, CUniversalProbeSetResults *results);
+
 	/*! Returns the resequencing results.
 	 * @return The resequencing results.
 	 */
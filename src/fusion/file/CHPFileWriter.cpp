@@ -130,34 +130,7 @@ void CCHPFileWriter::InitializeForWriting(int numRows, int numCols, int numProbe
 		return;
 
 	// Allocate memory for probe set results
-	m_ProbeSetResults.clear();
-	if (allocateMemory == true)
-	{
-		m_ProbeSetResults.resize(numProbeSets);
-		CProbeSetResults *pResults;
-		for (int iset=0; iset<numProbeSets; iset++)
-		{
-			switch (probeSetType)
-			{
-				case affxcdf::ExpressionProbeSetType:
-					pResults = new CExpressionProbeSetResults;
-					break;
-
-				case affxcdf::GenotypingProbeSetType:
-					pResults = new CGenotypeProbeSetResults;
-					break;
-
-				case affxcdf::TagProbeSetType:
-					pResults = new CUniversalProbeSetResults;
-					break;
-
-				default:
-					pResults = NULL;
-					break;
-			}
-			m_ProbeSetResults[iset] = pResults;
-		}
-	}
+	AllocateResults(m_Header.GetAssayType(), (allocateMemory == true ? numProbeSets : 0));
 }
 
 //////////////////////////////////////////////////////////////////////
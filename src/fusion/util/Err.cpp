@@ -29,6 +29,8 @@
 //
 #include "util/Err.h"
 //
+#include "util/ReaderContext.h"
+//
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
@@ -49,9 +51,13 @@ void Err::setErrorPrefix(const std::string& prefix) {
   /** 
    * @brief This function gets around the problem of static variable
    * initialization as local static variables work more consistently.
-   * @return Param - Our static parameters for this class.
+   * @return Param - Our static parameters for this class, or those of
+   * the ReaderContext installed on the calling thread.
    */
   Err::Param &Err::getParam() {
+    ReaderContext *context = ReaderContext::getCurrent();
+    if (context != NULL)
+      return context->getErrParam();
     static Param m_Param;
     return m_Param;
   }
@@ -74,6 +74,12 @@ class APTLIB_API Err {
       m_NewLineOnError = true;
     }
 
+    /** Start with the given error handler, which is deleted with us. */
+    Param(ErrHandler *handler) {
+      m_ErrHandlers.push_back(handler);
+      m_NewLineOnError = true;
+    }
+
     /** Cleanup any error handlers that are still around. */
     ~Param() {
       for(unsigned int i = 0; i < m_ErrHandlers.size(); i++) {
@@ -88,7 +94,8 @@ class APTLIB_API Err {
   /**
    * @brief This function gets around the problem of static variable
    * initialization as local static variables work more consistently.
-   * @return Param - Our static parameters for this class.
+   * @return Param - Our static parameters for this class, or those of
+   * the ReaderContext installed on the calling thread.
    */
   static Param &getParam();
 
@@ -29,6 +29,7 @@
 //
 #include "util/Convert.h"
 #include "util/Err.h"
+#include "util/ReaderContext.h"
 #include "util/Util.h"
 //
 #include <algorithm>
@@ -204,23 +205,35 @@ AptErr_t Fs::m_err_num;
 std::string Fs::m_err_msg;
 
 AptErr_t Fs::setErr(AptErr_t err_num,const std::string& err_msg,bool abortOnErr) {
+  ReaderContext* context=ReaderContext::getCurrent();
+  if (context!=NULL) {
+    context->m_FsErrNum=err_num;
+    context->m_FsErrMsg=err_msg;
+    return err_num;
+  }
   m_err_num=err_num;
   m_err_msg=err_msg;
   return m_err_num;
 }
 
 AptErr_t Fs::getErrNum() {
+  ReaderContext* context=ReaderContext::getCurrent();
+  if (context!=NULL) {
+    return context->m_FsErrNum;
+  }
   return m_err_num;
 }
 
 std::string Fs::getErrMsg() {
+  ReaderContext* context=ReaderContext::getCurrent();
+  if (context!=NULL) {
+    return context->m_FsErrMsg;
+  }
   return m_err_msg;
 }
 
 AptErr_t Fs::clearErr() {
-  m_err_num=APT_OK;
-  m_err_msg="";
-  return m_err_num;
+  return setErr(APT_OK,"",false);
 }
 
 /// translate
@@ -133,9 +133,8 @@ private:
 
 public:
 
-  // @todo: Make these thread local?
-  //        A mutex wouldnt solve it, as the state shouldnt be shared between threads.
-  //        For now, we dont worry about threading.
+  // These are used by threads without a ReaderContext.  A thread with
+  // one gets and sets the error of its context instead.
   
   /// The error code of the last error.
   static AptErr_t m_err_num;
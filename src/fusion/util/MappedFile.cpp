@@ -0,0 +1,965 @@
+////////////////////////////////////////////////////////////////
+//
+// This library is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License
+// (version 2.1) as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+////////////////////////////////////////////////////////////////
+//
+// affy/sdk/util/MappedFile.cpp ---
+//
+
+//
+#include "util/MappedFile.h"
+//
+#include <climits>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <vector>
+//
+#ifdef _MSC_VER
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+/// Largest file mapped as a whole; bigger files are mapped in windows.
+/// 32-bit processes can not afford to map whole CEL/CDF files.
+static const int64_t MAPPEDFILE_MAX_MAPPED_SIZE =
+  (sizeof(void*) >= 8) ? (int64_t(1) << 40) : (int64_t(256) * 1024 * 1024);
+
+/// Smallest window mapped privately by a view of a huge file.
+static const int64_t MAPPEDFILE_MIN_WINDOW_SIZE = int64_t(64) * 1024 * 1024;
+
+/**
+ * @class MappedFileRegistry
+ * @brief The open MappedFiles, keyed on file identity.
+ */
+class MappedFileRegistry {
+public:
+  static std::mutex& lock() {
+    static std::mutex mtx;
+    return mtx;
+  }
+  static std::vector<MappedFile*>& files() {
+    static std::vector<MappedFile*> vec;
+    return vec;
+  }
+  static bool& useMapping() {
+    static bool use = true;
+    return use;
+  }
+};
+
+//////////
+
+MappedFile::MappedFile() :
+  m_size(0),
+  m_data(NULL),
+  m_refCount(0)
+{
+  memset(m_key, 0, sizeof(m_key));
+#ifdef _MSC_VER
+  m_hFile = INVALID_HANDLE_VALUE;
+  m_hFileMap = NULL;
+#else
+  m_fd = -1;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+  closeFile();
+}
+
+void MappedFile::setUseMapping(bool useMapping)
+{
+  std::lock_guard<std::mutex> guard(MappedFileRegistry::lock());
+  MappedFileRegistry::useMapping() = useMapping;
+}
+
+bool MappedFile::getUseMapping()
+{
+  std::lock_guard<std::mutex> guard(MappedFileRegistry::lock());
+  return MappedFileRegistry::useMapping();
+}
+
+int64_t MappedFile::getMaxMappedSize()
+{
+  return MAPPEDFILE_MAX_MAPPED_SIZE;
+}
+
+int MappedFile::getOpenCount()
+{
+  std::lock_guard<std::mutex> guard(MappedFileRegistry::lock());
+  return (int)MappedFileRegistry::files().size();
+}
+
+MappedFile* MappedFile::acquire(const std::string& path)
+{
+  MappedFile* file = new MappedFile();
+  if (!file->openFile(path)) {
+    delete file;
+    return NULL;
+  }
+
+  std::lock_guard<std::mutex> guard(MappedFileRegistry::lock());
+  std::vector<MappedFile*>& files = MappedFileRegistry::files();
+  for (size_t i = 0; i < files.size(); i++) {
+    if (memcmp(files[i]->m_key, file->m_key, sizeof(file->m_key)) == 0) {
+      // already open -- share it.
+      delete file;
+      files[i]->m_refCount++;
+      return files[i];
+    }
+  }
+
+  // Map the whole file unless it is too big, mapping is off or it fails;
+  // MappedFileView copes with m_data being NULL.
+  if (MappedFileRegistry::useMapping() && (file->m_size > 0)) {
+#ifdef _MSC_VER
+    // the mapping object is also used for the windows of huge files.
+    file->m_hFileMap = CreateFileMapping((HANDLE)file->m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if ((file->m_hFileMap != NULL) && (file->m_size <= MAPPEDFILE_MAX_MAPPED_SIZE)) {
+      file->m_data = (char*)MapViewOfFile((HANDLE)file->m_hFileMap, FILE_MAP_READ, 0, 0, 0);
+    }
+#else
+    if (file->m_size <= MAPPEDFILE_MAX_MAPPED_SIZE) {
+      void* ptr = mmap(NULL, (size_t)file->m_size, PROT_READ, MAP_SHARED, file->m_fd, 0);
+      if (ptr != MAP_FAILED) {
+        file->m_data = (char*)ptr;
+      }
+    }
+#endif
+  }
+
+  file->m_refCount = 1;
+  files.push_back(file);
+  return file;
+}
+
+bool MappedFile::identify(const std::string& path, uint64_t key[4])
+{
+  MappedFile file;
+  if (!file.openFile(path)) {
+    return false;
+  }
+  memcpy(key, file.m_key, sizeof(file.m_key));
+  return true;
+}
+
+void MappedFile::release(MappedFile* file)
+{
+  if (file == NULL) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(MappedFileRegistry::lock());
+  if (--file->m_refCount > 0) {
+    return;
+  }
+  std::vector<MappedFile*>& files = MappedFileRegistry::files();
+  for (size_t i = 0; i < files.size(); i++) {
+    if (files[i] == file) {
+      files.erase(files.begin() + i);
+      break;
+    }
+  }
+  delete file;
+}
+
+#ifdef _MSC_VER
+
+bool MappedFile::openFile(const std::string& path)
+{
+  HANDLE hFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                             NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (hFile == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  m_hFile = hFile;
+  BY_HANDLE_FILE_INFORMATION info;
+  if (!GetFileInformationByHandle(hFile, &info)) {
+    closeFile();
+    return false;
+  }
+  m_size = (int64_t(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+  m_key[0] = info.dwVolumeSerialNumber;
+  m_key[1] = (uint64_t(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+  m_key[2] = (uint64_t)m_size;
+  m_key[3] = (uint64_t(info.ftLastWriteTime.dwHighDateTime) << 32) | info.ftLastWriteTime.dwLowDateTime;
+  return true;
+}
+
+void MappedFile::closeFile()
+{
+  if (m_data != NULL) {
+    UnmapViewOfFile(m_data);
+    m_data = NULL;
+  }
+  if (m_hFileMap != NULL) {
+    CloseHandle((HANDLE)m_hFileMap);
+    m_hFileMap = NULL;
+  }
+  if (m_hFile != INVALID_HANDLE_VALUE) {
+    CloseHandle((HANDLE)m_hFile);
+    m_hFile = INVALID_HANDLE_VALUE;
+  }
+}
+
+void MappedFile::advise(int64_t offset, int64_t len, Advice advice)
+{
+  // No portable equivalent; the system read-ahead is good enough.
+}
+
+bool MappedFile::prefetch(const std::string& path, int64_t offset, int64_t len)
+{
+  return false;
+}
+
+int64_t MappedFile::read(int64_t offset, char* buf, int64_t len)
+{
+  // Explicit offsets, so concurrent readers do not share a file pointer.
+  int64_t total = 0;
+  while (total < len) {
+    OVERLAPPED ov;
+    memset(&ov, 0, sizeof(ov));
+    int64_t pos = offset + total;
+    ov.Offset = DWORD(pos & 0xFFFFFFFF);
+    ov.OffsetHigh = DWORD(pos >> 32);
+    DWORD want = (DWORD)((len - total) > (1 << 30) ? (1 << 30) : (len - total));
+    DWORD got = 0;
+    if (!ReadFile((HANDLE)m_hFile, buf + total, want, &got, &ov) || got == 0) {
+      break;
+    }
+    total += got;
+  }
+  return total;
+}
+
+const char* MappedFile::mapWindow(int64_t offset, int64_t len, void*& base, int64_t& baseLen)
+{
+  base = NULL;
+  baseLen = 0;
+  if (m_hFileMap == NULL) {
+    return NULL;
+  }
+  SYSTEM_INFO sysinfo;
+  GetSystemInfo(&sysinfo);
+  int64_t start = (offset / sysinfo.dwAllocationGranularity) * sysinfo.dwAllocationGranularity;
+  int64_t bytes = len + (offset - start);
+  base = MapViewOfFile((HANDLE)m_hFileMap, FILE_MAP_READ,
+                       DWORD(start >> 32), DWORD(start & 0xFFFFFFFF), (SIZE_T)bytes);
+  if (base == NULL) {
+    return NULL;
+  }
+  baseLen = bytes;
+  return (const char*)base + (offset - start);
+}
+
+void MappedFile::unmapWindow(void* base, int64_t baseLen)
+{
+  if (base != NULL) {
+    UnmapViewOfFile(base);
+  }
+}
+
+#else // posix
+
+bool MappedFile::openFile(const std::string& path)
+{
+  m_fd = ::open(path.c_str(), O_RDONLY);
+  if (m_fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(m_fd, &st) != 0) {
+    closeFile();
+    return false;
+  }
+  m_size = st.st_size;
+  m_key[0] = (uint64_t)st.st_dev;
+  m_key[1] = (uint64_t)st.st_ino;
+  m_key[2] = (uint64_t)st.st_size;
+  // Nanoseconds, such that a file rewritten within the same second
+  // gets a new key too.
+#if defined(__APPLE__)
+  m_key[3] = (uint64_t)st.st_mtimespec.tv_sec * 1000000000 + (uint64_t)st.st_mtimespec.tv_nsec;
+#else
+  m_key[3] = (uint64_t)st.st_mtim.tv_sec * 1000000000 + (uint64_t)st.st_mtim.tv_nsec;
+#endif
+  return true;
+}
+
+void MappedFile::closeFile()
+{
+  if (m_data != NULL) {
+    munmap(m_data, (size_t)m_size);
+    m_data = NULL;
+  }
+  if (m_fd >= 0) {
+    ::close(m_fd);
+    m_fd = -1;
+  }
+}
+
+void MappedFile::advise(int64_t offset, int64_t len, Advice advice)
+{
+  if ((offset < 0) || (offset >= m_size)) {
+    return;
+  }
+  if ((len <= 0) || (offset + len > m_size)) {
+    len = m_size - offset;
+  }
+  if (m_data != NULL) {
+    int posixAdvice = POSIX_MADV_NORMAL;
+    if (advice == ADVICE_SEQUENTIAL)
+      posixAdvice = POSIX_MADV_SEQUENTIAL;
+    else if (advice == ADVICE_RANDOM)
+      posixAdvice = POSIX_MADV_RANDOM;
+    else if (advice == ADVICE_WILLNEED)
+      posixAdvice = POSIX_MADV_WILLNEED;
+    // madvise wants a page aligned address.
+    int64_t page = sysconf(_SC_PAGESIZE);
+    int64_t start = (offset / page) * page;
+    posix_madvise(m_data + start, (size_t)(len + (offset - start)), posixAdvice);
+  }
+#ifdef POSIX_FADV_WILLNEED
+  else {
+    int posixAdvice = POSIX_FADV_NORMAL;
+    if (advice == ADVICE_SEQUENTIAL)
+      posixAdvice = POSIX_FADV_SEQUENTIAL;
+    else if (advice == ADVICE_RANDOM)
+      posixAdvice = POSIX_FADV_RANDOM;
+    else if (advice == ADVICE_WILLNEED)
+      posixAdvice = POSIX_FADV_WILLNEED;
+    posix_fadvise(m_fd, (off_t)offset, (off_t)len, posixAdvice);
+  }
+#endif
+}
+
+bool MappedFile::prefetch(const std::string& path, int64_t offset, int64_t len)
+{
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  bool ok = false;
+  // The read-ahead started by the hint carries on after the file is closed.
+#if defined(POSIX_FADV_WILLNEED)
+  ok = (posix_fadvise(fd, (off_t)offset, (off_t)len, POSIX_FADV_WILLNEED) == 0);
+#elif defined(F_RDADVISE)
+  if (len == 0) {
+    struct stat st;
+    if (fstat(fd, &st) == 0) {
+      len = st.st_size - offset;
+    }
+  }
+  struct radvisory ra;
+  ra.ra_offset = (off_t)offset;
+  ra.ra_count = (int)((len > INT_MAX) ? INT_MAX : len);
+  ok = (fcntl(fd, F_RDADVISE, &ra) != -1);
+#endif
+  ::close(fd);
+  return ok;
+}
+
+int64_t MappedFile::read(int64_t offset, char* buf, int64_t len)
+{
+  // pread does not move a shared file pointer.
+  int64_t total = 0;
+  while (total < len) {
+    ssize_t got = pread(m_fd, buf + total, (size_t)(len - total), (off_t)(offset + total));
+    if (got <= 0) {
+      break;
+    }
+    total += got;
+  }
+  return total;
+}
+
+const char* MappedFile::mapWindow(int64_t offset, int64_t len, void*& base, int64_t& baseLen)
+{
+  base = NULL;
+  baseLen = 0;
+  int64_t page = sysconf(_SC_PAGESIZE);
+  int64_t start = (offset / page) * page;
+  int64_t bytes = len + (offset - start);
+  void* ptr = mmap(NULL, (size_t)bytes, PROT_READ, MAP_SHARED, m_fd, (off_t)start);
+  if (ptr == MAP_FAILED) {
+    return NULL;
+  }
+  base = ptr;
+  baseLen = bytes;
+  return (const char*)ptr + (offset - start);
+}
+
+void MappedFile::unmapWindow(void* base, int64_t baseLen)
+{
+  if (base != NULL) {
+    munmap(base, (size_t)baseLen);
+  }
+}
+
+#endif // _MSC_VER
+
+//////////
+
+MappedFileView::MappedFileView() :
+  m_file(NULL),
+  m_advice(MappedFile::ADVICE_NORMAL),
+  m_windowBase(NULL),
+  m_windowLen(0),
+  m_windowStart(0),
+  m_windowBytes(0),
+  m_windowData(NULL),
+  m_buffer(NULL),
+  m_bufferSize(0)
+{
+}
+
+MappedFileView::~MappedFileView()
+{
+  close();
+}
+
+bool MappedFileView::open(const std::string& path, MappedFile::Advice advice)
+{
+  close();
+  m_file = MappedFile::acquire(path);
+  if (m_file == NULL) {
+    return false;
+  }
+  m_advice = advice;
+  if (advice != MappedFile::ADVICE_NORMAL) {
+    m_file->advise(0, m_file->size(), advice);
+  }
+  return true;
+}
+
+void MappedFileView::close()
+{
+  clearWindow();
+  delete[] m_buffer;
+  m_buffer = NULL;
+  m_bufferSize = 0;
+  if (m_file != NULL) {
+    MappedFile::release(m_file);
+    m_file = NULL;
+  }
+}
+
+int64_t MappedFileView::size() const
+{
+  return (m_file == NULL) ? 0 : m_file->size();
+}
+
+bool MappedFileView::isShared() const
+{
+  return (m_file != NULL) && (m_file->data() != NULL);
+}
+
+void MappedFileView::clearWindow()
+{
+  if (m_windowBase != NULL) {
+    m_file->unmapWindow(m_windowBase, m_windowLen);
+    m_windowBase = NULL;
+    m_windowLen = 0;
+  }
+  m_windowStart = 0;
+  m_windowBytes = 0;
+  m_windowData = NULL;
+}
+
+const char* MappedFileView::map(int64_t offset, int64_t len)
+{
+  if ((m_file == NULL) || (offset < 0) || (len < 0) || (offset + len > m_file->size())) {
+    return NULL;
+  }
+  if (m_file->data() != NULL) {
+    return m_file->data() + offset;
+  }
+
+  // Served by the current window or buffer?
+  if ((m_windowData != NULL) && (offset >= m_windowStart) &&
+      (offset + len <= m_windowStart + m_windowBytes)) {
+    return m_windowData + (offset - m_windowStart);
+  }
+  clearWindow();
+
+  // Map a window large enough that sequential callers rarely remap.
+  if (MappedFile::getUseMapping()) {
+    int64_t bytes = (len < MAPPEDFILE_MIN_WINDOW_SIZE) ? MAPPEDFILE_MIN_WINDOW_SIZE : len;
+    if (offset + bytes > m_file->size()) {
+      bytes = m_file->size() - offset;
+    }
+    if (bytes > 0) {
+      const char* ptr = m_file->mapWindow(offset, bytes, m_windowBase, m_windowLen);
+      if (ptr != NULL) {
+        if (m_advice != MappedFile::ADVICE_NORMAL) {
+          m_file->advise(offset, bytes, m_advice);
+        }
+        m_windowStart = offset;
+        m_windowBytes = bytes;
+        m_windowData = ptr;
+        return ptr;
+      }
+    }
+  }
+
+  // Fall back on a buffered read of just what was asked for.
+  if ((m_buffer == NULL) || (m_bufferSize < len)) {
+    delete[] m_buffer;
+    m_bufferSize = (len > 0) ? len : 1;
+    m_buffer = new char[m_bufferSize];
+  }
+  if (m_file->read(offset, m_buffer, len) != len) {
+    return NULL;
+  }
+  m_windowStart = offset;
+  m_windowBytes = len;
+  m_windowData = m_buffer;
+  return m_buffer;
+}
+
+void MappedFileView::advise(int64_t offset, int64_t len, MappedFile::Advice advice)
+{
+  if (m_file != NULL) {
+    m_file->advise(offset, len, advice);
+  }
+}
+
+//////////
+
+MappedFileStreamBuf::MappedFileStreamBuf() :
+  m_areaStart(0)
+{
+  setg(NULL, NULL, NULL);
+}
+
+MappedFileStreamBuf::~MappedFileStreamBuf()
+{
+  close();
+}
+
+MappedFileStreamBuf* MappedFileStreamBuf::open(const std::string& path, MappedFile::Advice advice)
+{
+  close();
+  if (!m_view.open(path, advice)) {
+    return NULL;
+  }
+  return this;
+}
+
+MappedFileStreamBuf* MappedFileStreamBuf::close()
+{
+  if (!m_view.isOpen()) {
+    return NULL;
+  }
+  m_view.close();
+  m_areaStart = 0;
+  setg(NULL, NULL, NULL);
+  return this;
+}
+
+int64_t MappedFileStreamBuf::tell() const
+{
+  return m_areaStart + (gptr() - eback());
+}
+
+bool MappedFileStreamBuf::fill(int64_t offset)
+{
+  int64_t size = m_view.size();
+  if (offset >= size) {
+    return false;
+  }
+  // The whole file is the get area when it is shared...
+  if (m_view.isShared()) {
+    char* base = (char*)m_view.map(0, size);
+    m_areaStart = 0;
+    setg(base, base + offset, base + size);
+    return true;
+  }
+  // ...otherwise page through it a window at a time.
+  int64_t bytes = size - offset;
+  if (bytes > WindowSize) {
+    bytes = WindowSize;
+  }
+  char* ptr = (char*)m_view.map(offset, bytes);
+  if (ptr == NULL) {
+    return false;
+  }
+  m_areaStart = offset;
+  setg(ptr, ptr, ptr + bytes);
+  return true;
+}
+
+MappedFileStreamBuf::int_type MappedFileStreamBuf::underflow()
+{
+  if (gptr() < egptr()) {
+    return traits_type::to_int_type(*gptr());
+  }
+  if (!m_view.isOpen() || !fill(tell())) {
+    return traits_type::eof();
+  }
+  return traits_type::to_int_type(*gptr());
+}
+
+std::streamsize MappedFileStreamBuf::xsgetn(char* s, std::streamsize n)
+{
+  std::streamsize done = 0;
+  while (done < n) {
+    std::streamsize avail = egptr() - gptr();
+    if (avail <= 0) {
+      if (traits_type::eq_int_type(underflow(), traits_type::eof())) {
+        break;
+      }
+      continue;
+    }
+    std::streamsize chunk = n - done;
+    if (chunk > avail) {
+      chunk = avail;
+    }
+    if (chunk > std::numeric_limits<int>::max()) {
+      chunk = std::numeric_limits<int>::max();
+    }
+    memcpy(s + done, gptr(), (size_t)chunk);
+    gbump((int)chunk);
+    done += chunk;
+  }
+  return done;
+}
+
+MappedFileStreamBuf::pos_type MappedFileStreamBuf::seekoff(off_type off, std::ios_base::seekdir dir,
+                                                           std::ios_base::openmode which)
+{
+  if (!m_view.isOpen() || !(which & std::ios_base::in)) {
+    return pos_type(off_type(-1));
+  }
+  int64_t target;
+  if (dir == std::ios_base::beg) {
+    target = off;
+  } else if (dir == std::ios_base::cur) {
+    target = tell() + off;
+  } else {
+    target = m_view.size() + off;
+  }
+  if ((target < 0) || (target > m_view.size())) {
+    return pos_type(off_type(-1));
+  }
+  if ((eback() != NULL) && (target >= m_areaStart) &&
+      (target <= m_areaStart + (egptr() - eback()))) {
+    setg(eback(), eback() + (target - m_areaStart), egptr());
+  } else {
+    // refilled on the next read.
+    m_areaStart = target;
+    setg(NULL, NULL, NULL);
+  }
+  return pos_type(off_type(target));
+}
+
+MappedFileStreamBuf::pos_type MappedFileStreamBuf::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+  return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
+//////////
+
+MappedFileStream::MappedFileStream() :
+  std::istream(NULL)
+{
+  init(&m_buf);
+}
+
+void MappedFileStream::open(const char* path, std::ios_base::openmode /*mode*/, MappedFile::Advice advice)
+{
+  if (m_buf.open(path, advice) == NULL) {
+    setstate(std::ios_base::failbit);
+  } else {
+    clear();
+  }
+}
+
+void MappedFileStream::close()
+{
+  if (m_buf.close() == NULL) {
+    setstate(std::ios_base::failbit);
+  }
+}
+
+//////////
+
+MappedFileWriter::MappedFileWriter() :
+  m_size(0),
+  m_windowBase(NULL),
+  m_windowLen(0),
+  m_buffer(NULL),
+  m_bufferStart(0),
+  m_bufferLen(0),
+  m_bufferSize(0)
+{
+#ifdef _MSC_VER
+  m_hFile = INVALID_HANDLE_VALUE;
+  m_hFileMap = NULL;
+#else
+  m_fd = -1;
+#endif
+}
+
+MappedFileWriter::~MappedFileWriter()
+{
+  close();
+}
+
+char* MappedFileWriter::map(int64_t offset, int64_t len)
+{
+  if (!isOpen() || (offset < 0) || (len <= 0) || (offset + len > m_size)) {
+    return NULL;
+  }
+  if (!flush()) {
+    return NULL;
+  }
+
+  int64_t page = getPageSize();
+  int64_t start = (offset / page) * page;
+  int64_t bytes = len + (offset - start);
+
+  if (MappedFile::getUseMapping()) {
+    void* ptr = NULL;
+#ifdef _MSC_VER
+    if (m_hFileMap == NULL) {
+      m_hFileMap = CreateFileMapping((HANDLE)m_hFile, NULL, PAGE_READWRITE, 0, 0, NULL);
+    }
+    if (m_hFileMap != NULL) {
+      ptr = MapViewOfFile((HANDLE)m_hFileMap, FILE_MAP_WRITE,
+                          DWORD(start >> 32), DWORD(start & 0xFFFFFFFF), (SIZE_T)bytes);
+    }
+#else
+    ptr = mmap(NULL, (size_t)bytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, (off_t)start);
+    if (ptr == MAP_FAILED) {
+      ptr = NULL;
+    }
+#endif
+    if (ptr != NULL) {
+      m_windowBase = ptr;
+      m_windowLen = bytes;
+      return (char*)ptr + (offset - start);
+    }
+  }
+
+  // Read-modify-write through a buffer.
+  if ((m_buffer == NULL) || (m_bufferSize < len)) {
+    delete[] m_buffer;
+    m_bufferSize = len;
+    m_buffer = new char[m_bufferSize];
+  }
+  if (readAt(offset, m_buffer, len) != len) {
+    return NULL;
+  }
+  m_bufferStart = offset;
+  m_bufferLen = len;
+  return m_buffer;
+}
+
+#ifdef _MSC_VER
+
+bool MappedFileWriter::open(const std::string& path)
+{
+  close();
+  HANDLE hFile = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                             NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (hFile == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  m_hFile = hFile;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(hFile, &size)) {
+    close();
+    return false;
+  }
+  m_size = size.QuadPart;
+  return true;
+}
+
+bool MappedFileWriter::close()
+{
+  bool ok = flush();
+  delete[] m_buffer;
+  m_buffer = NULL;
+  m_bufferSize = 0;
+  if (m_hFileMap != NULL) {
+    CloseHandle((HANDLE)m_hFileMap);
+    m_hFileMap = NULL;
+  }
+  if (m_hFile != INVALID_HANDLE_VALUE) {
+    CloseHandle((HANDLE)m_hFile);
+    m_hFile = INVALID_HANDLE_VALUE;
+  }
+  m_size = 0;
+  return ok;
+}
+
+bool MappedFileWriter::isOpen() const
+{
+  return m_hFile != INVALID_HANDLE_VALUE;
+}
+
+int64_t MappedFileWriter::getPageSize()
+{
+  // views must start on the allocation granularity.
+  SYSTEM_INFO sysinfo;
+  GetSystemInfo(&sysinfo);
+  return sysinfo.dwAllocationGranularity;
+}
+
+bool MappedFileWriter::flush()
+{
+  bool ok = true;
+  if (m_windowBase != NULL) {
+    ok = (UnmapViewOfFile(m_windowBase) != 0);
+    m_windowBase = NULL;
+    m_windowLen = 0;
+  }
+  if (m_bufferLen > 0) {
+    ok = (writeAt(m_bufferStart, m_buffer, m_bufferLen) == m_bufferLen) && ok;
+    m_bufferLen = 0;
+  }
+  return ok;
+}
+
+int64_t MappedFileWriter::readAt(int64_t offset, char* buf, int64_t len)
+{
+  int64_t total = 0;
+  while (total < len) {
+    OVERLAPPED ov;
+    memset(&ov, 0, sizeof(ov));
+    int64_t pos = offset + total;
+    ov.Offset = DWORD(pos & 0xFFFFFFFF);
+    ov.OffsetHigh = DWORD(pos >> 32);
+    DWORD want = (DWORD)((len - total) > (1 << 30) ? (1 << 30) : (len - total));
+    DWORD got = 0;
+    if (!ReadFile((HANDLE)m_hFile, buf + total, want, &got, &ov) || got == 0) {
+      break;
+    }
+    total += got;
+  }
+  return total;
+}
+
+int64_t MappedFileWriter::writeAt(int64_t offset, const char* buf, int64_t len)
+{
+  int64_t total = 0;
+  while (total < len) {
+    OVERLAPPED ov;
+    memset(&ov, 0, sizeof(ov));
+    int64_t pos = offset + total;
+    ov.Offset = DWORD(pos & 0xFFFFFFFF);
+    ov.OffsetHigh = DWORD(pos >> 32);
+    DWORD want = (DWORD)((len - total) > (1 << 30) ? (1 << 30) : (len - total));
+    DWORD put = 0;
+    if (!WriteFile((HANDLE)m_hFile, buf + total, want, &put, &ov) || put == 0) {
+      break;
+    }
+    total += put;
+  }
+  return total;
+}
+
+#else // posix
+
+bool MappedFileWriter::open(const std::string& path)
+{
+  close();
+  m_fd = ::open(path.c_str(), O_RDWR);
+  if (m_fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(m_fd, &st) != 0) {
+    close();
+    return false;
+  }
+  m_size = st.st_size;
+  return true;
+}
+
+bool MappedFileWriter::close()
+{
+  bool ok = flush();
+  delete[] m_buffer;
+  m_buffer = NULL;
+  m_bufferSize = 0;
+  if (m_fd >= 0) {
+    ::close(m_fd);
+    m_fd = -1;
+  }
+  m_size = 0;
+  return ok;
+}
+
+bool MappedFileWriter::isOpen() const
+{
+  return m_fd >= 0;
+}
+
+int64_t MappedFileWriter::getPageSize()
+{
+  return sysconf(_SC_PAGESIZE);
+}
+
+bool MappedFileWriter::flush()
+{
+  bool ok = true;
+  if (m_windowBase != NULL) {
+    // the dirty pages stay in the page cache and are written back by the system.
+    ok = (munmap(m_windowBase, (size_t)m_windowLen) == 0);
+    m_windowBase = NULL;
+    m_windowLen = 0;
+  }
+  if (m_bufferLen > 0) {
+    ok = (writeAt(m_bufferStart, m_buffer, m_bufferLen) == m_bufferLen) && ok;
+    m_bufferLen = 0;
+  }
+  return ok;
+}
+
+int64_t MappedFileWriter::readAt(int64_t offset, char* buf, int64_t len)
+{
+  int64_t total = 0;
+  while (total < len) {
+    ssize_t got = pread(m_fd, buf + total, (size_t)(len - total), (off_t)(offset + total));
+    if (got <= 0) {
+      break;
+    }
+    total += got;
+  }
+  return total;
+}
+
+int64_t MappedFileWriter::writeAt(int64_t offset, const char* buf, int64_t len)
+{
+  int64_t total = 0;
+  while (total < len) {
+    ssize_t put = pwrite(m_fd, buf + total, (size_t)(len - total), (off_t)(offset + total));
+    if (put <= 0) {
+      break;
+    }
+    total += put;
+  }
+  return total;
+}
+
+#endif // _MSC_VER
@@ -0,0 +1,342 @@
+////////////////////////////////////////////////////////////////
+//
+// This library is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License
+// (version 2.1) as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+////////////////////////////////////////////////////////////////
+//
+// affy/sdk/util/MappedFile.h ---
+//
+
+#ifndef _UTIL_MAPPEDFILE_H_
+#define _UTIL_MAPPEDFILE_H_
+
+//
+#include "portability/affy-base-types.h"
+//
+#include <istream>
+#include <streambuf>
+#include <string>
+
+/// @file   util/MappedFile.h
+/// @brief  Memory mapped files: read-only mappings shared between readers,
+///         and writable windows for updating files in place.
+
+/**
+ * @class MappedFile
+ * @brief A read-only mapping of a whole file, shared by all readers of it.
+ *
+ * Mappings are reference counted and kept in a process wide registry
+ * keyed by the identity of the file (device and inode, or the volume
+ * serial number and file index on Windows) together with its size and
+ * modification time.  Two readers opening the same file, even through
+ * different paths, get the same mapping and hence share the address
+ * space and page cache.  A file which has been rewritten gets a new entry.
+ *
+ * Files larger than getMaxMappedSize() are not mapped as a whole;
+ * data() then returns NULL and MappedFileView maps windows of it instead.
+ *
+ * Use MappedFileView rather than this class directly.
+ */
+class MappedFile {
+public:
+  /// Access pattern hints passed on to madvise().
+  enum Advice {
+    ADVICE_NORMAL,
+    ADVICE_SEQUENTIAL,
+    ADVICE_RANDOM,
+    ADVICE_WILLNEED
+  };
+
+  /// @brief     Get a reference to the shared mapping of a file.
+  /// @param     path      the file to map
+  /// @return    the mapping or NULL if the file can not be opened.
+  static MappedFile* acquire(const std::string& path);
+  /// @brief     Drop a reference obtained with acquire().
+  ///            The file is unmapped and closed when the last one goes.
+  static void release(MappedFile* file);
+
+  /// @brief     Enable or disable memory mapping.
+  ///            When disabled all data is read with buffered reads.
+  static void setUseMapping(bool useMapping);
+  /// @brief     Is memory mapping enabled?
+  static bool getUseMapping();
+  /// @brief     Files larger than this are mapped in windows.
+  static int64_t getMaxMappedSize();
+  /// @brief     Number of distinct files currently mapped or opened.
+  static int getOpenCount();
+  /// @brief     Ask the OS to start reading a range of a file into the page cache
+  ///            without waiting for it, e.g. for the next file to be read.
+  /// @param     path      the file
+  /// @param     offset    start of the range
+  /// @param     len       bytes in the range, 0 for the rest of the file
+  /// @return    true if the hint was given.
+  static bool prefetch(const std::string& path, int64_t offset, int64_t len);
+  /// @brief     Get the identity of a file as used for the registry key, e.g.
+  ///            for caching data derived from the file.  A file which has been
+  ///            rewritten gets a new identity.
+  /// @param     path      the file
+  /// @param     key       set to device, inode, size and modification time
+  ///                      (in nanoseconds, or 100ns units on Windows)
+  /// @return    false if the file can not be opened.
+  static bool identify(const std::string& path, uint64_t key[4]);
+
+  /// @brief     Size of the file in bytes.
+  int64_t size() const { return m_size; }
+  /// @brief     Start of the whole-file mapping, or NULL if there is none.
+  const char* data() const { return m_data; }
+  /// @brief     Number of readers holding a reference.
+  int refCount() const { return m_refCount; }
+
+  /// @brief     Pass an access pattern hint for a range of the file to the OS.
+  void advise(int64_t offset, int64_t len, Advice advice);
+  /// @brief     Read bytes without going through the mapping.
+  /// @return    the number of bytes read.
+  int64_t read(int64_t offset, char* buf, int64_t len);
+  /// @brief     Map a window of the file; used when data() is NULL.
+  /// @param     offset    the offset of the window, it is rounded down to a page boundary
+  /// @param     len       bytes needed from offset
+  /// @param     base      set to the start of the mapping, to be passed to unmapWindow()
+  /// @param     baseLen   set to the length of the mapping
+  /// @return    pointer to the byte at offset, or NULL on failure.
+  const char* mapWindow(int64_t offset, int64_t len, void*& base, int64_t& baseLen);
+  /// @brief     Unmap a window returned by mapWindow().
+  void unmapWindow(void* base, int64_t baseLen);
+
+private:
+  MappedFile();
+  ~MappedFile();
+  bool openFile(const std::string& path);
+  void closeFile();
+
+  /// Registry key: device, inode, size and modification time.
+  uint64_t m_key[4];
+  /// The file size.
+  int64_t m_size;
+  /// The whole-file mapping, if any.
+  char* m_data;
+  /// References held by readers (guarded by the registry lock).
+  int m_refCount;
+#ifdef _MSC_VER
+  /// File handle.
+  void* m_hFile;
+  /// File mapping handle, shared by all views of the file.
+  void* m_hFileMap;
+#else
+  /// File descriptor.
+  int m_fd;
+#endif
+
+  friend class MappedFileRegistry;
+};
+
+/**
+ * @class MappedFileView
+ * @brief A reader's access to a MappedFile.
+ *
+ * map() returns a pointer straight into the shared mapping when the file
+ * is mapped as a whole.  Otherwise the view maps a window of the file
+ * privately, and when mapping is not possible at all (disabled, or the
+ * mmap call fails) it falls back to reading the requested bytes into a
+ * buffer of its own.  Pointers returned by map() stay valid until the
+ * next call to map() or close().
+ */
+class MappedFileView {
+public:
+  MappedFileView();
+  ~MappedFileView();
+
+  /// @brief     Open a file.
+  /// @param     path      the file
+  /// @param     advice    the expected access pattern
+  /// @return    true if successful.
+  bool open(const std::string& path, MappedFile::Advice advice = MappedFile::ADVICE_NORMAL);
+  /// @brief     Release the file.
+  void close();
+  /// @brief     Is a file open?
+  bool isOpen() const { return m_file != NULL; }
+  /// @brief     Size of the file in bytes.
+  int64_t size() const;
+  /// @brief     Is this view served by a mapping shared with other readers?
+  bool isShared() const;
+
+  /// @brief     Get a pointer to the bytes [offset, offset+len) of the file.
+  /// @return    the pointer or NULL if the range can not be read.
+  const char* map(int64_t offset, int64_t len);
+  /// @brief     Pass an access pattern hint for a range of the file to the OS.
+  void advise(int64_t offset, int64_t len, MappedFile::Advice advice);
+
+private:
+  /// Drop the private window or buffer.
+  void clearWindow();
+
+  /// The shared file.
+  MappedFile* m_file;
+  /// The advice given at open.
+  MappedFile::Advice m_advice;
+  /// Base of a private window mapping.
+  void* m_windowBase;
+  /// Length of the private window mapping.
+  int64_t m_windowLen;
+  /// File offset of the first byte of the window or buffer.
+  int64_t m_windowStart;
+  /// Bytes available from m_windowStart.
+  int64_t m_windowBytes;
+  /// Pointer to the byte at m_windowStart.
+  const char* m_windowData;
+  /// Buffer used for buffered reads.
+  char* m_buffer;
+  /// Allocated size of m_buffer.
+  int64_t m_bufferSize;
+
+  // not copyable.
+  MappedFileView(const MappedFileView&);
+  MappedFileView& operator=(const MappedFileView&);
+};
+
+/**
+ * @class MappedFileStreamBuf
+ * @brief A read-only std::streambuf over a MappedFileView.
+ */
+class MappedFileStreamBuf : public std::streambuf {
+public:
+  MappedFileStreamBuf();
+  ~MappedFileStreamBuf();
+
+  /// @brief     Open a file.
+  MappedFileStreamBuf* open(const std::string& path, MappedFile::Advice advice);
+  /// @brief     Close the file.
+  MappedFileStreamBuf* close();
+  /// @brief     Is a file open?
+  bool is_open() const { return m_view.isOpen(); }
+
+protected:
+  virtual int_type underflow();
+  virtual std::streamsize xsgetn(char* s, std::streamsize n);
+  virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                           std::ios_base::openmode which = std::ios_base::in);
+  virtual pos_type seekpos(pos_type pos,
+                           std::ios_base::openmode which = std::ios_base::in);
+
+private:
+  /// Make the get area start at the given file offset.
+  bool fill(int64_t offset);
+  /// File offset of the current read position.
+  int64_t tell() const;
+
+  /// The file.
+  MappedFileView m_view;
+  /// File offset of eback().
+  int64_t m_areaStart;
+  /// Bytes made available per underflow() when the file is not mapped as a whole.
+  static const int64_t WindowSize = 1024*1024;
+};
+
+/**
+ * @class MappedFileStream
+ * @brief An input stream over a MappedFile, a drop-in for a binary std::ifstream.
+ */
+class MappedFileStream : public std::istream {
+public:
+  MappedFileStream();
+
+  /// @brief     Open a file; sets failbit if it can not be opened.
+  /// @param     path      the file
+  /// @param     mode      ignored, the stream is always binary and read-only
+  /// @param     advice    the expected access pattern
+  void open(const char* path,
+            std::ios_base::openmode mode = std::ios_base::in | std::ios_base::binary,
+            MappedFile::Advice advice = MappedFile::ADVICE_NORMAL);
+  /// @brief     Close the file.
+  void close();
+  /// @brief     Is a file open?
+  bool is_open() const { return m_buf.is_open(); }
+
+private:
+  /// The stream buffer.
+  MappedFileStreamBuf m_buf;
+};
+
+/**
+ * @class MappedFileWriter
+ * @brief In-place updates of an existing file through writable windows.
+ *
+ * map() maps a window of the file writable.  When mapping is disabled or
+ * fails, the window is instead read into a buffer that is written back
+ * when the window is dropped.  Either way only the pages covered by the
+ * windows are read and written, so a caller scattering values over a
+ * file should sort them and map one window per run of nearby pages.
+ *
+ * Mappings are shared, so the changes are seen by readers of the file
+ * in this process right away.  The file is never extended.
+ */
+class MappedFileWriter {
+public:
+  MappedFileWriter();
+  ~MappedFileWriter();
+
+  /// @brief     Open an existing file for updating.
+  /// @return    true if successful.
+  bool open(const std::string& path);
+  /// @brief     Write back the current window and close the file.
+  /// @return    false if writing failed.
+  bool close();
+  /// @brief     Is a file open?
+  bool isOpen() const;
+  /// @brief     Size of the file in bytes.
+  int64_t size() const { return m_size; }
+  /// @brief     The granularity of windows; runs of writes closer than this share pages.
+  static int64_t getPageSize();
+
+  /// @brief     Get a writable pointer to the bytes [offset, offset+len) of the file.
+  ///            The previous window is written back first.
+  /// @return    the pointer or NULL if the range is outside the file or can not be accessed.
+  char* map(int64_t offset, int64_t len);
+  /// @brief     Write back and drop the current window.
+  /// @return    false if writing failed.
+  bool flush();
+
+private:
+  /// The file size.
+  int64_t m_size;
+  /// Base of the window mapping, if mapped.
+  void* m_windowBase;
+  /// Length of the window mapping.
+  int64_t m_windowLen;
+  /// Buffer holding the window, if not mapped.
+  char* m_buffer;
+  /// File offset and length of the buffered window.
+  int64_t m_bufferStart;
+  int64_t m_bufferLen;
+  /// Allocated size of m_buffer.
+  int64_t m_bufferSize;
+#ifdef _MSC_VER
+  /// File handle.
+  void* m_hFile;
+  /// Writable file mapping handle.
+  void* m_hFileMap;
+#else
+  /// File descriptor.
+  int m_fd;
+#endif
+
+  /// Read or write bytes at an offset, without a mapping.
+  int64_t readAt(int64_t offset, char* buf, int64_t len);
+  int64_t writeAt(int64_t offset, const char* buf, int64_t len);
+
+  // not copyable.
+  MappedFileWriter(const MappedFileWriter&);
+  MappedFileWriter& operator=(const MappedFileWriter&);
+};
+
+#endif // _UTIL_MAPPEDFILE_H_
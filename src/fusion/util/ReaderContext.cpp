@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////
+//
+// This library is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License
+// (version 2.1) as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+////////////////////////////////////////////////////////////////
+
+//
+#include "util/ReaderContext.h"
+//
+#include "util/VerboseErrHandler.h"
+//
+
+/// The context installed on this thread, if any.
+static thread_local ReaderContext* t_CurrentContext = NULL;
+
+ReaderContext::ReaderContext(ErrHandler* handler, int verbosity, std::ostream* out) :
+  m_FsErrNum(APT_OK),
+  m_ProgHandler(verbosity, out),
+  m_MsgHandler(verbosity, out),
+  // throw, but do not print the message nor exit.
+  m_ErrParam(handler != NULL ? handler : new VerboseErrHandler(true, false, false)),
+  m_VerboseParam(&m_ProgHandler, &m_MsgHandler, &m_MsgHandler)
+{
+  m_VerboseParam.m_Verbosity = verbosity;
+}
+
+ReaderContext::~ReaderContext()
+{
+  // Do not leave a dangling context behind.
+  if (t_CurrentContext == this) {
+    t_CurrentContext = NULL;
+  }
+}
+
+ReaderContext* ReaderContext::getCurrent()
+{
+  return t_CurrentContext;
+}
+
+ReaderContext::Scope::Scope(ReaderContext* context)
+{
+  m_Previous = t_CurrentContext;
+  t_CurrentContext = context;
+}
+
+ReaderContext::Scope::~Scope()
+{
+  t_CurrentContext = m_Previous;
+}
@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////
+//
+// This library is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License
+// (version 2.1) as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+////////////////////////////////////////////////////////////////
+//
+// affy/sdk/util/ReaderContext.h ---
+//
+
+#ifndef _UTIL_READERCONTEXT_H_
+#define _UTIL_READERCONTEXT_H_
+
+//
+#include "util/AptErrno.h"
+#include "util/Err.h"
+#include "util/ErrHandler.h"
+#include "util/MsgStream.h"
+#include "util/ProgressDot.h"
+#include "util/Verbose.h"
+//
+#include <iostream>
+#include <string>
+
+/// @file   util/ReaderContext.h
+/// @brief  Per-thread error handling, verbosity and progress state for readers.
+
+/**
+ * @class ReaderContext
+ * @brief The error handler stack, verbosity and progress state used by Err,
+ *        Verbose and the Fs error functions while it is installed.
+ *
+ * Err, Verbose and Fs keep their state behind static functions.  Without a
+ * context that state is process wide, so two threads parsing files at the
+ * same time would push and pop each other's error handlers and share dot
+ * counters.  A thread that installs a context with a Scope gets all of that
+ * state from the context instead, until the scope ends.  Threads without a
+ * context use the process wide state as before.
+ *
+ * A context is used by one thread at a time.  Each worker of a parallel
+ * loader should own one, e.g. on its stack:
+ *
+ * @code
+ *   ReaderContext ctx;
+ *   ReaderContext::Scope scope(&ctx);
+ *   // Err::errAbort() now throws an Except, which only this thread sees.
+ * @endcode
+ */
+class ReaderContext {
+public:
+  /// @brief     Create a context.
+  /// @param     handler   the bottom error handler, owned by the context.
+  ///                      If NULL, errors throw an Except.
+  /// @param     verbosity the level of messages and progress reported
+  /// @param     out       the stream messages and progress go to, or NULL for none
+  ReaderContext(ErrHandler* handler = NULL, int verbosity = 0, std::ostream* out = NULL);
+  ~ReaderContext();
+
+  /// @brief     The error handler stack and options used by Err.
+  Err::Param& getErrParam() { return m_ErrParam; }
+  /// @brief     The handlers and verbosity used by Verbose.
+  Verbose::Param& getVerboseParam() { return m_VerboseParam; }
+
+  /// The error code of the last Fs error.
+  AptErr_t m_FsErrNum;
+  /// The error message of the last Fs error.
+  std::string m_FsErrMsg;
+
+  /// @brief     The context installed on the calling thread.
+  /// @return    the context or NULL if the process wide state is used.
+  static ReaderContext* getCurrent();
+
+  /**
+   * @class Scope
+   * @brief Installs a context on the calling thread for its lifetime
+   *        and restores the previous one afterwards.
+   */
+  class Scope {
+  public:
+    Scope(ReaderContext* context);
+    ~Scope();
+  private:
+    /// The context installed before this scope.
+    ReaderContext* m_Previous;
+
+    // not copyable.
+    Scope(const Scope&);
+    Scope& operator=(const Scope&);
+  };
+
+private:
+  /// Progress handler of the context.
+  ProgressDot m_ProgHandler;
+  /// Message and warning handler of the context.
+  MsgStream m_MsgHandler;
+  /// State used by Err.
+  Err::Param m_ErrParam;
+  /// State used by Verbose.
+  Verbose::Param m_VerboseParam;
+
+  // not copyable.
+  ReaderContext(const ReaderContext&);
+  ReaderContext& operator=(const ReaderContext&);
+};
+
+#endif /* _UTIL_READERCONTEXT_H_ */
@@ -29,6 +29,7 @@
 #include "calvin_files/utils/src/StringUtils.h"
 #include "portability/affy-system-api.h"
 #include "util/Fs.h"
+#include "util/ReaderContext.h"
 #include "util/Util.h"
 #include "util/Verbose.h"
 //
@@ -103,9 +104,13 @@ void Verbose::progressStep(int verbosity) {
 /** 
  * @brief This function gets around the problem of static variable
  * initialization as local static variables work more consistently.
- * @return Param - Our static parameters for this class.
+ * @return Param - Our static parameters for this class, or those of
+ * the ReaderContext installed on the calling thread.
  */
 Verbose::Param &Verbose::getParam() {
+  ReaderContext *context = ReaderContext::getCurrent();
+  if (context != NULL)
+    return context->getVerboseParam();
 
   // Avoid weird windows .NET/Forms bug where linking to cout/cerr can cause problems...
   static std::ostream *out = NULL;
@@ -87,7 +87,8 @@ public:
   /** 
    * @brief This function gets around the problem of static variable
    * initialization as local static variables work more consistently.
-   * @return Param - Our static parameters for this class.
+   * @return Param - Our static parameters for this class, or those of
+   * the ReaderContext installed on the calling thread.
    */
   static Param &getParam();
   